@@ -0,0 +1,95 @@
+#ifndef INC_CALIB_H_
+#define INC_CALIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 로드셀 보정값 플래시 저장소 (STM32F446RE 섹터 6, 7 전용)
+//
+// 두 섹터에 고정 크기 레코드를 뒤에 이어 붙이는 로그 구조
+//   - 저장할 때마다 다음 빈 칸에 새 레코드 (seq 증가) → 섹터를 지우는 건 한 섹터가 다 찼을 때만
+//   - 다 차면 반대쪽 섹터를 지우고 거기서 이어 씀 (이전 레코드는 새 레코드가 써질 때까지 살아 있음)
+//   - 부팅 시 두 섹터를 훑어서 magic/version/CRC 가 맞는 것 중 seq 가 가장 큰 레코드 사용
+//
+// ※ 링커 스크립트에서 FLASH 를 0x08040000 (256KB) 미만으로 잡아서 펌웨어가 이 영역을 쓰지 않게 할 것
+
+#define CALIB_SECTOR_A          FLASH_SECTOR_6
+#define CALIB_SECTOR_B          FLASH_SECTOR_7
+#define CALIB_ADDR_A            0x08040000u
+#define CALIB_ADDR_B            0x08060000u
+#define CALIB_SECTOR_SIZE       0x20000u        // 128KB
+
+#define CALIB_MAGIC             0x4C43414Cu     // "LACL"
+#define CALIB_VERSION           2               // 레코드 구조가 바뀌면 올림 (다른 버전은 무시)
+#define CALIB_MAX_CELLS         4               // 로드셀 채널 수
+#define CALIB_SLOT_SIZE         512             // 레코드 칸 크기 (바이트, 4의 배수)
+
+#define CALIB_LUT_NODES         17              // 보정표 노드 수 (구간 16개)
+#define CALIB_MAX_POINTS        12              // 다점 보정 기준 무게 최대 개수
+
+// 비선형 보정표: raw(영점 뺀 값) → mg, 균일 간격 노드 사이 선형 보간
+//   노드 j 위치 = (j << shift) - bias  (bias = 구간 하나, 영점 아래 약간도 덮음)
+typedef struct {
+    uint8_t  valid;                     // 0 이면 표 없음 (scale 로 선형 계산)
+    uint8_t  shift;                     // 구간 폭 = 1 << shift [raw]
+    uint16_t reserved;
+    int32_t  bias;
+    int32_t  mg[CALIB_LUT_NODES];       // 노드별 무게 [mg]
+} Calib_Lut_t;
+
+// 다점 보정 기준점 (영점 뺀 raw, 실제 무게)
+typedef struct {
+    int32_t raw;
+    float   grams;
+} Calib_Point_t;
+
+// 로드셀 한 채널 보정값
+typedef struct {
+    int32_t offset;         // 영점 raw
+    float   scale;          // raw / g
+    float   ref_temp;       // 보정했을 때 온도 [°C]
+    float   tc_offset;      // 영점 온도계수 [raw/°C]
+    float   tc_scale;       // 감도 온도계수 [1/°C] (scale * (1 + tc_scale * dT))
+    Calib_Lut_t lut;        // 다점 보정표 (있으면 scale 대신 사용)
+} Calib_Cell_t;
+
+typedef struct {
+    uint8_t      n_cells;
+    Calib_Cell_t cell[CALIB_MAX_CELLS];
+} Calib_Data_t;
+
+// 가장 최근 유효 레코드 읽기 (없으면 false)
+bool Calib_Load(Calib_Data_t *data);
+
+// 새 레코드 추가 (필요하면 섹터 교체 + 지우기, 지우는 동안 수 초 걸릴 수 있음)
+bool Calib_Save(const Calib_Data_t *data);
+
+// 마지막으로 읽거나 쓴 레코드의 seq (없으면 0)
+uint32_t Calib_GetSeq(void);
+
+// 기준점들(영점 포함 안 해도 됨)을 지나는 구간 선형 보정표 생성
+// 점이 하나뿐이면 영점과 잇는 직선. 기준점이 없거나 raw 가 모두 0 이하면 false
+bool Calib_FitLut(const Calib_Point_t *pts, uint8_t n, Calib_Lut_t *lut);
+
+// 기준점에 원점 지나는 최소제곱 직선 → scale [raw/g] (표가 없을 때 대비)
+float Calib_FitScale(const Calib_Point_t *pts, uint8_t n);
+
+// 보정표 계산: raw(영점 뺀 값) → mg
+// 분기 없이 시프트/마스크로 구간을 찾고 정수 곱 한 번으로 보간 (범위 밖은 양 끝 값)
+static inline int32_t Calib_LutEval(const Calib_Lut_t *lut, int32_t net)
+{
+    int32_t top = ((CALIB_LUT_NODES - 1) << lut->shift) - 1;
+    int32_t x = net + lut->bias;
+    x = (x < 0) ? 0 : x;            // 조건 선택 명령으로 컴파일됨 (분기 아님)
+    x = (x > top) ? top : x;
+
+    uint32_t i = (uint32_t)x >> lut->shift;
+    int32_t  f = x & ((1 << lut->shift) - 1);
+    int32_t  y0 = lut->mg[i];
+    return y0 + (int32_t)(((int64_t)(lut->mg[i + 1] - y0) * f) >> lut->shift);
+}
+
+// 온도 보정된 영점/감도
+void Calib_Compensate(const Calib_Cell_t *cell, float temp, int32_t *offset, float *scale);
+
+#endif /* INC_CALIB_H_ */
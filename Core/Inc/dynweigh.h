@@ -0,0 +1,45 @@
+#ifndef INC_DYNWEIGH_H_
+#define INC_DYNWEIGH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 동적 계량: 물체를 올린 직후 출렁이는 응답에서 최종 무게를 미리 추정
+//
+// 플랫폼 응답을 감쇠 2차 계단 응답으로 보고
+//   y[k] = a1*y[k-1] + a2*y[k-2] + c
+// 를 재귀 최소제곱(RLS, 망각계수 DYN_LAMBDA)으로 맞춤 → 정착값 W = c / (1 - a1 - a2)
+//   - 샘플마다 3x3 갱신 한 번 (곱셈 30여 개)
+//   - 마지막 DYN_AGREE_N 개 추정이 DYN_TOL_G 안에 모이면 수렴으로 봄
+//
+// ※ 200ms 안에 추정하려면 HX711 을 80SPS 로 (RATE 핀 HIGH), 10SPS 면 추정까지 1초 가까이 걸림
+
+#define DYN_LAMBDA      0.95f   // 망각계수 (작을수록 최근 샘플 위주)
+#define DYN_P0          1000.0f // 공분산 초기값
+#define DYN_MIN_N       6       // 이 샘플 수 이전에는 추정 안 믿음
+#define DYN_AGREE_N     3       // 연속으로 이만큼 모여야 수렴
+#define DYN_TOL_G       2.0f    // 수렴 판정 폭 [g]
+#define DYN_MAX_N       64      // 이 안에 수렴 못 하면 포기 (정적 판정에 맡김)
+
+typedef enum {
+    DYN_IDLE = 0,       // 추정 안 하는 중
+    DYN_RUNNING,        // 샘플 모으는 중
+    DYN_CONVERGED,      // 추정 끝 (DynWeigh_Get 으로 값)
+    DYN_FAILED,         // DYN_MAX_N 안에 못 맞춤
+} DynWeigh_State_t;
+
+// 새 물체 추정 시작 (물체가 올라온 첫 샘플에서)
+void DynWeigh_Start(void);
+
+// 추정 중단
+void DynWeigh_Stop(void);
+
+// 샘플 하나 [g] 넣기 (센서 원래 속도로), 현재 상태 리턴
+DynWeigh_State_t DynWeigh_Push(float w);
+
+// 마지막 정착값 추정 [g]
+float DynWeigh_Get(void);
+
+DynWeigh_State_t DynWeigh_GetState(void);
+
+#endif /* INC_DYNWEIGH_H_ */
@@ -8,6 +8,16 @@
 #define HX711_GAIN_64   64
 #define HX711_GAIN_32   32
 
+#define HX711_TIMEOUT_MS    200         // 데이터 준비 대기 최대 시간
+#define HX711_RAW_MAX       8388607     // 포화 코드 (+)
+#define HX711_RAW_MIN       (-8388608)  // 포화 코드 (-)
+
+typedef enum {
+    HX711_OK = 0,
+    HX711_TIMEOUT,          // DOUT 이 준비되지 않음 (전원/배선)
+    HX711_SATURATED,        // ±풀스케일 코드 (과부하 또는 브리지 끊김)
+} HX711_Status_t;
+
 typedef struct {
     GPIO_TypeDef *dout_port;
     uint16_t      dout_pin;
@@ -27,10 +37,13 @@ void HX711_Init(HX711_t *hx,
                 GPIO_TypeDef *sck_port,  uint16_t sck_pin,
                 uint8_t gain);
 
-// raw 24bit 값 읽기
+// raw 24bit 값 읽기 + 상태 (TIMEOUT 이면 *value 는 안 건드림)
+HX711_Status_t HX711_Read(HX711_t *hx, int32_t *value);
+
+// raw 24bit 값 읽기 (타임아웃이면 0, 상태가 필요하면 HX711_Read)
 int32_t HX711_ReadRaw(HX711_t *hx);
 
-// 영점 조절, 여러 번 읽어서 평균 & offset 저장/리턴
+// 영점 조절, 여러 번 읽어서 평균 & offset 저장/리턴 (타임아웃/포화 샘플은 뺌)
 int32_t HX711_Tare(HX711_t *hx, uint8_t times);
 
 // 현재 무게(g) (scale 값 보정 이후 사용 가능)
@@ -0,0 +1,60 @@
+#ifndef INC_HXGUARD_H_
+#define INC_HXGUARD_H_
+
+#include <stdint.h>
+#include "hx711.h"
+
+// HX711 샘플 검사: 필터/업링크 앞에서 나쁜 샘플을 걸러내고 고장을 셈
+//
+//   - 타임아웃 / 포화 코드 → 버림
+//   - 같은 코드가 HXG_STUCK_N 번 연속 → 값 고착 (24비트 ADC 는 잡음 때문에 같은 값이 계속 나올 수 없음)
+//   - 포화가 HXG_OPEN_N 번 연속 → 브리지 끊김(또는 과부하)
+//   - Hampel: 최근 HXG_WINDOW 샘플 중앙값에서 K*1.4826*MAD 이상 튀면 스파이크로 버림
+//     계단 변화: 최근 HXG_STEP_N 샘플 중 2 개가 같은 새 수준이면 하중 변화로 보고 통과
+//     (첫 샘플 하나만 버려짐, 스파이크 카운터에는 안 셈)
+//     동적 계량 중에는 HXGuard_SetSpikeBypass 로 판정을 쉼 (출렁임도 추정에 필요)
+
+#define HXG_WINDOW      5       // Hampel 창 (홀수)
+#define HXG_K           3       // 판정 폭 [시그마]
+#define HXG_STEP_N      3       // 새 수준 확인 창 (이 안에서 2 샘플이 일치하면 계단)
+#define HXG_STUCK_N     16      // 같은 코드 연속 → 고착
+#define HXG_OPEN_N      8       // 포화 연속 → 브리지 끊김
+#define HXG_TIMEOUT_N   3       // 타임아웃 연속 → 칩 응답 없음
+
+// 현재 고장 (비트)
+#define HXG_FAULT_NO_CHIP   0x01
+#define HXG_FAULT_OPEN      0x02
+#define HXG_FAULT_STUCK     0x04
+
+typedef enum {
+    HXG_ACCEPT = 0,
+    HXG_REJECT_TIMEOUT,
+    HXG_REJECT_SAT,
+    HXG_REJECT_STUCK,
+    HXG_REJECT_SPIKE,
+} HXGuard_Result_t;
+
+// 누적 카운터 (샘플 수, open/stuck/no_chip 은 고장 발생 횟수)
+typedef struct {
+    uint32_t timeouts;
+    uint32_t saturations;
+    uint32_t spikes;
+    uint32_t stuck;
+    uint32_t open_bridge;
+    uint32_t no_chip;
+} HXGuard_Counters_t;
+
+// min_dev: 스파이크 판정 최소 폭 [raw] (MAD 가 0 에 가까울 때 작은 잡음까지 버리지 않게)
+void HXGuard_Init(int32_t min_dev);
+void HXGuard_SetMinDev(int32_t min_dev);
+
+// 1: 스파이크 판정 쉼 (타임아웃/포화/고착 검사는 계속, 창은 계속 채움)
+void HXGuard_SetSpikeBypass(uint8_t on);
+
+// HX711_Read 결과 검사
+HXGuard_Result_t HXGuard_Check(HX711_Status_t status, int32_t raw);
+
+const HXGuard_Counters_t *HXGuard_GetCounters(void);
+uint8_t HXGuard_GetFaults(void);
+
+#endif /* INC_HXGUARD_H_ */
@@ -0,0 +1,57 @@
+#ifndef INC_KALMAN_H_
+#define INC_KALMAN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 무게/변화율 2상태 칼만 필터 (정수 연산)
+//
+// 상태: w [mg], v [mg/s]  — 등속 모델, 가속도를 백색 잡음(q [mg²/s³])으로 봄
+// 측정: 무게 z [mg], 잡음 분산 r [mg²]
+//
+// 적응형 과정 잡음
+//   - 혁신(z - 예측)이 KALMAN_GATE 시그마를 넘으면 하중이 바뀐 것으로 보고 q = q_max,
+//     P00 도 혁신² 까지 키워서 다음 샘플부터 바로 새 무게를 따라감
+//   - 그 외에는 갱신마다 q 를 1/4 로 줄여 q_min 까지 → 안정 상태에서 잡음을 강하게 누름
+//
+// 공분산은 int64, 이득은 Q16
+
+#define KALMAN_GATE     4       // 하중 변화 판정 [시그마]
+#define KALMAN_INNOV_MAX  ( 1LL << 23 )  // 한 번에 반영하는 혁신 최대 [mg] (약 8.4kg, int64 여유 2^62)
+
+typedef struct {
+    int32_t  w;             // 추정 무게 [mg]
+    int32_t  v;             // 추정 변화율 [mg/s]
+    int64_t  p00, p01, p11; // 공분산 [mg², mg²/s, mg²/s²]
+    int64_t  r;             // 측정 잡음 분산 [mg²]
+    int64_t  q;             // 현재 과정 잡음 [mg²/s³]
+    int64_t  q_min, q_max;
+    uint16_t dt_ms;         // 갱신 주기
+    uint8_t  init;          // 첫 측정 받았으면 1
+} Kalman_t;
+
+// noise_mg: 측정 잡음 표준편차 [mg]
+void Kalman_Init(Kalman_t *kf, uint16_t dt_ms, int32_t noise_mg, int64_t q_min, int64_t q_max);
+
+// 상태 비움 (다음 측정으로 새로 시작)
+void Kalman_Reset(Kalman_t *kf);
+
+// 예측 + 측정 갱신, 추정 무게 [mg] 리턴
+int32_t Kalman_Update(Kalman_t *kf, int32_t z_mg);
+
+// 영점을 옮긴 만큼 상태도 옮김 (자동 영점 추적)
+void Kalman_Shift(Kalman_t *kf, int32_t d_mg);
+
+// 무게 추정 분산 [mg²]
+static inline int64_t Kalman_Var(const Kalman_t *kf)
+{
+    return kf->p00;
+}
+
+// 마지막 갱신에서 하중 변화가 감지됐는지
+static inline bool Kalman_Changed(const Kalman_t *kf)
+{
+    return kf->q >= kf->q_max;
+}
+
+#endif /* INC_KALMAN_H_ */
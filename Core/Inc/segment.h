@@ -0,0 +1,43 @@
+#ifndef INC_SEGMENT_H_
+#define INC_SEGMENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 이벤트 분할: 안정 무게가 나올 때마다 직전 안정 기준(baseline)과 비교해서
+// 올림/내림 이벤트 하나로 만듦
+//
+//   - |변화| >= min_delta 이면 이벤트 (새 번호), 기준을 새 무게로
+//   - 더 작은 변화는 이벤트 없이 기준만 갱신 (잔떨림/드리프트 흡수)
+//   - empty_band 안의 무게는 0 (빈 상태) 으로 봄
+//   - 동적 추정으로 먼저 낸 이벤트는 정적 값이 나오면 같은 번호로 정정 가능 (Segment_Amend)
+//     정정한 변화가 min_delta 안이면 이벤트가 아니었던 것 → 취소 (retract) 로 보고
+
+typedef enum {
+    SEG_ADD = 0,        // 물체 올라옴 (delta > 0)
+    SEG_REMOVE,         // 물체 내려감 (delta < 0)
+} Segment_Type_t;
+
+typedef struct {
+    Segment_Type_t type;
+    uint32_t seq;           // 부팅 후 이벤트 번호 (1 부터)
+    float    delta;         // 직전 기준 대비 변화 [g]
+    float    total;         // 이벤트 후 전체 무게 [g]
+    bool     amend;         // 이전 이벤트 정정
+    bool     retract;       // 정정해 보니 이벤트가 아니었음 → 이전 이벤트 취소 (amend 일 때만)
+} Segment_Event_t;
+
+void Segment_Init(float min_delta, float empty_band);
+
+// 새 안정 무게. 이벤트가 생기면 true
+bool Segment_Stable(float weight, Segment_Event_t *ev);
+
+// 마지막 이벤트의 무게를 정정 (정정할 이벤트가 없으면 Segment_Stable 과 같음)
+// 정정 후 변화가 min_delta 안이면 ev->retract (delta 는 남은 변화, total 은 지금 무게)
+bool Segment_Amend(float weight, Segment_Event_t *ev);
+
+// 기준 무게 (재Tare 후 0 으로)
+void  Segment_Rebase(float weight);
+float Segment_GetBaseline(void);
+
+#endif /* INC_SEGMENT_H_ */
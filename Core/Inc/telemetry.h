@@ -0,0 +1,45 @@
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+
+// 작은 메시지를 한 패킷으로 묶어서 내보내는 배치 단계
+// (LoRa 는 프리앰블+헤더+CRC 오버헤드가 커서 작은 페이로드를 여러 번 보내면 손해)
+//
+// 출력 형식
+//   - 레코드 1개: 레코드 그대로        {"weight":12.34}
+//   - 레코드 여러 개: {"b":[rec1,rec2,...]}
+//   - 레코드마다 넣은 시각 "ts"(HAL 틱 ms)가 끝에 붙음  {"weight":12.34,"ts":51234}
+//   - 패킷마다 UART 로 내보낸 시각 "te" 가 맨 바깥 객체 끝에 붙음
+//       {"weight":12.34,"ts":51234,"te":51234}   {"b":[rec1,rec2],"te":51240}
+
+#define TELEMETRY_MAX_PACKET   200   // 패킷 최대 길이 (LoRa 최대 255 이하)
+#define TELEMETRY_FLUSH_BYTES  160   // 이만큼 쌓이면 기한 전이라도 전송
+#define TELEMETRY_REC_MAX      160   // 레코드 하나 최대 길이 ("ts" 포함)
+#define TELEMETRY_STAMP_LEN    16    // 패킷 끝 ,"te":4294967295 자리 (최대 길이 안에서 미리 비워둠)
+
+typedef enum {
+    TELEMETRY_EVENT = 0,   // 무게 이벤트: 기본 기한 0 (즉시, 쌓인 것 같이 실어감)
+    TELEMETRY_HEALTH,      // 헬스 카운터: 최신값만 유지
+    TELEMETRY_FILL,        // 주기 채움량: 최신값만 유지
+    TELEMETRY_CLASS_COUNT
+} Telemetry_Class_t;
+
+// 패킷 하나를 실제로 내보내는 함수 (기본: UART 한 줄)
+typedef void (*Telemetry_Sink_t)(const char *packet, uint16_t len);
+
+void Telemetry_Init(Telemetry_Sink_t sink);
+
+// 종류별 최대 지연(ms). 0 이면 넣자마자 전송
+void Telemetry_SetDeadline(Telemetry_Class_t cls, uint32_t ms);
+
+// 레코드(JSON 객체 문자열) 추가
+void Telemetry_Push(Telemetry_Class_t cls, const char *rec);
+
+// 메인 루프에서 호출: 기한 지난 배치 전송
+void Telemetry_Poll(void);
+
+// 쌓인 것 즉시 전송
+void Telemetry_Flush(void);
+
+#endif /* INC_TELEMETRY_H_ */
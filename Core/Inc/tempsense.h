@@ -0,0 +1,33 @@
+#ifndef INC_TEMPSENSE_H_
+#define INC_TEMPSENSE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+
+// MCU 내부 온도 센서 (ADC1 IN18) + VREFINT (IN17)
+//
+// ADC1 레귤러 시퀀스에 온도/VREFINT 를 번갈아 TEMPSENSE_PAIRS 쌍 넣고 DMA 로 한 번에 받음
+//   - 메인 루프가 HX711 한 샘플 읽을 때마다 TempSense_Poll() → 끝난 묶음이 있으면 계산하고 다음 묶음 시작
+//   - ADC 가 도는 동안 CPU 는 HX711 처리 (묶음 하나 약 0.4ms)
+//   - VREFINT 로 VDDA 변화를 빼고, 공장 보정값(30도/110도)으로 온도 환산 (정수, 0.01도 단위)
+//
+// ※ 다이 온도라서 로드셀 온도와는 차이가 있음 → 느린 저역통과로 천천히 따라가게 함
+
+#define TEMPSENSE_PAIRS     8       // 한 묶음 온도/VREFINT 쌍 수 (시퀀스 16칸)
+#define TEMPSENSE_IIR_SHIFT 3       // 온도 저역통과 (새 값 1/8 반영)
+
+// ADC 시작 후 첫 묶음까지 기다림 (부팅 때 바로 온도가 필요해서)
+void TempSense_Init(ADC_HandleTypeDef *hadc);
+
+// 메인 루프에서 호출: 새 온도가 계산됐으면 true
+bool TempSense_Poll(void);
+
+// 현재 온도 [0.01 °C] / [°C]
+int32_t TempSense_GetCentiDeg(void);
+float   TempSense_Get(void);
+
+// HAL_ADC_ConvCpltCallback 에서 호출
+void TempSense_OnConvCplt(ADC_HandleTypeDef *hadc);
+
+#endif /* INC_TEMPSENSE_H_ */
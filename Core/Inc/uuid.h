@@ -0,0 +1,34 @@
+#ifndef INC_UUID_H_
+#define INC_UUID_H_
+
+#include <stdint.h>
+
+// RFC 4122 UUID 버전 4 (랜덤)
+//
+// STM32F446 에는 하드웨어 RNG 가 없어서
+//   - 96비트 MCU 고유 ID 로 생성기 상태를 시작 → 보드마다 다른 수열 (같은 시각에 부팅해도 안 겹침)
+//   - 센서 잡음(HX711 아래쪽 비트)과 DWT 사이클 카운터를 계속 섞어 넣음 → 같은 보드 재부팅에도 다른 수열
+//   - 생성기는 xoshiro128** (32비트 곱/시프트만)
+//
+// 바이너리 16바이트 그대로 프레임에 실을 수도 있고, 문자열(36자)로 바꿀 수도 있음
+
+#define UUID_BIN_LEN    16
+#define UUID_STR_LEN    37      // "xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx" + NUL
+
+typedef struct {
+    uint8_t b[UUID_BIN_LEN];    // 네트워크 바이트 순서 (RFC 4122)
+} Uuid_t;
+
+// 고유 ID 로 시드 (DWT 사이클 카운터가 켜진 뒤에 호출하면 부팅 시간 흔들림도 들어감)
+void Uuid_Init(void);
+
+// 잡음 섞기 (샘플마다 불러도 될 만큼 가벼움)
+void Uuid_AddEntropy(uint32_t x);
+
+// 새 v4 UUID
+void Uuid_New(Uuid_t *u);
+
+// 소문자 16진 문자열 (printf 없이)
+void Uuid_ToString(const Uuid_t *u, char out[UUID_STR_LEN]);
+
+#endif /* INC_UUID_H_ */
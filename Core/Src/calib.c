@@ -0,0 +1,236 @@
+#include "main.h"
+#include "calib.h"
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+// 플래시에 실제로 쓰는 레코드 (CALIB_SLOT_SIZE 칸 하나에 하나)
+typedef struct {
+    uint32_t     magic;
+    uint16_t     version;
+    uint16_t     length;        // sizeof(Calib_Record_t)
+    uint32_t     seq;           // 저장할 때마다 +1
+    Calib_Data_t data;
+    uint32_t     crc;           // 앞쪽 전체 CRC32
+} Calib_Record_t;
+
+_Static_assert(sizeof(Calib_Record_t) <= CALIB_SLOT_SIZE, "calib record too big");
+_Static_assert(CALIB_SLOT_SIZE % 4 == 0, "calib slot must be word aligned");
+
+#define CALIB_SLOTS     ( CALIB_SECTOR_SIZE / CALIB_SLOT_SIZE )
+
+static const uint32_t sector_addr[2] = { CALIB_ADDR_A, CALIB_ADDR_B };
+static const uint32_t sector_id[2]   = { CALIB_SECTOR_A, CALIB_SECTOR_B };
+
+// 마지막 레코드 위치 (Load/Save 에서 갱신)
+static uint32_t last_seq = 0;
+static int      last_sector = -1;
+static uint32_t next_slot = 0;      // last_sector 안의 다음 빈 칸
+
+static uint32_t Calib_Crc32(const uint8_t *p, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+    }
+    return ~crc;
+}
+
+static const Calib_Record_t *Calib_Slot(int sector, uint32_t slot)
+{
+    return (const Calib_Record_t *)(sector_addr[sector] + slot * CALIB_SLOT_SIZE);
+}
+
+static bool Calib_IsValid(const Calib_Record_t *r)
+{
+    return r->magic == CALIB_MAGIC &&
+           r->version == CALIB_VERSION &&
+           r->length == sizeof(Calib_Record_t) &&
+           r->data.n_cells <= CALIB_MAX_CELLS &&
+           r->crc == Calib_Crc32((const uint8_t *)r, offsetof(Calib_Record_t, crc));
+}
+
+// 칸 전체가 지워진 상태(0xFF)인지 (쓰다 만 칸은 건너뛰어야 함)
+static bool Calib_IsBlank(int sector, uint32_t slot)
+{
+    const uint32_t *w = (const uint32_t *)Calib_Slot(sector, slot);
+    for (uint32_t i = 0; i < CALIB_SLOT_SIZE / 4; i++) {
+        if (w[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+// 섹터에서 첫 빈 칸 (없으면 CALIB_SLOTS)
+static uint32_t Calib_FindFree(int sector)
+{
+    uint32_t slot = CALIB_SLOTS;
+    // 뒤에서부터: 마지막으로 쓴 칸 바로 다음이 빈 칸
+    while (slot > 0 && Calib_IsBlank(sector, slot - 1)) slot--;
+    return slot;
+}
+
+bool Calib_Load(Calib_Data_t *data)
+{
+    const Calib_Record_t *best = NULL;
+
+    for (int s = 0; s < 2; s++) {
+        for (uint32_t i = 0; i < CALIB_SLOTS; i++) {
+            const Calib_Record_t *r = Calib_Slot(s, i);
+            if (r->magic == 0xFFFFFFFFu && Calib_IsBlank(s, i)) break;   // 이 뒤로는 빈 칸
+            if (!Calib_IsValid(r)) continue;
+            if (best == NULL || (int32_t)(r->seq - best->seq) > 0) {
+                best = r;
+                last_sector = s;
+            }
+        }
+    }
+
+    if (best == NULL) {
+        last_seq = 0;
+        last_sector = -1;
+        return false;
+    }
+
+    last_seq = best->seq;
+    next_slot = Calib_FindFree(last_sector);
+    memcpy(data, &best->data, sizeof(*data));
+    return true;
+}
+
+static bool Calib_EraseSector(int sector)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t error = 0;
+
+    erase.TypeErase    = FLASH_TYPEERASE_SECTORS;
+    erase.Sector       = sector_id[sector];
+    erase.NbSectors    = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    return HAL_FLASHEx_Erase(&erase, &error) == HAL_OK;
+}
+
+bool Calib_Save(const Calib_Data_t *data)
+{
+    Calib_Record_t rec;
+    uint32_t words[CALIB_SLOT_SIZE / 4];
+
+    // 어디에 쓸지: 현재 섹터에 빈 칸이 있으면 거기, 없으면 반대쪽 섹터를 지우고 처음부터
+    int sector = (last_sector < 0) ? 0 : last_sector;
+    uint32_t slot = (last_sector < 0) ? Calib_FindFree(0) : next_slot;
+    bool erase = false;
+
+    if (slot >= CALIB_SLOTS) {
+        sector = (last_sector < 0) ? 1 : (1 - last_sector);
+        slot = 0;
+        erase = !Calib_IsBlank(sector, 0) || Calib_FindFree(sector) != 0;
+    }
+
+    memset(&rec, 0xFF, sizeof(rec));
+    rec.magic   = CALIB_MAGIC;
+    rec.version = CALIB_VERSION;
+    rec.length  = sizeof(Calib_Record_t);
+    rec.seq     = last_seq + 1;
+    memcpy(&rec.data, data, sizeof(rec.data));
+    rec.crc     = Calib_Crc32((const uint8_t *)&rec, offsetof(Calib_Record_t, crc));
+
+    memset(words, 0xFF, sizeof(words));
+    memcpy(words, &rec, sizeof(rec));
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+                           FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+
+    bool ok = !erase || Calib_EraseSector(sector);
+    uint32_t addr = (uint32_t)Calib_Slot(sector, slot);
+    for (uint32_t i = 0; ok && i < CALIB_SLOT_SIZE / 4; i++) {
+        if (words[i] == 0xFFFFFFFFu) continue;      // 지워진 값 그대로
+        ok = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + i * 4, words[i]) == HAL_OK;
+    }
+    HAL_FLASH_Lock();
+
+    // 실패해도 쓰다 만 칸은 다시 못 쓰므로 다음 칸으로 넘어감
+    last_sector = sector;
+    next_slot = slot + 1;
+    if (!ok || !Calib_IsValid(Calib_Slot(sector, slot))) return false;
+
+    last_seq = rec.seq;
+    return true;
+}
+
+uint32_t Calib_GetSeq(void)
+{
+    return last_seq;
+}
+
+bool Calib_FitLut(const Calib_Point_t *pts, uint8_t n, Calib_Lut_t *lut)
+{
+    Calib_Point_t p[CALIB_MAX_POINTS + 1];
+    uint8_t m = 0;
+    int32_t raw_max = 0;
+
+    // 영점 (0, 0g) + 양수 기준점들을 raw 오름차순으로 (삽입 정렬)
+    p[m].raw = 0;
+    p[m].grams = 0.0f;
+    m++;
+    for (uint8_t k = 0; k < n && k < CALIB_MAX_POINTS; k++) {
+        if (pts[k].raw <= 0) continue;
+        uint8_t j = m;
+        while (j > 0 && p[j - 1].raw > pts[k].raw) {
+            p[j] = p[j - 1];
+            j--;
+        }
+        if (j > 0 && p[j - 1].raw == pts[k].raw) {
+            // 같은 raw 는 하나만
+            for (uint8_t t = j; t < m; t++) p[t] = p[t + 1];
+            continue;
+        }
+        p[j] = pts[k];
+        m++;
+        if (pts[k].raw > raw_max) raw_max = pts[k].raw;
+    }
+    if (m < 2) return false;
+
+    // 가장 무거운 기준점 + 25% 까지 덮도록 구간 폭 결정 (노드 하나는 영점 아래용)
+    int32_t span = raw_max + raw_max / 4;
+    uint8_t shift = 0;
+    while (((int32_t)(CALIB_LUT_NODES - 2) << shift) < span && shift < 26) shift++;
+
+    lut->shift = shift;
+    lut->bias = 1 << shift;
+    lut->reserved = 0;
+
+    for (int j = 0; j < CALIB_LUT_NODES; j++) {
+        int32_t x = (j << shift) - lut->bias;
+
+        // x 를 포함하는 기준점 구간 (양 끝 밖은 끝 구간 연장)
+        uint8_t k = 0;
+        while (k < m - 2 && x > p[k + 1].raw) k++;
+
+        float g = p[k].grams + (float)(x - p[k].raw) *
+                  (p[k + 1].grams - p[k].grams) / (float)(p[k + 1].raw - p[k].raw);
+        lut->mg[j] = (int32_t)lrintf(g * 1000.0f);
+    }
+    lut->valid = 1;
+    return true;
+}
+
+float Calib_FitScale(const Calib_Point_t *pts, uint8_t n)
+{
+    // scale = sum(raw*g) / sum(g*g)  (raw = scale * g, 원점 통과)
+    double rg = 0.0, gg = 0.0;
+    for (uint8_t k = 0; k < n; k++) {
+        rg += (double)pts[k].raw * pts[k].grams;
+        gg += (double)pts[k].grams * pts[k].grams;
+    }
+    return (gg > 0.0) ? (float)(rg / gg) : 0.0f;
+}
+
+void Calib_Compensate(const Calib_Cell_t *cell, float temp, int32_t *offset, float *scale)
+{
+    float dt = temp - cell->ref_temp;
+    *offset = cell->offset + (int32_t)(cell->tc_offset * dt);
+    *scale  = cell->scale * (1.0f + cell->tc_scale * dt);
+}
@@ -0,0 +1,110 @@
+#include "dynweigh.h"
+#include <math.h>
+#include <string.h>
+
+#define N_PARAM 3
+
+static DynWeigh_State_t state = DYN_IDLE;
+static float theta[N_PARAM];            // a1, a2, c
+static float P[N_PARAM][N_PARAM];
+static float y_1, y_2;                    // 직전 두 샘플
+static uint16_t n;                      // 받은 샘플 수
+static float est;                       // 최신 정착값 추정
+static float hist[DYN_AGREE_N];         // 최근 추정들
+static uint8_t agree;                   // hist 에 찬 개수
+
+void DynWeigh_Start(void)
+{
+    memset(theta, 0, sizeof(theta));
+    memset(P, 0, sizeof(P));
+    for (int i = 0; i < N_PARAM; i++) P[i][i] = DYN_P0;
+    n = 0;
+    agree = 0;
+    est = 0.0f;
+    state = DYN_RUNNING;
+}
+
+void DynWeigh_Stop(void)
+{
+    state = DYN_IDLE;
+}
+
+// 안정한 2차 시스템인지 (극점이 단위원 안)
+static bool DynWeigh_IsStable(float a1, float a2)
+{
+    return fabsf(a2) < 1.0f && fabsf(a1) < 1.0f - a2;
+}
+
+static void DynWeigh_Update(float y)
+{
+    const float phi[N_PARAM] = { y_1, y_2, 1.0f };
+    float Pphi[N_PARAM];
+    float denom = DYN_LAMBDA;
+
+    for (int i = 0; i < N_PARAM; i++) {
+        Pphi[i] = 0.0f;
+        for (int j = 0; j < N_PARAM; j++) Pphi[i] += P[i][j] * phi[j];
+        denom += phi[i] * Pphi[i];
+    }
+
+    float err = y;
+    for (int i = 0; i < N_PARAM; i++) err -= theta[i] * phi[i];
+
+    // K = P*phi / (lambda + phi'*P*phi), theta += K*err, P = (P - K*phi'*P) / lambda
+    float inv = 1.0f / denom;
+    for (int i = 0; i < N_PARAM; i++) theta[i] += Pphi[i] * inv * err;
+    for (int i = 0; i < N_PARAM; i++) {
+        for (int j = 0; j < N_PARAM; j++) {
+            P[i][j] = (P[i][j] - Pphi[i] * Pphi[j] * inv) / DYN_LAMBDA;
+        }
+    }
+}
+
+DynWeigh_State_t DynWeigh_Push(float w)
+{
+    if (state != DYN_RUNNING) return state;
+
+    if (n >= 2) DynWeigh_Update(w);
+    y_2 = (n >= 1) ? y_1 : w;
+    y_1 = w;
+    n++;
+
+    if (n < DYN_MIN_N) return state;
+
+    float gain = 1.0f - theta[0] - theta[1];
+    if (fabsf(gain) > 1e-3f && DynWeigh_IsStable(theta[0], theta[1])) {
+        est = theta[2] / gain;
+
+        // 최근 추정들이 DYN_TOL_G 안에 모이면 수렴
+        memmove(&hist[1], &hist[0], (DYN_AGREE_N - 1) * sizeof(float));
+        hist[0] = est;
+        if (agree < DYN_AGREE_N) agree++;
+
+        if (agree == DYN_AGREE_N) {
+            float lo = hist[0], hi = hist[0];
+            for (int i = 1; i < DYN_AGREE_N; i++) {
+                if (hist[i] < lo) lo = hist[i];
+                if (hist[i] > hi) hi = hist[i];
+            }
+            if (hi - lo < DYN_TOL_G) {
+                state = DYN_CONVERGED;
+                return state;
+            }
+        }
+    } else {
+        agree = 0;
+    }
+
+    if (n >= DYN_MAX_N) state = DYN_FAILED;
+    return state;
+}
+
+float DynWeigh_Get(void)
+{
+    return est;
+}
+
+DynWeigh_State_t DynWeigh_GetState(void)
+{
+    return state;
+}
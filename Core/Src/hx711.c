@@ -33,17 +33,17 @@ void HX711_Init(HX711_t *hx,
 }
 
 // 24bit 데이터 읽기
-int32_t HX711_ReadRaw(HX711_t *hx)
+HX711_Status_t HX711_Read(HX711_t *hx, int32_t *value)
 {
     uint32_t data = 0;
 
-    // 데이터 준비 대기 (최대 200ms)
-    uint32_t timeout = HAL_GetTick() + 200;
+    // 데이터 준비 대기 (최대 HX711_TIMEOUT_MS)
+    uint32_t start = HAL_GetTick();
     while (!HX711_IsReady(hx)) {
 
-    	// 타임아웃 에러 처
-        if (HAL_GetTick() > timeout) {
-            return 0;
+    	// 타임아웃 에러 처리
+        if (HAL_GetTick() - start > HX711_TIMEOUT_MS) {
+            return HX711_TIMEOUT;
         }
     }
 
@@ -85,7 +85,18 @@ int32_t HX711_ReadRaw(HX711_t *hx)
         data |= 0xFF000000;
     }
 
-    return (int32_t)data;
+    *value = (int32_t)data;
+    if (*value == HX711_RAW_MAX || *value == HX711_RAW_MIN) {
+        return HX711_SATURATED;
+    }
+    return HX711_OK;
+}
+
+int32_t HX711_ReadRaw(HX711_t *hx)
+{
+    int32_t raw = 0;
+    HX711_Read(hx, &raw);
+    return raw;
 }
 
 // 영점 잡기: 여러 번 읽어서 평균값을 offset으로 두기
@@ -94,11 +105,17 @@ int32_t HX711_Tare(HX711_t *hx, uint8_t times)
     if (times == 0) times = 1;
 
     int64_t sum = 0;
+    uint8_t got = 0;
     for (uint8_t i = 0; i < times; i++) {
-        sum += HX711_ReadRaw(hx);
+        int32_t raw;
+        if (HX711_Read(hx, &raw) == HX711_OK) {
+            sum += raw;
+            got++;
+        }
         HAL_Delay(10); // 영점 잡을 때 여유값
     }
-    hx->offset = (int32_t)(sum / times);
+    // 전부 실패면 이전 영점 유지
+    if (got > 0) hx->offset = (int32_t)(sum / got);
     return hx->offset;
 }
 
@@ -107,14 +124,19 @@ float HX711_GetWeight(HX711_t *hx, uint8_t times)
 {
     if (times == 0) times = 1;
     int64_t sum = 0;
+    uint8_t got = 0;
 
     for (uint8_t i = 0; i < times; i++) {
-        int32_t raw = HX711_ReadRaw(hx);
-        sum += raw;
+        int32_t raw;
+        if (HX711_Read(hx, &raw) == HX711_OK) {
+            sum += raw;
+            got++;
+        }
         HAL_Delay(10);
     }
+    if (got == 0) return 0.0f;
 
-    int32_t avg = (int32_t)(sum / times);
+    int32_t avg = (int32_t)(sum / got);
     int32_t net = avg - hx->offset;
 
     if (hx->scale == 0.0f) {
@@ -0,0 +1,139 @@
+#include "hxguard.h"
+#include <stdlib.h>
+#include <string.h>
+
+static HXGuard_Counters_t cnt;
+static uint8_t faults = 0;
+static int32_t min_dev_raw = 0;
+
+static int32_t win[HXG_WINDOW];     // 최근 정상 샘플 (원형)
+static uint8_t win_idx = 0;
+static uint8_t win_n = 0;
+static uint8_t bypass = 0;          // 1: 스파이크 판정 쉼 (동적 계량 중)
+
+static int32_t step_raw = 0;        // 직전에 스파이크로 버린 샘플 (새 수준 후보)
+static uint8_t step_age = 0;        // 그 뒤 지난 샘플 수 (0: 후보 없음)
+
+static int32_t last_raw = 0;
+static uint16_t same_run = 0;       // 같은 코드 연속 수
+static uint16_t sat_run = 0;        // 포화 연속 수
+static uint16_t to_run = 0;         // 타임아웃 연속 수
+
+// n 개 (n <= HXG_WINDOW) 중앙값 (복사해서 삽입 정렬)
+static int32_t HXGuard_Median(const int32_t *v, uint8_t n)
+{
+    int32_t s[HXG_WINDOW];
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t x = v[i];
+        uint8_t j = i;
+        while (j > 0 && s[j - 1] > x) {
+            s[j] = s[j - 1];
+            j--;
+        }
+        s[j] = x;
+    }
+    return s[n / 2];
+}
+
+void HXGuard_Init(int32_t min_dev)
+{
+    memset(&cnt, 0, sizeof(cnt));
+    faults = 0;
+    min_dev_raw = min_dev;
+    win_idx = win_n = 0;
+    same_run = sat_run = to_run = 0;
+    bypass = 0;
+    step_age = 0;
+}
+
+void HXGuard_SetSpikeBypass(uint8_t on)
+{
+    bypass = on;
+}
+
+void HXGuard_SetMinDev(int32_t min_dev)
+{
+    min_dev_raw = min_dev;
+}
+
+// 고장 비트 켜기 (새로 켜질 때만 카운트)
+static void HXGuard_Raise(uint8_t bit, uint32_t *counter)
+{
+    if (!(faults & bit)) {
+        faults |= bit;
+        (*counter)++;
+    }
+}
+
+HXGuard_Result_t HXGuard_Check(HX711_Status_t status, int32_t raw)
+{
+    if (status == HX711_TIMEOUT) {
+        cnt.timeouts++;
+        if (++to_run >= HXG_TIMEOUT_N) HXGuard_Raise(HXG_FAULT_NO_CHIP, &cnt.no_chip);
+        return HXG_REJECT_TIMEOUT;
+    }
+    to_run = 0;
+    faults &= ~HXG_FAULT_NO_CHIP;
+
+    if (status == HX711_SATURATED) {
+        cnt.saturations++;
+        if (++sat_run >= HXG_OPEN_N) HXGuard_Raise(HXG_FAULT_OPEN, &cnt.open_bridge);
+        return HXG_REJECT_SAT;
+    }
+    sat_run = 0;
+    faults &= ~HXG_FAULT_OPEN;
+
+    // 값 고착
+    if (raw == last_raw) {
+        if (++same_run >= HXG_STUCK_N - 1) {
+            HXGuard_Raise(HXG_FAULT_STUCK, &cnt.stuck);
+            return HXG_REJECT_STUCK;
+        }
+    } else {
+        same_run = 0;
+        faults &= ~HXG_FAULT_STUCK;
+    }
+    last_raw = raw;
+
+    // Hampel: 창이 찼을 때만 판정, 판정과 상관없이 창에는 넣음 (계단 변화를 따라가게)
+    HXGuard_Result_t res = HXG_ACCEPT;
+    if (step_age > 0 && ++step_age > HXG_STEP_N) step_age = 0;
+    if (win_n == HXG_WINDOW && !bypass) {
+        int32_t med = HXGuard_Median(win, win_n);
+        int32_t dev[HXG_WINDOW];
+        for (uint8_t i = 0; i < win_n; i++) dev[i] = abs(win[i] - med);
+        int32_t mad = HXGuard_Median(dev, win_n);
+
+        int32_t thr = (HXG_K * 3 * mad) / 2;     // K * 1.4826 * MAD ≈ K * 1.5 * MAD
+        if (thr < min_dev_raw) thr = min_dev_raw;
+        if (abs(raw - med) > thr) {
+            if (step_age > 0 && abs(raw - step_raw) <= thr) {
+                // 최근 HXG_STEP_N 샘플 중 2 개가 같은 새 수준 → 스파이크가 아니라 하중 변화
+                // 창을 새 수준으로 채워서 뒤따르는 샘플도 바로 통과, 앞서 버린 후보는 스파이크에서 뺌
+                for (uint8_t i = 0; i < HXG_WINDOW; i++) win[i] = raw;
+                cnt.spikes--;
+                step_age = 0;
+                return HXG_ACCEPT;
+            }
+            step_raw = raw;
+            step_age = 1;
+            cnt.spikes++;
+            res = HXG_REJECT_SPIKE;
+        }
+    }
+
+    win[win_idx] = raw;
+    win_idx = (win_idx + 1) % HXG_WINDOW;
+    if (win_n < HXG_WINDOW) win_n++;
+    return res;
+}
+
+const HXGuard_Counters_t *HXGuard_GetCounters(void)
+{
+    return &cnt;
+}
+
+uint8_t HXGuard_GetFaults(void)
+{
+    return faults;
+}
@@ -0,0 +1,98 @@
+#include "kalman.h"
+
+void Kalman_Init(Kalman_t *kf, uint16_t dt_ms, int32_t noise_mg, int64_t q_min, int64_t q_max)
+{
+    kf->dt_ms = dt_ms;
+    kf->r = (int64_t)noise_mg * noise_mg;
+    kf->q_min = q_min;
+    kf->q_max = q_max;
+    Kalman_Reset(kf);
+}
+
+void Kalman_Reset(Kalman_t *kf)
+{
+    kf->w = 0;
+    kf->v = 0;
+    kf->p00 = kf->p01 = kf->p11 = 0;
+    kf->q = kf->q_max;
+    kf->init = 0;
+}
+
+// int32 범위로 자름 (입력이 int32 양 끝이어도 상태가 넘치지 않게)
+static int32_t Kalman_Sat(int64_t x)
+{
+    if (x > INT32_MAX) return INT32_MAX;
+    if (x < INT32_MIN) return INT32_MIN;
+    return (int32_t)x;
+}
+
+static void Kalman_Predict(Kalman_t *kf)
+{
+    const int64_t dt = kf->dt_ms;
+    const int64_t q = kf->q;
+
+    // x = F x,  F = [1 dt; 0 1]
+    kf->w = Kalman_Sat(kf->w + ((int64_t)kf->v * dt) / 1000);
+
+    // P = F P F' + Q,  Q = q * [dt³/3 dt²/2; dt²/2 dt]  (dt 는 ms → 단위 맞춤)
+    kf->p00 += (2 * kf->p01 * dt) / 1000 + (kf->p11 * dt * dt) / 1000000 + (q * dt * dt * dt) / 3000000000LL;
+    kf->p01 += (kf->p11 * dt) / 1000 + (q * dt * dt) / 2000000;
+    kf->p11 += (q * dt) / 1000;
+}
+
+int32_t Kalman_Update(Kalman_t *kf, int32_t z_mg)
+{
+    if (!kf->init) {
+        // 첫 측정: 그 값에서 시작, 불확실성은 측정 잡음만큼
+        kf->w = z_mg;
+        kf->v = 0;
+        kf->p00 = kf->r;
+        kf->p01 = 0;
+        kf->p11 = kf->r;
+        kf->init = 1;
+        return kf->w;
+    }
+
+    Kalman_Predict(kf);
+
+    int64_t innov = (int64_t)z_mg - kf->w;
+    // 혁신²(<<16), K*P 가 int64 를 넘지 않게 제한. 더 큰 변화는 몇 샘플에 나눠 따라감
+    if (innov > KALMAN_INNOV_MAX) innov = KALMAN_INNOV_MAX;
+    if (innov < -KALMAN_INNOV_MAX) innov = -KALMAN_INNOV_MAX;
+    int64_t s = kf->p00 + kf->r;
+
+    // 하중 변화 판정: innov² > GATE² * S
+    if (innov * innov > (int64_t)KALMAN_GATE * KALMAN_GATE * s) {
+        kf->q = kf->q_max;
+        if (kf->p00 < innov * innov) {
+            kf->p00 = innov * innov;
+            s = kf->p00 + kf->r;
+        }
+    } else if (kf->q > kf->q_min) {
+        kf->q >>= 2;
+        if (kf->q < kf->q_min) kf->q = kf->q_min;
+    }
+
+    // K = P H' / S  (Q16)
+    int64_t k0 = (kf->p00 << 16) / s;
+    int64_t k1 = (kf->p01 << 16) / s;
+
+    // 반올림 (>> 16 내림만 쓰면 이득이 작을 때 0.5/K mg 만큼 아래로 치우침)
+    kf->w = Kalman_Sat(kf->w + ((k0 * innov + 0x8000) >> 16));
+    kf->v = Kalman_Sat(kf->v + ((k1 * innov + 0x8000) >> 16));
+
+    // P = (I - K H) P
+    int64_t p00 = kf->p00, p01 = kf->p01;
+    kf->p00 = p00 - ((k0 * p00) >> 16);
+    kf->p01 = p01 - ((k0 * p01) >> 16);
+    kf->p11 = kf->p11 - ((k1 * p01) >> 16);
+    if (kf->p00 < 0) kf->p00 = 0;
+    if (kf->p11 < 0) kf->p11 = 0;
+
+    return kf->w;
+}
+
+void Kalman_Shift(Kalman_t *kf, int32_t d_mg)
+{
+    kf->w = Kalman_Sat((int64_t)kf->w + d_mg);
+}
@@ -19,16 +19,57 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "hx711.h"
+#include "telemetry.h"
+#include "calib.h"
+#include "tempsense.h"
+#include "dynweigh.h"
+#include "kalman.h"
+#include "hxguard.h"
+#include "segment.h"
+#include "uuid.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
 #define STABLE_THRESHOLD 10.0f   // 10g 이내면 안정
 #define STABLE_COUNT     3       // 연속 안정 카운트
-#define AVG_N            10      // 이동평균 창 길이
 
-#define OBJECT_ON_THRESH   40.0f   // 이 이상이면 "물체 올라옴" 후보
-#define OBJECT_OFF_THRESH  15.0f   // 이 이하로 떨어지면 "물체 내려감
+// 칼만 필터 (정적 판정 주기마다 갱신)
+#define KF_NOISE_MG        500              // 측정 잡음 표준편차 [mg]
+#define KF_Q_MIN           1000LL           // 안정 상태 과정 잡음 [mg²/s³]
+#define KF_Q_MAX           100000000000LL   // 하중 변화 직후 과정 잡음
+#define KF_STABLE_RATE_G   20.0f            // 변화율이 이보다 작고
+#define KF_STABLE_SD_G     2.0f             // 추정 표준편차도 이보다 작으면 안정 샘플
+
+#define OBJECT_ON_THRESH   40.0f   // 안정 기준에서 이만큼 바뀌면 물체 올림/내림 (이벤트 최소 변화)
+#define OBJECT_OFF_THRESH  15.0f   // 전체 무게가 이 안이면 빈 상태
+
+#define STATIC_PERIOD_MS   100     // 정적 판정 주기 (이 사이 샘플은 평균해서 한 번에)
+#define DYN_HOLD_MS        2000    // 동적 추정 보고 후 정적 판정이 따라올 때까지 기다리는 최대 시간
+
+#define HEALTH_PERIOD_MS   10000   // 헬스 카운터 수집 주기 (전송은 배치 기한에 따름)
+#define FILL_PERIOD_MS     5000    // 채움량(현재 무게) 수집 주기
+
+#define DEFAULT_SCALE      11110.0f // 저장된 보정값이 없을 때 scale (아이폰 141g 기준)
+#define DRIFT_CHECK_N      5        // 부팅 시 영점 드리프트 확인 샘플 수
+#define DRIFT_MAX_G        20.0f    // 이보다 크면 뭔가 올라가 있다고 보고 저장된 영점 유지
+#define DRIFT_SAVE_G       0.5f     // 이보다 크게 움직였으면 새 영점 저장
+
+#define SPIKE_MIN_G        3.0f     // 스파이크 판정 최소 폭 (Hampel MAD 가 작을 때)
+
+#define TARE_N             20       // 재Tare 평균 샘플 수 (메인 루프에서 한 샘플씩)
+
+// 자동 영점 추적 (AZT): 안정 + 영점 근처에서만 영점을 천천히 따라감
+#define AZT_BAND_G         2.0f     // |무게| 가 이 안일 때만 추적 (이 안은 "빈 상태"로 봄)
+#define AZT_STEP_G         0.05f    // 샘플당 최대 보정량 (루프 100ms → 최대 0.5 g/s)
+#define AZT_LIMIT_G        20.0f    // 마지막 Tare 이후 누적 보정 한도 (넘으면 추적 멈춤)
+#define AZT_SAVE_G         1.0f     // 저장된 영점과 이만큼 벌어지면 플래시에 저장
+
+#define TC_MAX_POINTS      8        // 온도계수 학습점 최대 개수 (영점/감도 각각)
+#define TC_MIN_SPAN_C      5.0f     // 학습점 온도 폭이 이보다 좁으면 계수 안 만듦
+
+#define CMD_MAX            48       // UART 명령 한 줄 최대 길이
+#define CAL_AVG_N          20       // 다점 보정 기준점 하나당 평균 샘플 수
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 
@@ -46,35 +87,85 @@
 
 /* Private macro -------------------------------------------------------------*/
 /* USER CODE BEGIN PM */
-// 이동평균 버퍼
-static float avg_buf[AVG_N];
-static int   avg_idx = 0;
-static int   avg_filled = 0;
+// 무게 필터
+static Kalman_t kf;
 // 시퀀스(줄 번호)로 세션/출력 구분
 static uint32_t seq = 0;
 
 static int is_stable = 0;
 static float stable_weight = 0.0f;
+
+// 동적 계량 (안정 상태에서 대기, 무게가 OBJECT_ON_THRESH 이상 바뀌면 시작)
+static uint8_t  dyn_armed = 1;
+static uint8_t  dyn_hold = 0;      // 동적 추정으로 보고함 → 정적 판정이 따라올 때까지 STABLE OFF 안 함
+static uint32_t dyn_hold_tick = 0;
+
+// 지연 추적: 이벤트 레코드에 추적 번호 "tr" + 무게 변화가 처음 보인 HX711 샘플 시각 "t0"
+// (안정 판정 시각은 레코드를 넣은 시각 "ts", UART 송신 시각은 패킷의 "te")
+static uint32_t load_tick = 0;        // 0: 지난 안정 이후 아직 변화 없음
+static uint32_t event_load_tick = 0;  // 지금 이벤트의 t0 (정정 레코드도 같은 값)
+static uint16_t trace_seq = 0;
+
+// 헬스 카운터 (센서 고장/버린 샘플은 hxguard)
+static uint32_t tare_count = 0;   // 재Tare 횟수
+
+// 플래시 보정값 (영점이 바뀌면 메인 루프에서 저장)
+static Calib_Data_t calib;
+static volatile uint8_t calib_dirty = 0;
+
+// 재Tare 요청 (버튼 인터럽트 → 메인 루프가 샘플 모아서 처리)
+static volatile uint8_t tare_req = 0;
+static uint8_t tare_left = 0;
+static int64_t tare_sum = 0;
+// 자동 영점 추적 누적량 [raw]
+static int32_t azt_total = 0;
+
+// 다점 보정 기준점 (CAL ADD 로 모음, CAL FIT 으로 보정표 생성)
+static Calib_Point_t cal_pts[CALIB_MAX_POINTS];
+static uint8_t cal_n = 0;
+
+// 온도 보정 (온도가 새로 잴 때마다 갱신, 샘플마다는 정수 연산만)
+//   hx.offset 은 기준 온도(ref_temp) 에서의 영점 → 지금 영점 = hx.offset + temp_off
+//   감도 변화는 net 에 Q16 배율로
+static int32_t temp_off = 0;
+static int32_t temp_span_q16 = 65536;
+
+// 온도계수 학습점 (CAL TC 로 모음)
+static float   tc_zero_t[TC_MAX_POINTS], tc_zero_raw[TC_MAX_POINTS];
+static float   tc_span_t[TC_MAX_POINTS], tc_span_val[TC_MAX_POINTS];
+static uint8_t tc_zero_n = 0, tc_span_n = 0;
+static int32_t tc_last_zero = 0;
+static uint8_t tc_have_zero = 0;
+
+// UART 명령 수신 (한 바이트씩 인터럽트, 줄 끝에서 cmd_ready)
+static uint8_t uart_rx_byte;
+static char    cmd_buf[CMD_MAX];
+static uint8_t cmd_len = 0;
+static char    cmd_line[CMD_MAX];
+static volatile uint8_t cmd_ready = 0;
 // === 함수 선언 ===
-static void avg_reset(void);
-static float avg_push(float v);
-static int   is_saturated(int32_t raw);
+static void  cmd_handle(const char *line);
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
+ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+
 HX711_t hx;
 UART_HandleTypeDef huart2;
 
 /* USER CODE BEGIN PV */
-// UUID
-static uint32_t uuid_counter = 0;
-static char current_event_uuid[37] = {0};
+// 현재 이벤트 UUID (정정할 때 같은 값)
+static Uuid_t current_event_id;
+static char current_event_uuid[UUID_STR_LEN] = {0};
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
+static void MX_ADC1_Init(void);
 /* USER CODE BEGIN PFP */
 int __io_putchar(int ch)
 {
@@ -82,35 +173,226 @@ int __io_putchar(int ch)
 	return ch;
 }
 
-// UUID
-void generate_uuid(char *uuid_str);
-static int first_stable_sent = 0;   // 0: 아직 uuid 출력 안함, 1: 이미 출력함
 
-// 평균 구하기
-static void avg_reset(void) {
-  for (int i = 0; i < AVG_N; i++) avg_buf[i] = 0.0f;
-  avg_idx = 0;
-  avg_filled = 0;
+// 현재 온도로 영점/감도 보정값 다시 계산
+static void temp_comp_update(void) {
+  Calib_Cell_t *cell = &calib.cell[0];
+  int32_t off;
+  float sc;
+
+  Calib_Compensate(cell, TempSense_Get(), &off, &sc);
+  temp_off = off - cell->offset;
+  temp_span_q16 = (sc > 0.0f && cell->scale > 0.0f) ? (int32_t)lrintf(65536.0f * cell->scale / sc) : 65536;
 }
 
-static float avg_push(float v) {
-  avg_buf[avg_idx] = v;
-  avg_idx = (avg_idx + 1) % AVG_N;
-  if (avg_filled < AVG_N) avg_filled++;
+// raw → 영점 빼고 온도 보정한 net
+static int32_t net_from_raw(int32_t raw) {
+  return (int32_t)(((int64_t)(raw - hx.offset - temp_off) * temp_span_q16) >> 16);
+}
 
-  float s = 0.0f;
-  for (int i = 0; i < avg_filled; i++) s += avg_buf[i];
-  return s / (float)avg_filled;
+// raw 평균 (타임아웃/포화 샘플은 건너뜀, 전부 실패면 INT32_MIN)
+static int32_t cal_read_raw(int n) {
+  int64_t sum = 0;
+  int got = 0;
+  for (int i = 0; i < n; i++) {
+    int32_t raw;
+    if (HX711_Read(&hx, &raw) != HX711_OK) continue;
+    sum += raw;
+    got++;
+  }
+  if (got == 0) return INT32_MIN;
+  return (int32_t)(sum / got);
+}
+
+// 최소제곱 직선 y = a*x + b (x 폭이 TC_MIN_SPAN_C 보다 좁으면 false)
+static int lin_fit(const float *x, const float *y, uint8_t n, float *a, float *b) {
+  float sx = 0, sy = 0, sxx = 0, sxy = 0, xmin = 1e9f, xmax = -1e9f;
+  for (uint8_t i = 0; i < n; i++) {
+    sx += x[i]; sy += y[i]; sxx += x[i] * x[i]; sxy += x[i] * y[i];
+    if (x[i] < xmin) xmin = x[i];
+    if (x[i] > xmax) xmax = x[i];
+  }
+  if (n < 2 || xmax - xmin < TC_MIN_SPAN_C) return 0;
+  float mx = sx / n, my = sy / n;
+  float vxx = sxx / n - mx * mx;
+  *a = (sxy / n - mx * my) / vxx;
+  *b = my - *a * mx;
+  return 1;
+}
+
+// 온도계수 학습 (온도를 바꿔가며 여러 번)
+//   CAL TC 0       : 빈 상태 영점 raw 기록
+//   CAL TC <g>     : 기준 무게 <g> 올리고 감도(raw/g) 기록 (같은 온도에서 CAL TC 0 먼저)
+//   CAL TC FIT     : 영점/감도 온도계수 계산 후 저장
+//   CAL TC CLEAR   : 온도계수 끄기
+static void cmd_tc(const char *arg) {
+  Calib_Cell_t *cell = &calib.cell[0];
+  float t = TempSense_Get();
+  float g;
+
+  if (strcmp(arg, "FIT") == 0) {
+    float a, b;
+    int ok = 0;
+    if (lin_fit(tc_zero_t, tc_zero_raw, tc_zero_n, &a, &b)) {
+      // 기준 온도 영점은 그대로 두고 기울기만
+      cell->tc_offset = a;
+      ok = 1;
+    }
+    if (lin_fit(tc_span_t, tc_span_val, tc_span_n, &a, &b)) {
+      float s_ref = a * cell->ref_temp + b;
+      if (s_ref > 0.0f) {
+        cell->tc_scale = a / s_ref;
+        ok = 1;
+      }
+    }
+    if (!ok) {
+      printf("cal: tc fit failed (zero=%u span=%u)\r\n", tc_zero_n, tc_span_n);
+      return;
+    }
+    temp_comp_update();
+    calib_dirty = 1;
+    printf("cal: tc_offset= %.1f raw/C tc_scale= %.6f /C ref= %.2f C\r\n",
+           cell->tc_offset, cell->tc_scale, cell->ref_temp);
+  } else if (strcmp(arg, "CLEAR") == 0) {
+    cell->tc_offset = 0.0f;
+    cell->tc_scale = 0.0f;
+    tc_zero_n = tc_span_n = 0;
+    tc_have_zero = 0;
+    temp_comp_update();
+    calib_dirty = 1;
+    printf("cal: tc cleared\r\n");
+  } else if (sscanf(arg, "%f", &g) == 1) {
+    int32_t raw = cal_read_raw(CAL_AVG_N);
+    if (raw == INT32_MIN) {
+      printf("cal: bad reading\r\n");
+      return;
+    }
+    if (g == 0.0f) {
+      if (tc_zero_n >= TC_MAX_POINTS) { printf("cal: tc full\r\n"); return; }
+      tc_zero_t[tc_zero_n] = t;
+      tc_zero_raw[tc_zero_n] = (float)raw;
+      tc_zero_n++;
+      tc_last_zero = raw;
+      tc_have_zero = 1;
+      printf("cal: tc zero #%u %.2f C raw= %ld\r\n", tc_zero_n, t, (long)raw);
+    } else {
+      if (!tc_have_zero || g < 0.0f || tc_span_n >= TC_MAX_POINTS || raw <= tc_last_zero) {
+        printf("cal: tc span rejected\r\n");
+        return;
+      }
+      tc_span_t[tc_span_n] = t;
+      tc_span_val[tc_span_n] = (float)(raw - tc_last_zero) / g;
+      tc_span_n++;
+      printf("cal: tc span #%u %.2f C %.2f raw/g\r\n", tc_span_n, t, tc_span_val[tc_span_n - 1]);
+    }
+  } else {
+    printf("unknown cmd: CAL TC %s\r\n", arg);
+  }
 }
 
-static int is_saturated(int32_t raw) {
-  return (raw == 8388607 || raw == -8388608); // HX711 포화값
+// 보정 명령
+//   CAL START      : 빈 상태에서 영점 잡고 기준점 비움
+//   CAL ADD <g>    : 올려둔 기준 무게 <g> 의 raw 기록
+//   CAL FIT        : 모은 기준점으로 보정표 + scale 계산 후 저장
+//   CAL CLEAR      : 보정표 끄기 (scale 만 사용)
+//   CAL SHOW       : 기준점/보정표 출력
+static void cmd_handle(const char *line) {
+  Calib_Cell_t *cell = &calib.cell[0];
+  float g;
+
+  if (strncmp(line, "CAL TC ", 7) == 0) {
+    cmd_tc(line + 7);
+  } else if (strcmp(line, "CAL START") == 0) {
+    // 지금 온도를 기준 온도로 (온도계수는 그대로)
+    cell->ref_temp = TempSense_Get();
+    temp_comp_update();
+    hx.offset = HX711_Tare(&hx, 50) - temp_off;
+    azt_total = 0;
+    cal_n = 0;
+    Kalman_Reset(&kf);
+    Segment_Rebase(0.0f);
+    printf("cal: zero= %ld\r\n", (long)hx.offset);
+  } else if (sscanf(line, "CAL ADD %f", &g) == 1) {
+    if (g <= 0.0f || cal_n >= CALIB_MAX_POINTS) {
+      printf("cal: add rejected (n=%u)\r\n", cal_n);
+      return;
+    }
+    int32_t raw = cal_read_raw(CAL_AVG_N);
+    int32_t net = (raw == INT32_MIN) ? 0 : net_from_raw(raw);
+    if (net <= 0) {
+      printf("cal: bad reading\r\n");
+      return;
+    }
+    cal_pts[cal_n].raw = net;
+    cal_pts[cal_n].grams = g;
+    cal_n++;
+    printf("cal: #%u %.2f g raw= %ld\r\n", cal_n, g, (long)net);
+  } else if (strcmp(line, "CAL FIT") == 0) {
+    float scale = Calib_FitScale(cal_pts, cal_n);
+    if (scale <= 0.0f || !Calib_FitLut(cal_pts, cal_n, &cell->lut)) {
+      printf("cal: fit failed (n=%u)\r\n", cal_n);
+      return;
+    }
+    hx.scale = scale;
+    HXGuard_SetMinDev((int32_t)(SPIKE_MIN_G * hx.scale));
+    calib_dirty = 1;
+    printf("cal: fit %u points, scale= %.2f shift= %u\r\n", cal_n, scale, cell->lut.shift);
+  } else if (strcmp(line, "CAL CLEAR") == 0) {
+    cell->lut.valid = 0;
+    cal_n = 0;
+    calib_dirty = 1;
+    printf("cal: table cleared\r\n");
+  } else if (strcmp(line, "CAL SHOW") == 0) {
+    printf("cal: offset= %ld scale= %.2f table= %u\r\n",
+           (long)hx.offset, hx.scale, cell->lut.valid);
+    printf("  temp= %.2f C ref= %.2f C tc_offset= %.1f tc_scale= %.6f\r\n",
+           TempSense_Get(), cell->ref_temp, cell->tc_offset, cell->tc_scale);
+    for (uint8_t i = 0; i < cal_n; i++)
+      printf("  pt%u %.2f g raw= %ld\r\n", i, cal_pts[i].grams, (long)cal_pts[i].raw);
+    if (cell->lut.valid) {
+      for (int j = 0; j < CALIB_LUT_NODES; j++)
+        printf("  node%d raw= %ld -> %ld mg\r\n", j,
+               (long)((j << cell->lut.shift) - cell->lut.bias), (long)cell->lut.mg[j]);
+    }
+  } else {
+    printf("unknown cmd: %s\r\n", line);
+  }
 }
 
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+// 올림/내림 이벤트 하나 = 레코드 하나 (이벤트마다 새 uuid, 정정은 같은 uuid + "a":1)
+//   {"m":"ev","uuid":"...","ev":"add","dw":150.20,"weight":300.40}
+// 정정해 보니 이벤트가 아니었으면 같은 uuid 로 취소: "dw":0.00 + "a":1 + "x":1 (weight 는 지금 무게)
+// 레코드마다 맨 앞 "m" 에 메시지 종류 (ev / h / fill) → 수집기가 키를 뒤지지 않고 바로 핸들러 선택
+static void report_event(const Segment_Event_t *ev)
+{
+	char rec[TELEMETRY_REC_MAX];
+
+	if (!ev->amend) {
+		Uuid_New(&current_event_id);
+		Uuid_ToString(&current_event_id, current_event_uuid);
+		event_load_tick = load_tick ? load_tick : HAL_GetTick();
+	}
+
+	snprintf(rec, sizeof(rec), "{\"m\":\"ev\",\"uuid\":\"%s\",\"ev\":\"%s\",\"dw\":%.2f,\"weight\":%.2f%s,\"tr\":%u,\"t0\":%lu}",
+	         current_event_uuid, (ev->type == SEG_ADD) ? "add" : "remove",
+	         ev->retract ? 0.0f : ev->delta, ev->total,
+	         ev->retract ? ",\"a\":1,\"x\":1" : (ev->amend ? ",\"a\":1" : ""), ++trace_seq, (unsigned long)event_load_tick);
+	Telemetry_Push(TELEMETRY_EVENT, rec);
+}
+
+// 새 안정 무게 → 이벤트면 보고
+static void segment_stable(float weight, int amend)
+{
+	Segment_Event_t ev;
+	if (amend ? Segment_Amend(weight, &ev) : Segment_Stable(weight, &ev))
+		report_event(&ev);
+	// 보고 여부와 상관없이 다음 변화부터 다시 잼
+	if (!amend) load_tick = 0;
+}
 
 /* USER CODE END 0 */
 
@@ -143,7 +425,9 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
+  MX_ADC1_Init();
   /* USER CODE BEGIN 2 */
   /* HX711 모듈 초기화 (DOUT = PB3, SCK = PB10, gain=128) */
     HX711_Init(&hx,
@@ -154,92 +438,249 @@ int main(void)
     // 안정화  시간
       HAL_Delay(500);
 
-    // 빈 상태에서 영점 잡기
-    hx.offset = HX711_Tare(&hx, 20);
-
-    // scale: 영점 조절 (아이폰 141g 기준)
-    hx.scale = 11110.0f;
-    HX711_Tare(&hx, 50);
-
-
-    avg_reset();
+    // 내부 온도 센서 (첫 측정까지 기다림)
+    TempSense_Init(&hadc1);
+
+    if (Calib_Load(&calib) && calib.n_cells > 0 && calib.cell[0].scale != 0.0f) {
+        // 저장된 보정값 바로 복원, 영점은 몇 샘플로 드리프트만 확인
+        hx.scale = calib.cell[0].scale;
+        temp_comp_update();
+        int32_t zero = HX711_Tare(&hx, DRIFT_CHECK_N) - temp_off;   // 기준 온도 영점으로
+        hx.offset = zero;
+        float drift_g = (float)(zero - calib.cell[0].offset) / hx.scale;
+
+        if (fabsf(drift_g) > DRIFT_MAX_G) {
+            // 부팅할 때 통에 뭔가 있음 → 저장된 영점 유지
+            hx.offset = calib.cell[0].offset;
+        } else if (fabsf(drift_g) > DRIFT_SAVE_G) {
+            calib_dirty = 1;
+        }
+        printf("calib #%lu restored, drift= %.2f g\r\n", Calib_GetSeq(), drift_g);
+    } else {
+        // 보정값 없음: 빈 상태에서 영점 잡기
+        hx.offset = HX711_Tare(&hx, 20);
+
+        // scale: 영점 조절 (아이폰 141g 기준)
+        hx.scale = DEFAULT_SCALE;
+        HX711_Tare(&hx, 50);
+
+        memset(&calib, 0, sizeof(calib));
+        calib.n_cells = 1;
+        calib.cell[0].scale = hx.scale;
+        calib.cell[0].ref_temp = TempSense_Get();
+        calib_dirty = 1;
+    }
+
+
+    Kalman_Init(&kf, STATIC_PERIOD_MS, KF_NOISE_MG, KF_Q_MIN, KF_Q_MAX);
+    HXGuard_Init((int32_t)(SPIKE_MIN_G * hx.scale));
     seq = 0;
 
     printf("scale= %.2f\r\n", hx.scale);
     printf("offset= %ld\r\n", (long)hx.offset);
 
     // UUID
-    uuid_counter = 0;
+    Uuid_Init();
     memset(current_event_uuid, 0, sizeof(current_event_uuid));
+    Segment_Init(OBJECT_ON_THRESH, OBJECT_OFF_THRESH);
+
+    // 텔레메트리 배치 (기본 출력: UART)
+    Telemetry_Init(NULL);
+
+    // UART 명령 수신 시작
+    HAL_UART_Receive_IT(&huart2, &uart_rx_byte, 1);
 
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
-    float prev = 0.0f;
     int stable_cnt = 0;
+    uint32_t health_tick = HAL_GetTick();
+    uint32_t fill_tick = HAL_GetTick();
+    uint32_t static_tick = HAL_GetTick();
+    float w_sum = 0.0f;
+    int   w_cnt = 0;
+    char rec[TELEMETRY_REC_MAX];
   while (1)
   {
     /* USER CODE END WHILE */
-	  int32_t raw = HX711_ReadRaw(&hx);
+	  // 기한 지난 배치 전송
+	  Telemetry_Poll();
+
+	  // 영점이 바뀌었으면 플래시에 저장 (인터럽트 밖에서)
+	  if (calib_dirty) {
+		  calib_dirty = 0;
+		  calib.cell[0].offset = hx.offset;
+		  calib.cell[0].scale = hx.scale;
+		  if (!Calib_Save(&calib))
+			  printf("calib save failed\r\n");
+	  }
+
+	  // UART 명령 처리 (보정 등)
+	  if (cmd_ready) {
+		  cmd_handle(cmd_line);
+		  cmd_ready = 0;
+	  }
 
-	  //  포화/이상치 버리기
-	  if (is_saturated(raw)) {
-	  // 포화는 그냥 무시
-		  HAL_Delay(50);
+	  int32_t raw = 0;
+	  HX711_Status_t hs = HX711_Read(&hx, &raw);
+	  uint32_t sample_tick = HAL_GetTick();
+	  Uuid_AddEntropy((uint32_t)raw);     // 아래쪽 비트는 잡음
+
+	  // 온도 묶음이 끝났으면 보정값 갱신 + 다음 묶음 시작 (ADC 는 다음 HX711 샘플 동안 돎)
+	  if (TempSense_Poll())
+		  temp_comp_update();
+
+	  //  타임아웃/포화/고착/스파이크 버리기 (필터와 업링크로 안 감)
+	  //  동적 계량 중 출렁임은 스파이크가 아니므로 그대로 통과
+	  HXGuard_SetSpikeBypass(DynWeigh_GetState() == DYN_RUNNING);
+	  HXGuard_Result_t gr = HXGuard_Check(hs, raw);
+	  if (gr != HXG_ACCEPT) {
+		  if (gr == HXG_REJECT_SAT) HAL_Delay(50);
 		  continue;
 	  }
 
-	  // 무게 계산
-	  int32_t net = raw - hx.offset;
-	  float w = (hx.scale == 0.0f) ? 0.0f : (float)net / hx.scale;
+	  // 재Tare: 요청 후 TARE_N 샘플 평균을 새 영점으로 (그동안 무게 계산은 쉼)
+	  if (tare_req) {
+		  tare_req = 0;
+		  tare_left = TARE_N;
+		  tare_sum = 0;
+	  }
+	  if (tare_left > 0) {
+		  tare_sum += raw;
+		  if (--tare_left == 0) {
+			  hx.offset = (int32_t)(tare_sum / TARE_N) - temp_off;
+			  azt_total = 0;
+			  tare_count++;
+			  calib_dirty = 1;
+			  Kalman_Reset(&kf);      // ★ 필터 비우기
+			  Segment_Rebase(0.0f);   // 올려둔 것까지 영점 → 이벤트 기준도 0
+			  is_stable = 0;
+			  stable_weight = 0.0f;
+			  stable_cnt = 0;
+			  seq = 0;
+			  load_tick = 0;
+			  printf("\r\n--- RE-TARE --- tick=%lu, offset=%ld\r\n",
+			         HAL_GetTick(), (long)hx.offset);
+		  }
+		  continue;
+	  }
 
-	  // 이동평균 (부팅/재Tare 이후엔 버퍼가 비워져 있어서 이전 샘플 영향 X)
-	  float w_filt = avg_push(w);
+	  // 무게 계산
+	  int32_t net = net_from_raw(raw);
+	  float w;
+	  if (calib.cell[0].lut.valid)
+		  w = (float)Calib_LutEval(&calib.cell[0].lut, net) * 0.001f;   // 다점 보정표 (mg)
+	  else
+		  w = (hx.scale == 0.0f) ? 0.0f : (float)net / hx.scale;
+
+	  // ======= 동적 계량 (센서 원래 속도로) =======
+	  if (dyn_armed && fabsf(w - stable_weight) > OBJECT_ON_THRESH) {
+		  // 물체 올림/내림 → 출렁이는 동안 정착값 추정
+		  dyn_armed = 0;
+		  if (!load_tick) load_tick = sample_tick;
+		  DynWeigh_Start();
+	  }
+	  if (DynWeigh_GetState() == DYN_RUNNING && DynWeigh_Push(w) == DYN_CONVERGED) {
+		  is_stable = 1;
+		  stable_weight = DynWeigh_Get();
+		  stable_cnt = 0;             // 정적 판정은 새 무게로 다시 세게
+		  dyn_hold = 1;
+		  dyn_hold_tick = HAL_GetTick();
+		  segment_stable(stable_weight, 0);
+	  }
 
-	  // 안정구간 판정 (변화량 기준)
-	  if (fabsf(w_filt - prev) < STABLE_THRESHOLD)
+	  // 정적 판정은 STATIC_PERIOD_MS 마다, 그 사이 샘플은 평균
+	  w_sum += w;
+	  w_cnt++;
+	  if (HAL_GetTick() - static_tick < STATIC_PERIOD_MS) continue;
+	  static_tick = HAL_GetTick();
+	  w = w_sum / (float)w_cnt;
+	  w_sum = 0.0f;
+	  w_cnt = 0;
+
+	  // 칼만 필터 (부팅/재Tare 이후엔 비워져 있어서 이전 샘플 영향 X)
+	  float w_filt = (float)Kalman_Update(&kf, (int32_t)lrintf(w * 1000.0f)) * 0.001f;
+	  float w_rate = (float)kf.v * 0.001f;
+	  float w_sd = sqrtf((float)Kalman_Var(&kf)) * 0.001f;
+
+	  // 안정구간 판정: 하중 변화 감지 없음 + 변화율/불확실성 작음
+	  if (!Kalman_Changed(&kf) && fabsf(w_rate) < KF_STABLE_RATE_G && w_sd < KF_STABLE_SD_G)
 		  stable_cnt++;
 	  else
 		  stable_cnt = 0;
-	  prev = w_filt;
+
+	  // 자동 영점 추적: 안정된 빈 상태에서만, 샘플당 AZT_STEP_G 이하로
+	  if (stable_cnt >= STABLE_COUNT && fabsf(w_filt) < AZT_BAND_G && hx.scale != 0.0f) {
+		  float dg = w_filt;
+		  if (dg > AZT_STEP_G) dg = AZT_STEP_G;
+		  if (dg < -AZT_STEP_G) dg = -AZT_STEP_G;
+		  int32_t step = (int32_t)lrintf(dg * hx.scale);
+
+		  if (step != 0 && fabsf((float)(azt_total + step) / hx.scale) <= AZT_LIMIT_G) {
+			  hx.offset += step;
+			  azt_total += step;
+			  Kalman_Shift(&kf, -(int32_t)lrintf(dg * 1000.0f));
+			  w_filt -= dg;
+
+			  if (fabsf((float)(hx.offset - calib.cell[0].offset) / hx.scale) > AZT_SAVE_G)
+				  calib_dirty = 1;
+		  }
+	  }
 
 
 	  // 항상 필터 값 로그 (디버깅용)
 	//printf("#%lu w=%.2f g (filt)\r\n", ++seq, w_filt);
 
+	  // ======= 동적 추정 확인 =======
+	  // 정적 판정이 안정되면(또는 시간 초과) 비교해서 많이 다르면 정적 값으로 정정
+	if (dyn_hold && (stable_cnt >= STABLE_COUNT || HAL_GetTick() - dyn_hold_tick >= DYN_HOLD_MS)) {
+		dyn_hold = 0;
+		dyn_armed = 1;
+		if (stable_cnt >= STABLE_COUNT && fabsf(w_filt - stable_weight) > STABLE_THRESHOLD) {
+			stable_weight = w_filt;
+			segment_stable(stable_weight, 1);
+		}
+	}
+
 	  // ======= STABLE ON =======
 	if (!is_stable && stable_cnt >= STABLE_COUNT) {
 		  is_stable = 1;
 		  stable_weight = w_filt;
 
-		// 음수면 무시
-		if (stable_weight <= 0.0f) {
-			// 그냥 다음 루프
-		} else {
-			if (!first_stable_sent) {
-				char uuid[40];
-				generate_uuid(uuid);
-				printf("{\"uuid\":\"%s\",\"weight\":%.2f}\r\n", uuid, stable_weight);
-				first_stable_sent = 1;
-			} else {
-				printf("{\"weight\":%.2f}\r\n", stable_weight);
-			}
-		}
+		// 직전 안정 무게와 비교해서 이벤트 (작은 변화는 기준만 갱신)
+		segment_stable(stable_weight, 0);
+		DynWeigh_Stop();
+		dyn_armed = 1;
     /* USER CODE BEGIN 3 */
 	}
 
-	// ======= STABLE OFF =======
-	if (is_stable && fabsf(w_filt - stable_weight) > STABLE_THRESHOLD) {
+	// ======= STABLE OFF ======= (동적 추정 확인 중에는 필터가 아직 따라오는 중이라 안 봄)
+	// 중간 값은 안 보냄, 다음 안정 무게에서 이벤트 하나로
+	if (is_stable && !dyn_hold && fabsf(w_filt - stable_weight) > STABLE_THRESHOLD) {
 		is_stable = 0;
+		if (!load_tick) load_tick = sample_tick;
+	}
 
-		if (w_filt > 0.0f) {
-			printf("{\"weight\":%.2f}\r\n", w_filt);
-		}
+	// ======= 주기 데이터 (배치로 묶여서 나감) =======
+	if (HAL_GetTick() - fill_tick >= FILL_PERIOD_MS) {
+		fill_tick = HAL_GetTick();
+		snprintf(rec, sizeof(rec), "{\"m\":\"fill\",\"fill\":%.1f}", w_filt);
+		Telemetry_Push(TELEMETRY_FILL, rec);
+	}
+	if (HAL_GetTick() - health_tick >= HEALTH_PERIOD_MS) {
+		const HXGuard_Counters_t *hc = HXGuard_GetCounters();
+		health_tick = HAL_GetTick();
+		// to: 타임아웃, sat: 포화, sp: 스파이크, stk/ob/nc: 고착/브리지 끊김/칩 무응답 발생 횟수, f: 현재 고장 비트
+		snprintf(rec, sizeof(rec),
+		         "{\"m\":\"h\",\"h\":{\"up\":%lu,\"tare\":%lu,\"t\":%.1f,\"to\":%lu,\"sat\":%lu,\"sp\":%lu,"
+		         "\"stk\":%lu,\"ob\":%lu,\"nc\":%lu,\"f\":%u}}",
+		         HAL_GetTick() / 1000, tare_count, TempSense_Get(), hc->timeouts, hc->saturations,
+		         hc->spikes, hc->stuck, hc->open_bridge, hc->no_chip, HXGuard_GetFaults());
+		Telemetry_Push(TELEMETRY_HEALTH, rec);
 	}
 
 		  /* USER CODE END WHILE */
-	HAL_Delay(100);
   }
   /* USER CODE END 3 */
 }
@@ -291,6 +732,61 @@ void SystemClock_Config(void)
   }
 }
 
+/**
+  * @brief ADC1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_ADC1_Init(void)
+{
+
+  /* USER CODE BEGIN ADC1_Init 0 */
+
+  /* USER CODE END ADC1_Init 0 */
+
+  ADC_ChannelConfTypeDef sConfig = {0};
+
+  /* USER CODE BEGIN ADC1_Init 1 */
+
+  /* USER CODE END ADC1_Init 1 */
+
+  /** Configure the global features of the ADC (Clock, Resolution, Data alignment and number of conversion)
+  */
+  hadc1.Instance = ADC1;
+  hadc1.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
+  hadc1.Init.Resolution = ADC_RESOLUTION_12B;
+  hadc1.Init.ScanConvMode = ENABLE;
+  hadc1.Init.ContinuousConvMode = DISABLE;
+  hadc1.Init.DiscontinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
+  hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc1.Init.NbrOfConversion = 2 * TEMPSENSE_PAIRS;
+  hadc1.Init.DMAContinuousRequests = DISABLE;
+  hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
+  */
+  /* USER CODE BEGIN ADC1_Init 2 */
+  // 온도(홀수 순번) / VREFINT(짝수 순번) 번갈아, 온도 센서는 10us 이상 샘플링 필요
+  sConfig.SamplingTime = ADC_SAMPLETIME_480CYCLES;
+  for (uint32_t i = 0; i < 2 * TEMPSENSE_PAIRS; i++)
+  {
+    sConfig.Channel = (i % 2 == 0) ? ADC_CHANNEL_TEMPSENSOR : ADC_CHANNEL_VREFINT;
+    sConfig.Rank = i + 1;
+    if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+    {
+      Error_Handler();
+    }
+  }
+  /* USER CODE END ADC1_Init 2 */
+
+}
+
 /**
   * @brief USART2 Initialization Function
   * @param None
@@ -324,18 +820,56 @@ static void MX_USART2_UART_Init(void)
 
 }
 
-// B1 버튼 누를 시 버퍼 비우기 및 영점 다시 잡기
+// B1 버튼: 재Tare 요청만 (실제 영점 잡기는 메인 루프에서, 인터럽트에서 막히지 않게)
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
 	if (GPIO_Pin == B1_Pin) {
-	    HX711_Tare(&hx, 50);
-	    avg_reset();      // ★ 평균버퍼 비우기
-	    seq = 0;
-	    printf("\r\n--- RE-TARE --- tick=%lu, offset=%ld\r\n",
-	           HAL_GetTick(), (long)hx.offset);
+	    tare_req = 1;
 	  }
 }
 
+// ADC 온도 묶음 DMA 완료
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+	TempSense_OnConvCplt(hadc);
+}
+
+// UART 한 바이트 수신 → 줄 단위로 모아서 메인 루프에 넘김
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	if (huart->Instance == USART2) {
+		char c = (char)uart_rx_byte;
+		if (c == '\r' || c == '\n') {
+			// 이전 명령을 아직 처리 중이면 이번 줄은 버림
+			if (cmd_len > 0 && !cmd_ready) {
+				memcpy(cmd_line, cmd_buf, cmd_len);
+				cmd_line[cmd_len] = '\0';
+				cmd_ready = 1;
+			}
+			cmd_len = 0;
+		} else if (cmd_len < CMD_MAX - 1) {
+			cmd_buf[cmd_len++] = c;
+		}
+		HAL_UART_Receive_IT(&huart2, &uart_rx_byte, 1);
+	}
+}
+
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA2_Stream0_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -386,30 +920,16 @@ static void MX_GPIO_Init(void)
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+
   /* USER CODE BEGIN MX_GPIO_Init_2 */
 
   /* USER CODE END MX_GPIO_Init_2 */
 }
 
 /* USER CODE BEGIN 4 */
-// UUID
-void generate_uuid(char *uuid_str) {
-    uint32_t timestamp = HAL_GetTick();  // 시스템 가동 시간 (ms)
-    uint32_t counter = uuid_counter++;
-
-    uint32_t rand1 = (timestamp * 1103515245 + 12345) & 0x7FFFFFFF;
-    uint32_t rand2 = (counter * 1664525 + 1013904223) & 0x7FFFFFFF;
-
-    // xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
-    snprintf(uuid_str, 37, "%08lx-%04x-%04lx-%04lx-%08lx%04x",
-        timestamp,                    // 8자리: 타임스탬프
-        (uint16_t)(counter & 0xFFFF), // 4자리: 카운터
-        (rand1 >> 16) & 0xFFFF,       // 4자리: 랜덤1
-        rand2 & 0xFFFF,               // 4자리: 랜덤2
-        rand1,                        // 8자리: 랜덤1 전체
-        (uint16_t)(rand2 >> 16)       // 4자리: 랜덤2
-    );
-}
 /* USER CODE END 4 */
 
 /**
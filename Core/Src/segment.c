@@ -0,0 +1,80 @@
+#include "segment.h"
+#include <math.h>
+
+static float min_delta_g = 40.0f;
+static float empty_band_g = 15.0f;
+
+static float baseline = 0.0f;       // 직전 안정 무게
+static float before_last = 0.0f;    // 마지막 이벤트 직전 기준 (정정용)
+static uint32_t seq = 0;
+static bool last_is_event = false;  // 기준이 마지막으로 이벤트로 바뀌었는지
+
+static float Segment_Snap(float w)
+{
+    return (fabsf(w) < empty_band_g) ? 0.0f : w;
+}
+
+void Segment_Init(float min_delta, float empty_band)
+{
+    min_delta_g = min_delta;
+    empty_band_g = empty_band;
+    baseline = before_last = 0.0f;
+    seq = 0;
+    last_is_event = false;
+}
+
+static void Segment_Fill(Segment_Event_t *ev, float from, float to, bool amend)
+{
+    ev->delta = to - from;
+    ev->type = (ev->delta >= 0.0f) ? SEG_ADD : SEG_REMOVE;
+    ev->seq = seq;
+    ev->total = to;
+    ev->amend = amend;
+    ev->retract = false;
+}
+
+bool Segment_Stable(float weight, Segment_Event_t *ev)
+{
+    float w = Segment_Snap(weight);
+
+    if (fabsf(w - baseline) < min_delta_g) {
+        baseline = w;
+        last_is_event = false;
+        return false;
+    }
+
+    seq++;
+    Segment_Fill(ev, baseline, w, false);
+    before_last = baseline;
+    baseline = w;
+    last_is_event = true;
+    return true;
+}
+
+bool Segment_Amend(float weight, Segment_Event_t *ev)
+{
+    if (!last_is_event) return Segment_Stable(weight, ev);
+
+    float w = Segment_Snap(weight);
+
+    // 정정하고 보니 변화가 min_delta 안이면 이벤트가 아니었던 것 → 취소로 보고
+    // (남은 변화는 Segment_Stable 처럼 기준에 흡수, 더 정정할 이벤트 없음)
+    baseline = w;
+    Segment_Fill(ev, before_last, w, true);
+    if (fabsf(ev->delta) < min_delta_g) {
+        ev->retract = true;
+        last_is_event = false;
+    }
+    return true;
+}
+
+void Segment_Rebase(float weight)
+{
+    baseline = Segment_Snap(weight);
+    last_is_event = false;
+}
+
+float Segment_GetBaseline(void)
+{
+    return baseline;
+}
@@ -0,0 +1,169 @@
+#include "telemetry.h"
+#include "main.h"
+#include <stdio.h>
+#include <string.h>
+
+// 종류별 기본 기한 (ms)
+static uint32_t deadline_ms[TELEMETRY_CLASS_COUNT] = {
+    0,        // EVENT
+    60000,    // HEALTH
+    30000,    // FILL
+};
+
+static Telemetry_Sink_t sink_fn = NULL;
+
+// 이벤트는 순서대로 쌓고, 헬스/채움량은 최신값 하나만 유지
+static char     ev_buf[TELEMETRY_MAX_PACKET];
+static uint16_t ev_len = 0;
+static uint8_t  ev_count = 0;
+
+static char     latest[TELEMETRY_CLASS_COUNT][TELEMETRY_REC_MAX];
+static uint16_t latest_len[TELEMETRY_CLASS_COUNT];
+
+static uint8_t  pending = 0;
+static uint32_t flush_at = 0;
+
+static char     pkt[TELEMETRY_MAX_PACKET + 1];
+
+static void Telemetry_UartSink(const char *packet, uint16_t len)
+{
+    printf("%.*s\r\n", (int)len, packet);
+}
+
+void Telemetry_Init(Telemetry_Sink_t sink)
+{
+    sink_fn = (sink != NULL) ? sink : Telemetry_UartSink;
+    ev_len = 0;
+    ev_count = 0;
+    memset(latest_len, 0, sizeof(latest_len));
+    pending = 0;
+}
+
+void Telemetry_SetDeadline(Telemetry_Class_t cls, uint32_t ms)
+{
+    if (cls < TELEMETRY_CLASS_COUNT) deadline_ms[cls] = ms;
+}
+
+// 지금 패킷을 만들면 몇 바이트인지 (배치 래퍼 포함)
+static uint16_t Telemetry_Size(uint8_t *count)
+{
+    uint16_t size = ev_len;
+    uint8_t  n = ev_count;
+    for (int c = TELEMETRY_HEALTH; c < TELEMETRY_CLASS_COUNT; c++) {
+        if (latest_len[c]) {
+            size += latest_len[c];
+            n++;
+        }
+    }
+    // 이벤트 사이 쉼표는 ev_len 에 이미 포함. 나머지 쉼표 + {"b":[ ]}
+    if (n > 1) size += (n - 1 - (ev_count ? ev_count - 1 : 0)) + 8;
+    *count = n;
+    return size;
+}
+
+void Telemetry_Flush(void)
+{
+    uint8_t n;
+    Telemetry_Size(&n);
+    if (n == 0) {
+        pending = 0;
+        return;
+    }
+
+    uint16_t len = 0;
+    if (n > 1) {
+        memcpy(pkt, "{\"b\":[", 6);
+        len = 6;
+    }
+
+    // 이벤트는 이미 쉼표로 이어 붙여져 있음
+    memcpy(&pkt[len], ev_buf, ev_len);
+    len += ev_len;
+    uint8_t first = (ev_count == 0);
+
+    for (int c = TELEMETRY_HEALTH; c < TELEMETRY_CLASS_COUNT; c++) {
+        if (!latest_len[c]) continue;
+        if (!first) pkt[len++] = ',';
+        memcpy(&pkt[len], latest[c], latest_len[c]);
+        len += latest_len[c];
+        first = 0;
+    }
+
+    if (n > 1) {
+        pkt[len++] = ']';
+        pkt[len++] = '}';
+    }
+
+    // 내보내는 시각 "te" 를 바깥 객체 끝 '}' 자리에 (배치 대기 시간 = te - ts)
+    // 따로 만들어서 들어갈 때만 붙임 → 자리가 모자라도 '}' 를 덮어쓰지 않고 "te" 없이 그대로 나감
+    char te[TELEMETRY_STAMP_LEN + 2];
+    int s = snprintf(te, sizeof(te), ",\"te\":%lu}", (unsigned long)HAL_GetTick());
+    if (s > 0 && s < (int)sizeof(te) && len - 1 + s <= TELEMETRY_MAX_PACKET) {
+        memcpy(&pkt[len - 1], te, (size_t)s);
+        len = (uint16_t)(len - 1 + s);
+    }
+    pkt[len] = '\0';
+
+    sink_fn(pkt, len);
+
+    ev_len = 0;
+    ev_count = 0;
+    memset(latest_len, 0, sizeof(latest_len));
+    pending = 0;
+}
+
+// 레코드 끝 '}' 앞에 넣은 시각 "ts"(ms 틱) 를 붙임 → 수집기가 MCU→시리얼 지연을 잼
+// (배치 대기 시간도 포함됨. 붙일 자리가 없으면 원래 레코드 그대로)
+static const char *Telemetry_Stamp(const char *rec, char *out, uint16_t *rlen)
+{
+    if (*rlen < 2 || rec[*rlen - 1] != '}') return rec;
+    int n = snprintf(out, TELEMETRY_REC_MAX, "%.*s,\"ts\":%lu}",
+                     (int)(*rlen - 1), rec, (unsigned long)HAL_GetTick());
+    if (n <= 0 || n >= TELEMETRY_REC_MAX) return rec;
+    *rlen = (uint16_t)n;
+    return out;
+}
+
+void Telemetry_Push(Telemetry_Class_t cls, const char *rec)
+{
+    if (cls >= TELEMETRY_CLASS_COUNT || sink_fn == NULL) return;
+
+    char stamped[TELEMETRY_REC_MAX];
+    uint16_t rlen = (uint16_t)strnlen(rec, TELEMETRY_REC_MAX - 1);
+    rec = Telemetry_Stamp(rec, stamped, &rlen);
+    uint8_t n;
+    uint16_t size = Telemetry_Size(&n);
+
+    // 넣으면 최대 길이를 넘는 경우 먼저 비움
+    int32_t add = rlen + 1;
+    if (cls != TELEMETRY_EVENT && latest_len[cls]) add -= latest_len[cls] + 1;
+    if (n > 0 && (int32_t)size + add + 8 + TELEMETRY_STAMP_LEN > TELEMETRY_MAX_PACKET) {
+        Telemetry_Flush();
+    }
+
+    if (cls == TELEMETRY_EVENT) {
+        if (ev_count) ev_buf[ev_len++] = ',';
+        memcpy(&ev_buf[ev_len], rec, rlen);
+        ev_len += rlen;
+        ev_count++;
+    } else {
+        memcpy(latest[cls], rec, rlen);
+        latest_len[cls] = rlen;
+    }
+
+    // 기한은 가장 급한 레코드 기준
+    uint32_t due = HAL_GetTick() + deadline_ms[cls];
+    if (!pending || (int32_t)(due - flush_at) < 0) flush_at = due;
+    pending = 1;
+
+    if (deadline_ms[cls] == 0 || Telemetry_Size(&n) >= TELEMETRY_FLUSH_BYTES) {
+        Telemetry_Flush();
+    }
+}
+
+void Telemetry_Poll(void)
+{
+    if (pending && (int32_t)(HAL_GetTick() - flush_at) >= 0) {
+        Telemetry_Flush();
+    }
+}
@@ -0,0 +1,84 @@
+#include "main.h"
+#include "tempsense.h"
+
+// 공장 보정값 (VDDA = 3.3V 에서 측정, 시스템 메모리)
+#define TS_CAL1         ( *(const uint16_t *)0x1FFF7A2Cu )   // 30 °C
+#define TS_CAL2         ( *(const uint16_t *)0x1FFF7A2Eu )   // 110 °C
+#define VREFINT_CAL     ( *(const uint16_t *)0x1FFF7A2Au )
+#define TS_CAL1_CDEG    3000
+#define TS_CAL2_CDEG    11000
+
+static ADC_HandleTypeDef *hadc_ts = NULL;
+
+// [2k] = 온도, [2k+1] = VREFINT
+static uint16_t buf[2 * TEMPSENSE_PAIRS];
+static volatile bool done = false;
+
+static int32_t temp_cdeg = 2500;
+static bool    have_temp = false;
+
+static void TempSense_Start(void)
+{
+    done = false;
+    HAL_ADC_Start_DMA(hadc_ts, (uint32_t *)buf, 2 * TEMPSENSE_PAIRS);
+}
+
+// 묶음 평균 → 0.01 °C
+static int32_t TempSense_Convert(void)
+{
+    uint32_t ts = 0, vref = 0;
+    for (int i = 0; i < TEMPSENSE_PAIRS; i++) {
+        ts   += buf[2 * i];
+        vref += buf[2 * i + 1];
+    }
+    if (vref == 0) return temp_cdeg;
+
+    // VDDA 가 3.3V 가 아니어도 보정값과 같은 기준으로: ts * VREFINT_CAL / vref
+    int32_t ts_cal = (int32_t)(((uint64_t)ts * VREFINT_CAL) / vref);
+    int32_t span = (int32_t)TS_CAL2 - (int32_t)TS_CAL1;
+    if (span <= 0) return temp_cdeg;
+
+    return TS_CAL1_CDEG + (ts_cal - (int32_t)TS_CAL1) * (TS_CAL2_CDEG - TS_CAL1_CDEG) / span;
+}
+
+void TempSense_Init(ADC_HandleTypeDef *hadc)
+{
+    hadc_ts = hadc;
+    have_temp = false;
+    TempSense_Start();
+
+    uint32_t t0 = HAL_GetTick();
+    while (!TempSense_Poll() && HAL_GetTick() - t0 < 10) {
+    }
+}
+
+bool TempSense_Poll(void)
+{
+    if (hadc_ts == NULL || !done) return false;
+
+    int32_t t = TempSense_Convert();
+    if (!have_temp) {
+        temp_cdeg = t;
+        have_temp = true;
+    } else {
+        temp_cdeg += (t - temp_cdeg) >> TEMPSENSE_IIR_SHIFT;
+    }
+
+    TempSense_Start();
+    return true;
+}
+
+int32_t TempSense_GetCentiDeg(void)
+{
+    return temp_cdeg;
+}
+
+float TempSense_Get(void)
+{
+    return (float)temp_cdeg * 0.01f;
+}
+
+void TempSense_OnConvCplt(ADC_HandleTypeDef *hadc)
+{
+    if (hadc == hadc_ts) done = true;
+}
@@ -0,0 +1,82 @@
+#include "main.h"
+#include "uuid.h"
+
+static uint32_t s[4];           // xoshiro128** 상태
+static uint32_t pool = 0;       // 섞어 넣을 잡음 (Uuid_New 때 상태에 반영)
+
+static inline uint32_t Uuid_Rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+// 32비트 섞기 (splitmix 계열 마무리 함수)
+static uint32_t Uuid_Mix(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint32_t Uuid_Next(void)
+{
+    uint32_t result = Uuid_Rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Uuid_Rotl(s[3], 11);
+    return result;
+}
+
+void Uuid_Init(void)
+{
+    s[0] = Uuid_Mix(HAL_GetUIDw0() ^ 0x9E3779B9u);
+    s[1] = Uuid_Mix(HAL_GetUIDw1() ^ 0x3C6EF372u);
+    s[2] = Uuid_Mix(HAL_GetUIDw2() ^ 0xDAA66D2Bu);
+    s[3] = Uuid_Mix(DWT->CYCCNT ^ HAL_GetTick() ^ 0x78DDE6E4u);
+    if ((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1;    // 상태가 전부 0 이면 안 됨
+
+    for (int i = 0; i < 8; i++) Uuid_Next();
+}
+
+void Uuid_AddEntropy(uint32_t x)
+{
+    pool = Uuid_Rotl(pool, 5) ^ x ^ DWT->CYCCNT;
+}
+
+void Uuid_New(Uuid_t *u)
+{
+    // 모인 잡음 반영 (상태 한 워드만 건드려서 주기 성질은 유지)
+    s[3] ^= Uuid_Mix(pool);
+    if ((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1;
+
+    for (int i = 0; i < UUID_BIN_LEN; i += 4) {
+        uint32_t r = Uuid_Next();
+        u->b[i]     = (uint8_t)(r >> 24);
+        u->b[i + 1] = (uint8_t)(r >> 16);
+        u->b[i + 2] = (uint8_t)(r >> 8);
+        u->b[i + 3] = (uint8_t)r;
+    }
+
+    u->b[6] = (u->b[6] & 0x0F) | 0x40;     // version 4
+    u->b[8] = (u->b[8] & 0x3F) | 0x80;     // variant 10xx
+}
+
+void Uuid_ToString(const Uuid_t *u, char out[UUID_STR_LEN])
+{
+    static const char hex[] = "0123456789abcdef";
+    char *p = out;
+
+    for (int i = 0; i < UUID_BIN_LEN; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) *p++ = '-';
+        *p++ = hex[u->b[i] >> 4];
+        *p++ = hex[u->b[i] & 0x0F];
+    }
+    *p = '\0';
+}
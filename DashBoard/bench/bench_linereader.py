@@ -0,0 +1,190 @@
+"""
+시리얼 읽기(linereader.py) 벤치: 녹화한 시리얼 캡처를 가상 포트(pty)로 실제 시간의 N 배 속도로 다시 흘려보냄
+
+    # 녹화 (실제 보드 포트 또는 simulator.py 가 연 pty)
+    python3 bench/bench_linereader.py record /dev/ttyUSB0 -o bench/captures/my.cap --seconds 60
+
+    # 재생 (기본 10 배속)
+    python3 bench/bench_linereader.py replay bench/captures/lorarx_sample.cap
+    python3 bench/bench_linereader.py replay bench/captures/lorarx_sample.cap --speed 50 --repeat 3
+
+캡처 형식: 한 줄에 read() 한 번 "<시작부터 초>\\t<base64 바이트>" (읽힌 덩어리 그대로 → 덩어리 크기도 재현)
+
+재생 결과
+  - 받은 줄 수가 캡처를 LineSplitter 로 한 번에 자른 결과와 같은지 (잃은 줄/넘친 줄)
+  - 줄 지연: 그 줄의 마지막 덩어리를 pty 에 쓴 때 → SerialReader 큐에 들어간 때
+  - 읽기 스레드 포함 프로세스 CPU 사용률
+  - 덩어리 없이 한꺼번에 자르기만 했을 때 LineSplitter 처리 속도 (MB/s)
+"""
+import argparse
+import base64
+import os
+import sys
+import threading
+import time
+import tty
+
+import serial
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from linereader import LineSplitter, SerialReader
+
+BAUD = 115200
+
+
+def load(path):
+    chunks = []
+    with open(path) as f:
+        for line in f:
+            if not line.strip() or line.startswith("#"):
+                continue
+            t, data = line.rstrip("\n").split("\t", 1)
+            chunks.append((float(t), base64.b64decode(data)))
+    return chunks
+
+
+def record(args):
+    ser = serial.Serial(args.port, BAUD, timeout=0.5)
+    t0 = None
+    n = 0
+    with open(args.out, "w") as f:
+        f.write(f"# {args.port} {BAUD} baud\n")
+        end = time.monotonic() + args.seconds
+        while time.monotonic() < end:
+            data = ser.read(max(1, ser.in_waiting))
+            if not data:
+                continue
+            now = time.monotonic()
+            if t0 is None:
+                t0 = now
+            f.write(f"{now - t0:.6f}\t{base64.b64encode(data).decode()}\n")
+            n += len(data)
+    print(f"recorded {n} bytes to {args.out}")
+
+
+def pct(values, q):
+    s = sorted(values)
+    return s[min(len(s) - 1, int(q * len(s)))] if s else float("nan")
+
+
+def replay(args):
+    chunks = load(args.capture)
+    if not chunks:
+        print("empty capture")
+        return 1
+    duration = chunks[-1][0]
+    total_bytes = sum(len(d) for _, d in chunks)
+
+    # 기준: 캡처 전체를 한 번에 자른 줄들 (덩어리 경계와 상관없이 같아야 함)
+    ref = LineSplitter()
+    expect = []
+    for _, d in chunks:
+        expect += ref.feed(d)
+    expect = expect * args.repeat
+
+    # 덩어리마다 "이 덩어리까지 쓰면 몇 번째 줄까지 완성되는지" → 줄 지연 계산용
+    done_after = []
+    sp = LineSplitter()
+    n = 0
+    for _ in range(args.repeat):
+        for _, d in chunks:
+            n += len(sp.feed(d))
+            done_after.append(n)
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    ser = serial.Serial(os.ttyname(slave), BAUD, timeout=0.5)
+    reader = SerialReader(ser, "bench", maxsize=len(expect) + 16).start()
+
+    write_t = [0.0] * len(done_after)
+
+    def writer():
+        t0 = time.monotonic()
+        i = 0
+        for r in range(args.repeat):
+            base = r * duration / args.speed
+            for t, d in chunks:
+                wait = t0 + base + t / args.speed - time.monotonic()
+                if wait > 0:
+                    time.sleep(wait)
+                os.write(master, d)
+                write_t[i] = time.monotonic()
+                i += 1
+
+    cpu0 = time.process_time()
+    w0 = time.monotonic()
+    th = threading.Thread(target=writer, daemon=True)
+    th.start()
+
+    got = []
+    deadline = None
+    while len(got) < len(expect):
+        try:
+            t, _, line = reader.queue.get(timeout=0.5)
+        except Exception:
+            if not th.is_alive():
+                if deadline is None:
+                    deadline = time.monotonic() + 2.0
+                elif time.monotonic() > deadline:
+                    break
+            continue
+        got.append((t, line))
+    wall = time.monotonic() - w0
+    cpu = time.process_time() - cpu0
+    reader.stop()
+
+    # k 번째 줄이 완성된 덩어리 → 그 덩어리를 쓴 시각
+    lat = []
+    j = 0
+    for k, (t, _) in enumerate(got):
+        while j < len(done_after) and done_after[j] <= k:
+            j += 1
+        if j < len(write_t) and write_t[j]:
+            lat.append(t - write_t[j])
+
+    lines_ok = sum(1 for (_, a), b in zip(got, expect) if a == b)
+    print(f"capture    : {args.capture}: {len(chunks)} chunks, {total_bytes} bytes, "
+          f"{len(expect) // args.repeat} lines, {duration:.1f} s")
+    print(f"replay     : x{args.speed:g} speed, {args.repeat} pass(es), {wall:.2f} s wall, "
+          f"{total_bytes * args.repeat / wall * 8 / 1000:.0f} kbit/s "
+          f"(= {total_bytes * args.repeat / wall * 10 / BAUD:.1f} x {BAUD} baud)")
+    print(f"lines      : {len(got)}/{len(expect)} received, {lines_ok} identical, "
+          f"dropped {reader.dropped}, overflow {reader.splitter.overflow}")
+    print(f"latency    : p50 {pct(lat, 0.5) * 1e3:.2f} ms, p99 {pct(lat, 0.99) * 1e3:.2f} ms, "
+          f"max {max(lat, default=0) * 1e3:.2f} ms  (chunk written -> line queued)")
+    print(f"cpu        : {cpu / wall * 100:.1f} % of one core (writer + reader + this loop)")
+
+    # 처리 속도 상한: 캡처를 64 바이트 덩어리로 쪼개 자르기만
+    blob = b"".join(d for _, d in chunks)
+    pieces = [blob[i:i + 64] for i in range(0, len(blob), 64)]
+    sp = LineSplitter()
+    rounds = max(1, int(2e6 // max(1, len(blob))))
+    t0 = time.perf_counter()
+    for _ in range(rounds):
+        for p in pieces:
+            sp.feed(p)
+    dt = time.perf_counter() - t0
+    print(f"splitter   : {len(blob) * rounds / dt / 1e6:.1f} MB/s (64-byte chunks, no I/O)")
+
+    ok = len(got) == len(expect) and lines_ok == len(expect)
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay recorded serial captures through SerialReader")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("record", help="record a serial port to a capture file")
+    p.add_argument("port")
+    p.add_argument("-o", "--out", required=True)
+    p.add_argument("--seconds", type=float, default=60.0)
+    p = sub.add_parser("replay", help="replay a capture through a pty")
+    p.add_argument("capture")
+    p.add_argument("--speed", type=float, default=10.0, help="times real time")
+    p.add_argument("--repeat", type=int, default=1)
+    args = parser.parse_args()
+    return record(args) if args.cmd == "record" else replay(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main() or 0)
@@ -0,0 +1,103 @@
+"""
+Uplink 처리량/지연 벤치 (simulator.py 의 가짜 서버 상대로, 재현 가능)
+
+    python3 bench/bench_uplink.py                         # 기본: 5000 건, 스풀 사용
+    python3 bench/bench_uplink.py --no-spool --delay 0.005
+    python3 bench/bench_uplink.py --down-at 1 --down-for 3  # 서버 장애 → 복구까지
+
+submit() 은 시리얼 스레드가 부르는 자리라 얼마나 빨리 돌아오는지도 같이 잼
+지연은 submit → 서버 응답 (스풀에서 다시 보낸 항목은 다시 큐에 넣은 때부터)
+장애 시험에서는 delivered 시간 = 장애 + 밀린 것까지 다 보낸 시간
+"""
+import argparse
+import os
+import sys
+import tempfile
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from simulator import StubBackend
+from spool import Spool
+from uplink import Uplink
+
+
+def pct(values, q):
+    if not values:
+        return float("nan")
+    s = sorted(values)
+    return s[min(len(s) - 1, int(q * len(s)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Uplink throughput/latency bench against the stub backend")
+    parser.add_argument("--count", type=int, default=5000, help="items to submit")
+    parser.add_argument("--rate", type=float, default=0, help="submit rate [items/s] (0 = as fast as possible)")
+    parser.add_argument("--workers", type=int, default=2, help="workers per lane")
+    parser.add_argument("--keys", type=int, default=0, help="distinct coalescing keys (0 = no key)")
+    parser.add_argument("--no-spool", action="store_true")
+    parser.add_argument("--port", type=int, default=18080)
+    parser.add_argument("--delay", type=float, default=0.0, help="backend mean response delay [s]")
+    parser.add_argument("--fail", type=float, default=0.0, help="backend 5xx probability")
+    parser.add_argument("--down-at", type=float, help="backend goes down this many seconds after start")
+    parser.add_argument("--down-for", type=float, default=0.0)
+    parser.add_argument("--timeout", type=float, default=120.0, help="give up waiting after this long")
+    args = parser.parse_args()
+
+    backend = StubBackend(args.port, args.delay, args.fail, args.down_at, args.down_for, seed=1)
+    threading.Thread(target=backend.run, daemon=True).start()
+    time.sleep(0.2)
+
+    tmp = tempfile.TemporaryDirectory()
+    spool = None if args.no_spool else Spool(os.path.join(tmp.name, "bench_spool.db"))
+
+    lat = []
+    lock = threading.Lock()
+
+    def observer(lane, status, latency, ctx):
+        if status is not None and status < 500:
+            with lock:
+                lat.append(latency)
+
+    uplink = Uplink(spool=spool, replay_rate=500, observer=observer)
+    uplink.add_lane("bench", workers=args.workers, maxlen=1000)
+    uplink.start()
+
+    url = f"http://127.0.0.1:{args.port}/api/bench"
+    submit_s = []
+    t0 = time.monotonic()
+    for i in range(args.count):
+        if args.rate:
+            wait = t0 + i / args.rate - time.monotonic()
+            if wait > 0:
+                time.sleep(wait)
+        key = (i % args.keys) if args.keys else None
+        ts = time.perf_counter()
+        uplink.submit("bench", "POST", url, {"i": i, "weight": 12.5}, key=key)
+        submit_s.append(time.perf_counter() - ts)
+    t_submit = time.monotonic() - t0
+
+    drained = uplink.flush(args.timeout)
+    t_total = time.monotonic() - t0
+    st = uplink.stats()["bench"]
+    uplink.close(1.0)
+
+    delivered = backend.total
+    print(f"items      : {args.count} submitted in {t_submit:.2f} s, "
+          f"spool={'off' if spool is None else 'on'}, workers={args.workers}, keys={args.keys or '-'}")
+    print(f"submit()   : p50 {pct(submit_s, 0.5) * 1e6:.0f} us, p99 {pct(submit_s, 0.99) * 1e6:.0f} us, "
+          f"max {max(submit_s) * 1e3:.1f} ms")
+    print(f"delivered  : {delivered} requests in {t_total:.2f} s = {delivered / t_total:.0f} req/s "
+          f"({'drained' if drained else 'NOT drained'})")
+    print(f"latency    : p50 {pct(lat, 0.5) * 1e3:.1f} ms, p95 {pct(lat, 0.95) * 1e3:.1f} ms, "
+          f"p99 {pct(lat, 0.99) * 1e3:.1f} ms, max {max(lat, default=0) * 1e3:.1f} ms  (submit -> response)")
+    print(f"lane stats : " + ", ".join(f"{k}={v}" for k, v in sorted(st.items())))
+    if spool is not None:
+        print(f"spool left : {spool.count()} rows")
+    tmp.cleanup()
+    return 0 if drained else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,8 +1,16 @@
 import json
+import os
 import time
 import requests
 import serial.tools.list_ports
 
+from dispatch import Dispatcher, Schema, NUMBER
+from linereader import SerialReader
+from metrics import CollectorMetrics
+from tracing import Tracer
+from spool import Spool
+from uplink import Uplink
+
 ports = serial.tools.list_ports.comports()
 
 print("=== Available COM Ports ===")
@@ -12,14 +20,20 @@ for port in ports:
     print(f"HWID: {port.hwid}")
     print("---------------------------")
 
-flag = False
 # config COM port
 while True:
     time.sleep(0.1)
     portName = input("Enter the port name (or 'test' for test mode): ")
     if portName == "test":
-        flag = True
-        break
+        # 보드 없이: 가상 포트(pty)에 센서 보드 출력(IR/레이저/컵/초음파)을 흉내 내서 넣음 (simulator.py)
+        # 서버도 없으면 다른 창에서 python simulator.py backend
+        from simulator import start_test_port
+        try:
+            ser = serial.Serial(start_test_port("sensor"), baudrate=115200, timeout=1)
+            break
+        except Exception as e:
+            print(f"[ERROR] Test mode unavailable: {e}")
+            continue
     try:
         ser = serial.Serial(
             port=portName,
@@ -44,50 +58,75 @@ BIN_ID = 2
 LIVE_UUID = "LIVE"   # 실시간 채움률용 고정 UUID 
 TIMEOUT   = 1
 
-def request_Laser(data):
-    try:
-        print("\n" + "=" * 60)
-        print("Sending data to server...")
-        print(f"URL: {BASE_URL_LASER}/insertion-event")
-        print(f"Samples: {len(data['samples'])} measurements")
-
-        response = requests.post(
-            f"{BASE_URL_LASER}/insertion-event",
-            json=data,
-            headers={"Content-Type": "application/json"},
-            timeout=5
-        )
-
-        if response.status_code == 200:
-            result = response.json()
-            print("\n[SUCCESS] Server Response!")
-            print("=" * 60)
-
-            if result.get('isSuccess'):
-                res_data = result.get('result', {})
-                print(f"Event ID: {res_data.get('uuid')}")
-                print(f"Event ID: {res_data.get('eventId')}")
-                print(f"Valid Cup: {res_data.get('isValidCup')}")
-                print(f"Pattern: {res_data.get('patternType')} - {res_data.get('patternDescription')}")
-                print(f"Diameter: {res_data.get('minDiameterMm'):.1f}mm -> {res_data.get('maxDiameterMm'):.1f}mm")
-
-                if res_data.get('rejectionReason'):
-                    print(f"[WARNING] Rejection: {res_data.get('rejectionReason')}")
-            else:
-                print(f"[ERROR] {result.get('message')}")
+# 서버 전송은 전부 백그라운드 uplink 가 담당 (시리얼 루프는 큐에 넣기만 함)
+SPOOL_PATH  = os.path.join(os.path.dirname(os.path.abspath(__file__)), "uplink_spool.db")
+REPLAY_RATE = 50     # 서버 복귀 후 밀린 항목 재전송 속도 [건/s]
+METRICS_PORT = 9108  # http://127.0.0.1:9108/metrics (0 이면 끔)
+TRACE_SLOW_S = 2.0   # 무게 변화 → 서버 응답이 이보다 오래 걸린 이벤트는 단계별 지연 출력
+
+def on_Laser_done(resp, err):
+    if err is not None:
+        if isinstance(err, requests.exceptions.ConnectionError):
+            print(f"[ERROR] Connection failed: Server not running at {BASE_URL_LASER}")
+        elif isinstance(err, requests.exceptions.Timeout):
+            print(f"[ERROR] Request timeout")
         else:
-            print(f"[ERROR] HTTP Error {response.status_code}")
-            print(f"Response: {response.text}")
-
-        print("=" * 60 + "\n")
+            print(f"[ERROR] {err}")
+        return
 
-    except requests.exceptions.ConnectionError:
-        print(f"[ERROR] Connection failed: Server not running at {BASE_URL_LASER}")
-    except requests.exceptions.Timeout:
-        print(f"[ERROR] Request timeout")
-    except Exception as e:
-        print(f"[ERROR] {e}")
+    print("\n" + "=" * 60)
+    if resp.status_code == 200:
+        result = resp.json()
+        print("[SUCCESS] Server Response!")
+        print("=" * 60)
+
+        if result.get('isSuccess'):
+            res_data = result.get('result', {})
+            print(f"Event ID: {res_data.get('uuid')}")
+            print(f"Event ID: {res_data.get('eventId')}")
+            print(f"Valid Cup: {res_data.get('isValidCup')}")
+            print(f"Pattern: {res_data.get('patternType')} - {res_data.get('patternDescription')}")
+            print(f"Diameter: {res_data.get('minDiameterMm'):.1f}mm -> {res_data.get('maxDiameterMm'):.1f}mm")
+
+            if res_data.get('rejectionReason'):
+                print(f"[WARNING] Rejection: {res_data.get('rejectionReason')}")
+        else:
+            print(f"[ERROR] {result.get('message')}")
+    else:
+        print(f"[ERROR] HTTP Error {resp.status_code}")
+        print(f"Response: {resp.text}")
+
+    print("=" * 60 + "\n")
+
+def log_status(tag):
+    # 단순 상태 코드 출력용 콜백
+    def done(resp, err):
+        if err is not None:
+            print(f"[{tag}] Error: {err}")
+        else:
+            print(f"[{tag}] {resp.request.method} -> Status: {resp.status_code}")
+    return done
+
+# 보내기 전에 디스크에 먼저 기록 → 서버가 꺼져 있어도 잃지 않고 복귀하면 다시 보냄
+spool = Spool(SPOOL_PATH)
+uplink = Uplink(spool=spool, replay_rate=REPLAY_RATE)
+uplink.add_lane("laser",  workers=2, maxlen=200, on_done=on_Laser_done)
+uplink.add_lane("cup",    workers=2, on_done=log_status("CUP"))
+uplink.add_lane("liquid", workers=1, on_done=log_status("LIQUID"))
+uplink.add_lane("sonic",  workers=1, on_done=log_status("SONIC"))
+uplink.add_lane("ir",     workers=2, on_done=log_status("IR"))
+uplink.start()
+
+# 메시지 종류 → 핸들러 (종류 필드 "m" 이 없으면 예전 키 검사로 종류 판단)
+dispatcher = Dispatcher()
+
+@dispatcher.register("laser", Schema({"samples": list}))
+def request_Laser(data):
+    print(f"[LASER] queued {len(data['samples'])} samples -> {BASE_URL_LASER}/insertion-event")
+    uplink.submit("laser", "POST", f"{BASE_URL_LASER}/insertion-event", data)
 
+@dispatcher.register("sonic", Schema({"distanceCm": NUMBER, "fillRate": NUMBER},
+                                     {"binId": int, "uuid": str}))
 def request_sonic(data):
     bin_id = data.get("binId", 1)
     dist_cm    = data.get("distanceCm")
@@ -118,35 +157,11 @@ def request_sonic(data):
     }
     """
 
-    try:
-        print("\n" + "=" * 60)
-        print("Sending data to server...")
-        print(f"URL: {BASE_URL_SONIC}")
-        print("Payload:", payload)
-
-        resp = requests.post(
-            BASE_URL_SONIC,
-            json=payload,
-            headers={"Content-Type": "application/json"},
-            timeout=5,
-        )
-
-        print(f"[HTTP] Status: {resp.status_code}")
-        try:
-            js = resp.json()
-            print("[HTTP] Response JSON:", js)
-        except Exception:
-            print("[HTTP] Response Text:", resp.text)
-
-        print("=" * 60 + "\n")
-
-    except requests.exceptions.ConnectionError:
-        print(f"[ERROR] Connection failed: Server not running at {BASE_URL_SONIC}")
-    except requests.exceptions.Timeout:
-        print("[ERROR] Request timeout")
-    except Exception as e:
-        print("[ERROR]", e)
+    # LIVE 값은 아직 못 보낸 이전 값이 있으면 최신 값으로 덮어씀
+    key = (bin_id, uuid) if uuid == LIVE_UUID else None
+    uplink.submit("sonic", "POST", BASE_URL_SONIC, payload, key=key)
 
+@dispatcher.register("cup", Schema({"weight": NUMBER}, {"uuid": str}))
 def request_Cup(data):
     UUID_TO_SEND = data.get("uuid")
 
@@ -169,16 +184,16 @@ def request_Cup(data):
         "type": Cup_type
     }
 
-    # STM32에서 받은 JSON 데이터 (data)를 그대로 payload로 사용
-    resp = requests.patch(url, json=payload, timeout=3)
-    print(f"PATCH -> Status Code: {resp.status_code}")
+    # 같은 uuid 의 무게 갱신(PATCH)은 마지막 값만 보내면 됨
+    uplink.submit("cup", "PATCH", url, payload, key=UUID_TO_SEND)
 
+@dispatcher.register("liquid", Schema({"weight": NUMBER}, {"uuid": str}))
 def request_Liquid(data):
     UUID_TO_SEND = data.get("uuid")
 
     # JSON 데이터에서 컵의 "weight"를 추출
     weight = data.get("weight")
-    if weight <= 0:
+    if weight is None or weight <= 0:
         return
     # JSON 데이터에서 컵의 "type"을 추출
     Liquid_type = data.get("type")
@@ -191,13 +206,20 @@ def request_Liquid(data):
         "type": Liquid_type
     }
 
-    # 물통 무게 업데이트
-    resp = requests.patch(url, json=payload, timeout=3)
-    print("PATCH ->", resp.status_code)
+    # 물통 무게 업데이트 (같은 물통 + uuid 는 마지막 값만)
+    uplink.submit("liquid", "PATCH", url, payload, key=(BIN_ID, UUID_TO_SEND))
 
+@dispatcher.register("ir", Schema({"beamBlocked": bool}))
 def request_IR(data):
-    resp = requests.post(BASE_URL_IR, json=data, timeout=3)
-    print("[SEND]", resp.status_code, resp.text)
+    # IR 이벤트는 하나하나가 의미 있으므로 병합하지 않음
+    uplink.submit("ir", "POST", BASE_URL_IR, data)
+
+# 로드셀 헬스/채움량/이벤트 레코드는 로그만
+@dispatcher.register("h")
+@dispatcher.register("fill")
+@dispatcher.register("ev")
+def log_telemetry(data):
+    print("Telemetry:", data)
 
 # 메인
 print("\n" + "=" * 60)
@@ -205,64 +227,43 @@ print("Data Collector Started")
 print("Waiting for data from STM32...")
 print("=" * 60 + "\n")
 
-full_buffer = ""
+# 시리얼은 읽기 스레드가 막힌 채로 기다렸다가 줄 단위로 넘겨줌 (폴링 없음)
+reader = SerialReader(ser, portName).start()
+
+# 계측: 종류별 레코드 수, 시리얼 속도, 파싱 오류, HTTP 상태, 큐 깊이, 스풀 크기, 단계별 지연
+metrics = CollectorMetrics(dispatcher, uplink, [reader], spool, reader.queue)
+# 지연 추적: 레코드의 펌웨어 틱(t0/ts/te) + 수집기 시각 + 서버 응답 → 단계별 지연 (tracing.py)
+tracer = Tracer(metrics, TRACE_SLOW_S)
+uplink.observer = tracer.on_uplink
+uplink.context = tracer.attach
+if METRICS_PORT:
+    metrics.registry.serve(METRICS_PORT)
+    print(f"[OK] Metrics at http://127.0.0.1:{METRICS_PORT}/metrics")
+
+for t_rx, line in reader.lines():
+    if not line:
+        continue
+
+    # JSON 파싱
+    if line.startswith('{') and '}' in line:
+        json_start = line.index('{')
+        json_end = line.rindex('}') + 1
+        json_str = line[json_start:json_end]
 
-while True:
-    time.sleep(0.01)
-
-    if ser.in_waiting > 0:
         try:
-            chunk = ser.read(ser.in_waiting).decode('utf-8', errors='ignore')
-            full_buffer += chunk
-
-            while '\n' in full_buffer or '\r' in full_buffer:
-                line_end = full_buffer.find('\n')
-                if line_end == -1:
-                    line_end = full_buffer.find('\r')
-
-                line = full_buffer[:line_end].strip()
-                full_buffer = full_buffer[line_end + 1:]
-
-                if not line:
-                    continue
-
-                # JSON 파싱
-                if line.startswith('{') and '}' in line:
-                    json_start = line.index('{')
-                    json_end = line.rindex('}') + 1
-                    json_str = line[json_start:json_end]
-
-                    try:
-                        data = json.loads(json_str)
-
-                        # 레이저 센서 값일 경우
-                        if 'binWidthMm' in data:
-                            request_Laser(data)
-
-                        # 로드셀(컵) 센서 값일 경우
-                        if 'type' in data and data['type'] == 'CUP':
-                            request_Cup(data)
-
-                        # 로드셀(물통) 센서 값일 경우
-                        if 'type' in data and data['type'] == 'WATER':
-                            request_Liquid(data)
-
-                        # 초음파 센서 값일 경우
-                        if 'distanceCm' in data:
-                            request_sonic(data)
-
-                        # IR 센서 값일 경우
-                        if 'beamBlocked' in data:
-                            request_IR(data)
+            data = json.loads(json_str)
 
-                    except json.JSONDecodeError as e:
-                        print(f"[ERROR] JSON Parse Error: {e}")
-                        print(f"JSON string: {json_str[:200]}...")
-                else:
-                    if line and not line.startswith('{'):
-                        print(f"[STM32] {line}")
+            # 종류별 핸들러 하나만 (배치 {"b":[...]} 는 레코드마다, 레코드마다 추적 하나)
+            for rec, _ in tracer.records(data, t_rx, portName):
+                dispatcher.dispatch(rec)
+            metrics.decoded(t_rx)
 
+        except json.JSONDecodeError as e:
+            metrics.parse_errors.inc(kind="json")
+            print(f"[ERROR] JSON Parse Error: {e}")
+            print(f"JSON string: {json_str[:200]}...")
         except Exception as e:
-            print(f"[ERROR] Read error: {e}")
-            full_buffer = ""  # 에러 시 버퍼 초기화
-            continue
\ No newline at end of file
+            metrics.parse_errors.inc(kind="processing")
+            print(f"[ERROR] Processing error: {e}")
+    else:
+        print(f"[STM32] {line}")
@@ -1,39 +1,108 @@
+import os
+import sys
 import serial
-import requests
 import json
-import time
 
-SERIAL_PORT = 'COM6'
+from dispatch import Dispatcher, Schema, NUMBER
+from linereader import SerialReader
+from metrics import CollectorMetrics
+from tracing import Tracer
+from spool import Spool
+from uplink import Uplink
+
+SERIAL_PORT = 'COM6'   # 실행 인자로 바꿀 수 있음 ("test" 면 보드 없이 simulator.py 의 로드셀 출력)
 BAUD_RATE   = 115200
 BASE_URL = 'http://localhost:8080/api/sensor/cup'
 BIN_ID = 1
-UUID_TO_SEND = None
 
-def parse_json_line(line: str):
-    """
-    주어진 문자열 라인을 JSON 객체로 파싱
-    """
-    try:
-        return json.loads(line)
-    except json.JSONDecodeError:
-        # JSON 디코딩 오류 발생 시 None 반환
-        return None
-    except Exception:
-        # 기타 예외 처리
-        return None
+# 서버 전송은 백그라운드 uplink (보내기 전에 스풀에 기록 → 서버가 꺼져 있어도 이벤트를 잃지 않음)
+# dataCollector.py 와 같이 돌 수 있으므로 스풀 파일은 따로
+SPOOL_PATH  = os.path.join(os.path.dirname(os.path.abspath(__file__)), "uplink_spool_loadcell.db")
+REPLAY_RATE = 50     # 서버 복귀 후 밀린 항목 재전송 속도 [건/s]
+METRICS_PORT = 9110  # http://127.0.0.1:9110/metrics (0 이면 끔, dataCollector.py 는 9108)
+TRACE_SLOW_S = 2.0   # 무게 변화 → 서버 응답이 이보다 오래 걸린 이벤트는 단계별 지연 출력
+
+def log_status(resp, err, method="PATCH"):
+    if err is not None:
+        print(f"{method} -> Error: {err}")
+    else:
+        print(f"{method} -> Status Code: {resp.status_code}")
+
+def log_retract(resp, err):
+    log_status(resp, err, "DELETE")
+
+spool = Spool(SPOOL_PATH)
+uplink = Uplink(spool=spool, replay_rate=REPLAY_RATE)
+uplink.add_lane("cup", workers=2, on_done=log_status)
+
+# 레코드 종류 "m" → 핸들러 (펌웨어 report_event / 주기 fill, h)
+dispatcher = Dispatcher()
+
+@dispatcher.register("ev", Schema({"uuid": str, "ev": str, "weight": NUMBER}, {"dw": NUMBER, "a": int, "x": int}))
+def request_Cup(data):
+    # 펌웨어가 올림/내림 이벤트마다 새 uuid, 정정은 같은 uuid + "a":1
+    # 정정해 보니 이벤트가 아니었으면 "x":1 (취소) → 그 uuid 의 컵 기록을 지움
+    uuid = data["uuid"]
+    print(f"Event {data['ev']}: dw={data.get('dw')} total={data['weight']}"
+          + (" (retract)" if data.get("x") else " (amend)" if data.get("a") else ""))
+
+    if data.get("x"):
+        # 같은 key 라 아직 못 보낸 PATCH 가 있으면 이 DELETE 로 바뀜
+        uplink.submit("cup", "DELETE", BASE_URL, {"uuid": uuid, "binId": BIN_ID},
+                      key=uuid, on_done=log_retract)
+        return
+
+    # JSON 데이터에서 "weight"를 추출
+    weight = data["weight"]
+
+    # weight 가 0 이하인 경우 처리 방지
+    if weight <= 0:
+        print(f"Skipping (weight <= 0): {weight}")
+        return
+
+    payload = {
+        "uuid": uuid,
+        "binId": BIN_ID,
+        "weight": weight
+    }
+
+    # 물통 무게 업데이트 (같은 uuid 는 아직 못 보냈으면 마지막 값만)
+    uplink.submit("cup", "PATCH", BASE_URL, payload, key=uuid)
+
+# 헬스/채움량 레코드는 로그만
+@dispatcher.register("h")
+@dispatcher.register("fill")
+def log_telemetry(data):
+    print("Telemetry:", data)
+
+def open_port(name):
+    if name == "test":
+        from simulator import start_test_port
+        return serial.Serial(start_test_port("core"), BAUD_RATE, timeout=1)
+    return serial.Serial(name, BAUD_RATE, timeout=1)
 
 def main():
-    ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=1)
-    print(f"Opened {SERIAL_PORT}")
+    port = sys.argv[1] if len(sys.argv) > 1 else SERIAL_PORT
+    ser = open_port(port)
+    print(f"Opened {port}")
 
-    while True:
-        try:
-            raw = ser.readline()
-            if not raw:
-                continue
+    # 시리얼은 읽기 스레드 (USB 가 빠지면 다시 열릴 때까지 재시도)
+    reopen = None if port == "test" else (lambda: open_port(port))
+    reader = SerialReader(ser, port, reopen=reopen).start()
 
-            # 바이트를 문자열로 디코딩하고 공백 제거
-            line = raw.decode('utf-8', errors='ignore').strip()
+    # 계측: 종류별 레코드 수, 시리얼 속도, 파싱 오류, HTTP 상태, 큐 깊이, 스풀 크기, 단계별 지연
+    metrics = CollectorMetrics(dispatcher, uplink, [reader], spool, reader.queue)
+    # 지연 추적: HX711 샘플(t0) → 안정 판정(ts) → UART(te) → 수신 → 디스패치 → 서버 응답 (tracing.py)
+    tracer = Tracer(metrics, TRACE_SLOW_S)
+    uplink.observer = tracer.on_uplink
+    uplink.context = tracer.attach
+    uplink.start()
+    if METRICS_PORT:
+        metrics.registry.serve(METRICS_PORT)
+        print(f"[OK] Metrics at http://127.0.0.1:{METRICS_PORT}/metrics")
+
+    try:
+        for t_rx, line in reader.lines():
             if not line:
                 continue
 
@@ -43,55 +112,30 @@ def main():
             if not line.startswith("{"):
                 continue
 
-            data = parse_json_line(line)
-            if not data:
+            try:
+                data = json.loads(line)
+            except json.JSONDecodeError:
+                metrics.parse_errors.inc(kind="json")
                 print("Error: Invalid JSON format received.")
                 continue
-            
-            # JSON 데이터에서 "uuid"를 추출
-            if "uuid" in data:
-                global UUID_TO_SEND
-                UUID_TO_SEND = data.get("uuid")
-
-            # JSON 데이터에서 "weight"를 추출
-            weight = data.get("weight")
-
-            # weight 필드가 없거나 0 이하인 경우 처리 방지
-            if weight is None or weight <= 0:
-                print(f"Skipping (weight <= 0 or missing): {weight}")
+            if not isinstance(data, dict):
+                metrics.parse_errors.inc(kind="json")
                 continue
 
-            url = BASE_URL
-            
-            payload = {
-                "uuid": UUID_TO_SEND,
-                "binId": BIN_ID,
-                "weight": weight
-            }
-
-            # 물통 무게 업데이트
-            # STM32에서 받은 JSON 데이터 (data)를 그대로 payload로 사용
-            resp = requests.patch(url, json=payload, timeout=3)
-            print(f"PATCH -> Status Code: {resp.status_code}")
-
-        except KeyboardInterrupt:
-            print("\nExiting program...")
-            break
-        except serial.SerialException as e:
-            print(f"Serial Error: {e}. Reconnecting in 5 seconds...")
-            ser.close()
-            time.sleep(5)
             try:
-                ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=1)
-                print(f"Reopened {SERIAL_PORT}")
-            except serial.SerialException:
-                print("Failed to reopen serial port.")
-        except requests.exceptions.RequestException as e:
-            print(f"HTTP Request Error: {e}")
-            time.sleep(1)
-        except Exception as e:
-            print("General Error:", e)
-            time.sleep(1)
+                # 배치 패킷 {"b":[...]} 이면 레코드 단위로, 레코드마다 추적 하나
+                for rec, _ in tracer.records(data, t_rx, port):
+                    dispatcher.dispatch(rec)
+                metrics.decoded(t_rx)
+            except Exception as e:
+                metrics.parse_errors.inc(kind="processing")
+                print("General Error:", e)
+
+    except KeyboardInterrupt:
+        print("\nExiting program...")
+        reader.stop()
+        # 못 보낸 건 스풀에 남아 있다가 다음 실행 때 다시 보냄
+        uplink.close(timeout=3)
 
 if __name__ == "__main__":
-    main()
\ No newline at end of file
+    main()
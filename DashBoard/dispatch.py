@@ -0,0 +1,123 @@
+import collections
+
+# 펌웨어가 레코드마다 넣는 메시지 종류 필드 (Core: "ev" / "h" / "fill")
+MSG_TYPE_FIELD = "m"
+
+NUMBER = (int, float)
+
+
+class Schema:
+    """
+    레코드 필드 검사
+      required: {필드: 타입 또는 타입 튜플}  - 없거나 타입이 다르면 거절
+      optional: {필드: 타입}                - 있으면 타입만 검사
+    """
+
+    def __init__(self, required=None, optional=None):
+        self.required = required or {}
+        self.optional = optional or {}
+
+    def check(self, data):
+        """문제 없으면 None, 있으면 이유 문자열"""
+        for name, typ in self.required.items():
+            if name not in data:
+                return f"missing '{name}'"
+            if not _is(data[name], typ):
+                return f"'{name}' is {type(data[name]).__name__}"
+        for name, typ in self.optional.items():
+            if name in data and data[name] is not None and not _is(data[name], typ):
+                return f"'{name}' is {type(data[name]).__name__}"
+        return None
+
+
+def _is(value, typ):
+    # bool 은 int 의 하위 타입이라 숫자 자리에 true/false 가 오면 거절
+    if isinstance(value, bool) and typ is not bool and (typ is int or typ is NUMBER):
+        return False
+    return isinstance(value, typ)
+
+
+def legacy_type(data):
+    """
+    종류 필드가 없는 옛 펌웨어(TX 노드) 레코드 → 종류 이름
+    (예전 메인 루프의 if/elif 순서 그대로, 새 펌웨어는 여기까지 안 옴)
+    """
+    if "idx" in data and "data" in data:
+        return "frag"
+    if "binWidthMm" in data:
+        return "laser"
+    if data.get("type") == "CUP":
+        return "cup"
+    if data.get("type") == "WATER":
+        return "liquid"
+    if "distanceCm" in data:
+        return "sonic"
+    if "beamBlocked" in data:
+        return "ir"
+    if "ev" in data:
+        return "ev"
+    if "h" in data:
+        return "h"
+    if "fill" in data:
+        return "fill"
+    if "airtime" in data:
+        return "airtime"
+    return None
+
+
+def unpack_batch(data):
+    """펌웨어 텔레메트리 배치 {"b":[rec1, rec2, ...]} → 레코드 목록 (하나짜리는 그대로)"""
+    if isinstance(data, dict) and isinstance(data.get("b"), list):
+        return [r for r in data["b"] if isinstance(r, dict)]
+    return [data]
+
+
+class Dispatcher:
+    """
+    메시지 종류 → 핸들러 표 (dict 한 번 조회로 결정, 레코드 하나는 핸들러 하나만 탐)
+
+        @dispatcher.register("cup", Schema({"weight": NUMBER}))
+        def request_Cup(data): ...
+
+    핸들러는 검사/가공 후 uplink 에 넣기만 하므로 여기서 바로 부름
+    (실제 전송은 종류별 uplink lane 의 워커들이 하므로 느린 레이저 POST 가 IR 을 막지 않음)
+    """
+
+    def __init__(self, classify=legacy_type):
+        self.routes = {}
+        self.classify = classify
+        self.stats = collections.Counter()
+
+    def register(self, mtype, schema=None):
+        def wrap(handler):
+            self.routes[mtype] = (handler, schema)
+            return handler
+        return wrap
+
+    def type_of(self, data):
+        # 종류 필드는 여기서 떼어냄 (핸들러가 레코드를 그대로 서버에 올리는 경우가 있음)
+        mtype = data.pop(MSG_TYPE_FIELD, None)
+        return mtype if mtype is not None else self.classify(data)
+
+    def dispatch(self, data, *args):
+        """레코드(또는 배치) 처리. 처리한 레코드 수 반환"""
+        handled = 0
+        for rec in unpack_batch(data):
+            mtype = self.type_of(rec)
+            route = self.routes.get(mtype)
+            if route is None:
+                self.stats["unknown"] += 1
+                print(f"[WARN] No handler for message type {mtype!r}: {str(rec)[:120]}")
+                continue
+
+            handler, schema = route
+            err = schema.check(rec) if schema is not None else None
+            if err is not None:
+                self.stats[f"invalid_{mtype}"] += 1
+                print(f"[WARN] Invalid {mtype} record ({err}): {str(rec)[:120]}")
+                continue
+
+            self.stats[mtype] += 1
+            handler(rec, *args)
+            handled += 1
+        return handled
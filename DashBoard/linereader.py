@@ -0,0 +1,142 @@
+import queue
+import re
+import threading
+import time
+
+# 펌웨어는 "\r\n" 또는 "\n" 으로 줄을 끝냄 (둘 중 하나만 와도 줄 끝)
+_EOL = re.compile(rb"[\r\n]")
+
+
+class LineSplitter:
+    """
+    시리얼에서 들어온 바이트 조각 → 완성된 줄(bytes) 목록
+
+    - 버퍼는 bytearray 하나, 새로 들어온 부분만 훑음 (이미 본 바이트를 다시 찾지 않음)
+    - 다 쓴 앞부분은 feed() 한 번에 한 번만 잘라냄 (줄마다 복사하지 않음)
+    - 줄 끝 없이 max_line 을 넘으면 쓰레기로 보고 버림 (overflow 로 집계)
+    """
+
+    def __init__(self, max_line=8192):
+        self.buf = bytearray()
+        self.scan = 0           # 여기부터 아직 안 훑은 바이트
+        self.max_line = max_line
+        self.overflow = 0
+
+    def feed(self, data):
+        buf = self.buf
+        buf += data
+        lines = []
+        start = 0
+        for m in _EOL.finditer(buf, self.scan):
+            end = m.start()
+            if end > start:
+                lines.append(bytes(buf[start:end]))
+            start = end + 1
+
+        if start:
+            del buf[:start]
+        self.scan = len(buf)
+
+        if self.scan > self.max_line:
+            self.overflow += 1
+            buf.clear()
+            self.scan = 0
+        return lines
+
+    def reset(self):
+        self.buf.clear()
+        self.scan = 0
+
+
+class SerialReader:
+    """
+    시리얼 읽기 전용 스레드
+
+    read() 가 첫 바이트가 올 때까지 막혀 있다가 (폴링/sleep 없음) 깨자마자 쌓인 만큼 한꺼번에 읽음
+    완성된 줄은 (수신 시각 monotonic, 이름, 줄 bytes) 로 큐에 넣음
+      - 포트 하나: lines() 로 (t, 줄) 을 꺼냄
+      - 포트 여러 개: 같은 out 큐를 넘기고 merged_lines(out) 으로 (t, 이름, 줄) 을 꺼냄
+    reopen 을 주면 읽기 오류(USB 빠짐 등) 때 포트를 닫고 다시 열릴 때까지 재시도
+    """
+
+    def __init__(self, ser, name="serial", out=None, reopen=None, maxsize=10000):
+        self.ser = ser
+        self.name = name
+        self.reopen = reopen
+        self.splitter = LineSplitter()
+        self.queue = out if out is not None else queue.Queue(maxsize)
+        self.bytes_in = 0
+        self.lines_in = 0
+        self.dropped = 0
+        self.errors = 0
+        self._stop = False
+        self._thread = threading.Thread(target=self._run, name=f"reader-{name}", daemon=True)
+
+    def start(self):
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._stop = True
+
+    def _recover(self, err):
+        self.errors += 1
+        print(f"[ERROR] {self.name} read error: {err}")
+        self.splitter.reset()
+        if self.reopen is None:
+            time.sleep(1)
+            return
+        try:
+            if self.ser is not None:
+                self.ser.close()
+        except Exception:
+            pass
+        while not self._stop:
+            time.sleep(2)
+            try:
+                self.ser = self.reopen()
+                print(f"[OK] {self.name} reopened")
+                return
+            except Exception as e:
+                print(f"[ERROR] {self.name} reopen failed: {e}")
+
+    def _run(self):
+        while not self._stop:
+            ser = self.ser
+            try:
+                if ser is None:
+                    raise IOError("port not open")
+                data = ser.read(max(1, ser.in_waiting))
+            except Exception as e:
+                self._recover(e)
+                continue
+            if not data:
+                continue        # 타임아웃 (아무것도 안 옴)
+
+            t = time.monotonic()
+            self.bytes_in += len(data)
+            for line in self.splitter.feed(data):
+                self.lines_in += 1
+                try:
+                    self.queue.put_nowait((t, self.name, line))
+                except queue.Full:
+                    self.dropped += 1
+
+    def lines(self, timeout=None):
+        """
+        줄을 하나씩 (t, str) 로 돌려줌. timeout 동안 아무 줄도 없으면 (None, None)
+        (메인 루프가 주기적인 일을 할 수 있게)
+        """
+        for t, _, line in merged_lines(self.queue, timeout):
+            yield t, line
+
+
+def merged_lines(q, timeout=None):
+    """공용 큐에서 (t, 이름, str). timeout 동안 없으면 (None, None, None)"""
+    while True:
+        try:
+            t, name, raw = q.get(timeout=timeout)
+        except queue.Empty:
+            yield None, None, None
+            continue
+        yield t, name, raw.decode("utf-8", errors="ignore").strip()
@@ -0,0 +1,403 @@
+import math
+import threading
+import time
+from http.server import ThreadingHTTPServer, BaseHTTPRequestHandler
+
+
+def _label_str(names, values):
+    if not names:
+        return ""
+    parts = []
+    for n, v in zip(names, values):
+        v = str(v).replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n")
+        parts.append(f'{n}="{v}"')
+    return "{" + ",".join(parts) + "}"
+
+
+def _fmt(v):
+    if v == math.inf:
+        return "+Inf"
+    if isinstance(v, float) and v.is_integer():
+        return str(int(v))
+    return repr(v) if isinstance(v, float) else str(v)
+
+
+class _Metric:
+    kind = ""
+
+    def __init__(self, name, help_text, labelnames=(), func=None):
+        self.name = name
+        self.help = help_text
+        self.labelnames = tuple(labelnames)
+        self.func = func        # 값을 그때그때 읽어오는 함수 (기존 카운터 노출용)
+        self._lock = threading.Lock()
+        self._values = {}
+
+    def _key(self, labels):
+        return tuple(labels.get(n, "") for n in self.labelnames)
+
+    def _items(self):
+        """[(라벨 값 튜플, 값)]"""
+        if self.func is not None:
+            v = self.func()
+            if isinstance(v, dict):
+                return [(k if isinstance(k, tuple) else (k,), x) for k, x in v.items()]
+            return [((), v)]
+        with self._lock:
+            return list(self._values.items())
+
+    def render(self, out):
+        out.append(f"# HELP {self.name} {self.help}")
+        out.append(f"# TYPE {self.name} {self.kind}")
+        for key, v in sorted(self._items(), key=lambda kv: tuple(map(str, kv[0]))):
+            out.append(f"{self.name}{_label_str(self.labelnames, key)} {_fmt(v)}")
+
+
+class Counter(_Metric):
+    kind = "counter"
+
+    def inc(self, n=1, **labels):
+        k = self._key(labels)
+        with self._lock:
+            self._values[k] = self._values.get(k, 0) + n
+
+    def get(self, **labels):
+        with self._lock:
+            return self._values.get(self._key(labels), 0)
+
+
+class Gauge(_Metric):
+    kind = "gauge"
+
+    def set(self, v, **labels):
+        with self._lock:
+            self._values[self._key(labels)] = v
+
+
+class _HdrCounts:
+    __slots__ = ("counts", "sum", "n")
+
+    def __init__(self, nbuckets):
+        self.counts = [0] * nbuckets
+        self.sum = 0.0
+        self.n = 0
+
+
+class Histogram(_Metric):
+    """
+    HDR 방식 로그-선형 히스토그램 [초]
+      - 2 배 구간(옥타브)마다 sub 칸으로 나눔 → 상대 오차 1/sub 이내가 전 범위에서 일정
+      - 기본: 2^-14 s (61 us) ~ 2^6 s (64 s), 옥타브당 4 칸 = 80 칸 (+ 그 위는 +Inf 칸)
+      - observe() 는 frexp 한 번으로 칸 번호를 계산 (정렬/탐색 없음)
+    """
+    kind = "histogram"
+
+    def __init__(self, name, help_text, labelnames=(), min_exp=-14, max_exp=6, sub=4):
+        super().__init__(name, help_text, labelnames)
+        self.min_exp = min_exp
+        self.sub = sub
+        self.nbuckets = (max_exp - min_exp) * sub
+        # 칸 i 의 상한 (마지막 칸 위는 +Inf)
+        self.bounds = [(1.0 + (i % sub + 1) / sub) * 2.0 ** (min_exp + i // sub)
+                       for i in range(self.nbuckets)]
+
+    def _index(self, v):
+        if v <= 0:
+            return 0
+        m, e = math.frexp(v)            # v = m * 2^e, 0.5 <= m < 1
+        octave = e - 1 - self.min_exp
+        if octave < 0:
+            return 0
+        # 칸 상한과 똑같은 값은 그 칸에 넣음 (Prometheus le 는 '이하') → 올림 - 1
+        i = octave * self.sub + math.ceil((2.0 * m - 1.0) * self.sub) - 1
+        return min(max(i, 0), self.nbuckets)
+
+    def observe(self, v, **labels):
+        k = self._key(labels)
+        i = self._index(v)
+        with self._lock:
+            h = self._values.get(k)
+            if h is None:
+                h = self._values[k] = _HdrCounts(self.nbuckets + 1)
+            h.counts[i] += 1
+            h.sum += v
+            h.n += 1
+
+    def count(self, **labels):
+        with self._lock:
+            h = self._values.get(self._key(labels))
+            return 0 if h is None else h.n
+
+    def quantile(self, q, **labels):
+        """q 분위 값의 칸 상한 (관측 없으면 None)"""
+        with self._lock:
+            h = self._values.get(self._key(labels))
+            if h is None or h.n == 0:
+                return None
+            target = q * h.n
+            acc = 0
+            for i, c in enumerate(h.counts):
+                acc += c
+                if acc >= target and c:
+                    return self.bounds[i] if i < self.nbuckets else math.inf
+            return math.inf
+
+    def render(self, out):
+        out.append(f"# HELP {self.name} {self.help}")
+        out.append(f"# TYPE {self.name} histogram")
+        names = self.labelnames + ("le",)
+        with self._lock:
+            items = [(k, list(h.counts), h.sum, h.n) for k, h in self._values.items()]
+        for key, counts, total, n in sorted(items, key=lambda it: tuple(map(str, it[0]))):
+            acc = 0
+            for i, c in enumerate(counts[:self.nbuckets]):
+                acc += c
+                # 비어 있는 앞쪽 칸은 생략 (누적값이 0 인 칸은 정보가 없음)
+                if acc:
+                    out.append(f"{self.name}_bucket{_label_str(names, key + (repr(self.bounds[i]),))} {acc}")
+            out.append(f"{self.name}_bucket{_label_str(names, key + ('+Inf',))} {n}")
+            out.append(f"{self.name}_sum{_label_str(self.labelnames, key)} {_fmt(total)}")
+            out.append(f"{self.name}_count{_label_str(self.labelnames, key)} {n}")
+
+
+class Registry:
+    """
+    수집기 계측값 모음. render() 가 Prometheus 텍스트 형식 문자열을 만듦
+    (서버 없이도 render()/quantile() 로 바로 확인 가능, serve() 는 /metrics 로 노출)
+    """
+
+    def __init__(self):
+        self.metrics = []
+
+    def _add(self, m):
+        self.metrics.append(m)
+        return m
+
+    def counter(self, name, help_text, labelnames=(), func=None):
+        return self._add(Counter(name, help_text, labelnames, func))
+
+    def gauge(self, name, help_text, labelnames=(), func=None):
+        return self._add(Gauge(name, help_text, labelnames, func))
+
+    def histogram(self, name, help_text, labelnames=(), **kw):
+        return self._add(Histogram(name, help_text, labelnames, **kw))
+
+    def render(self):
+        out = []
+        for m in self.metrics:
+            try:
+                m.render(out)
+            except Exception as e:
+                out.append(f"# {m.name} unavailable: {e}")
+        return "\n".join(out) + "\n"
+
+    def serve(self, port, host="127.0.0.1"):
+        registry = self
+
+        class Handler(BaseHTTPRequestHandler):
+            def do_GET(self):
+                if self.path.split("?")[0] != "/metrics":
+                    self.send_error(404)
+                    return
+                body = registry.render().encode("utf-8")
+                self.send_response(200)
+                self.send_header("Content-Type", "text/plain; version=0.0.4; charset=utf-8")
+                self.send_header("Content-Length", str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+            def log_message(self, *args):
+                pass
+
+        srv = ThreadingHTTPServer((host, port), Handler)
+        threading.Thread(target=srv.serve_forever, name="metrics", daemon=True).start()
+        return srv
+
+
+class _ClockFit:
+    __slots__ = ("last_tick", "win_end", "win_min", "mins", "a", "b")
+
+    def __init__(self, tick_ms, d):
+        self.last_tick = tick_ms
+        self.win_end = tick_ms + TickClock.WINDOW_MS
+        self.win_min = (tick_ms, d)     # 현재 창의 (틱, 최소 차이)
+        self.mins = []                  # 닫힌 창들의 (틱, 최소 차이)
+        self.a = d                      # 기준선 d = a + b * tick
+        self.b = 0.0
+
+
+class TickClock:
+    """
+    MCU 틱(ms) → 호스트 monotonic 변환 추정
+    d = 호스트 도착 시각 - 틱 은 (고정 차이 + 클럭 오차 * 틱 + 지연)
+      - 보드는 HSI (±1 %) 로 돌아서 오차가 한 시간에 최대 36 s → 최솟값 하나로는 금방 어긋남
+      - WINDOW_MS 창마다 d 의 최솟값(그 창에서 가장 빨리 온 레코드)을 모으고
+        최근 KEEP 개 창으로 최소제곱 직선 d = a + b * tick 을 맞춤 (b = 클럭 오차, 추정값)
+      - 직선을 모든 창 최솟값 아래로 내려 하한선으로 씀 → 지연 = d - 하한선
+    절대값은 아니지만 최소 지연 이상의 추가 지연을 봄. 오차 추정 정밀도는 창 최솟값의 흔들림
+    / 맞춘 구간 길이 정도 (수 ms / 10 분 → 10 ppm 안팎), 창이 둘 모이기 전에는 오차 0 으로 봄
+    틱이 되돌아가면 (MCU 리셋) 기준을 다시 잡음
+    """
+    WINDOW_MS = 5000
+    KEEP = 120                          # 10 분
+    MAX_SKEW = 0.05                     # 이보다 큰 기울기는 틱 이상으로 보고 자름
+
+    def __init__(self):
+        self.fits = {}                  # 소스 -> _ClockFit
+
+    def skew_ppm(self, source):
+        f = self.fits.get(source)
+        return None if f is None else f.b * 1e6
+
+    def _refit(self, f):
+        pts = f.mins
+        n = len(pts)
+        mt = sum(t for t, _ in pts) / n
+        md = sum(d for _, d in pts) / n
+        var = sum((t - mt) ** 2 for t, _ in pts)
+        b = sum((t - mt) * (d - md) for t, d in pts) / var if var else 0.0
+        f.b = max(-self.MAX_SKEW, min(self.MAX_SKEW, b))
+        # 하한선: 모든 창 최솟값이 선 위(이상)에 오도록 절편을 내림
+        f.a = min(d - f.b * t for t, d in pts + [f.win_min])
+
+    def delay(self, source, tick_ms, host_s):
+        d = host_s * 1000.0 - tick_ms
+        f = self.fits.get(source)
+        if f is None or tick_ms < f.last_tick:
+            f = self.fits[source] = _ClockFit(tick_ms, d)
+            return 0.0
+        f.last_tick = tick_ms
+        if tick_ms >= f.win_end:
+            f.mins.append(f.win_min)
+            del f.mins[:-self.KEEP]
+            f.win_min = (tick_ms, d)
+            f.win_end = tick_ms + self.WINDOW_MS
+            if len(f.mins) >= 2:
+                self._refit(f)
+        elif d < f.win_min[1]:
+            f.win_min = (tick_ms, d)
+        base = f.a + f.b * tick_ms
+        if d < base:
+            f.a = d - f.b * tick_ms
+            return 0.0
+        return (d - base) / 1000.0
+
+
+class _Rate:
+    """누적값 → 초당 변화량 (최소 1 초 간격으로 갱신, 그 사이엔 직전 값)"""
+
+    def __init__(self):
+        self.prev = {}
+        self.rate = {}
+
+    def update(self, key, total, now):
+        p = self.prev.get(key)
+        if p is None:
+            self.prev[key] = (now, total)
+            return 0.0
+        t0, v0 = p
+        if now - t0 >= 1.0:
+            self.rate[key] = (total - v0) / (now - t0)
+            self.prev[key] = (now, total)
+        return self.rate.get(key, 0.0)
+
+
+class CollectorMetrics:
+    """
+    수집기 공통 계측 (DashBoard / LoRaRX 수집기 둘 다 사용)
+
+    기존 카운터(리더/디스패처/uplink/스풀)는 그대로 두고 읽을 때 가져옴 → 핫 패스 추가 비용 없음
+    지연 히스토그램 3 단계
+      mcu_to_serial     : 레코드 "ts"(MCU 틱 ms) → 시리얼 수신 (TickClock 로 최소 지연 대비 추가 지연)
+      serial_to_decoded : 시리얼 수신 → 파싱/디스패치 끝
+      decoded_to_ack    : uplink 에 넣은 시각 → 서버 응답 (lane 별)
+    """
+
+    def __init__(self, dispatcher, uplink, readers, spool=None, line_queue=None):
+        r = self.registry = Registry()
+        self.readers = readers
+        self.clock = TickClock()
+        self._rate = _Rate()
+        self._lock = threading.Lock()
+
+        def by_type(invalid):
+            out = {}
+            for k, v in list(dispatcher.stats.items()):
+                bad = k == "unknown" or k.startswith("invalid_")
+                if bad == invalid:
+                    out[k[len("invalid_"):] if k.startswith("invalid_") else k] = v
+            return out
+
+        r.counter("collector_messages_total", "Records handled, by message type",
+                  ("type",), func=lambda: by_type(False))
+        r.counter("collector_messages_rejected_total", "Records with no handler or failing the schema",
+                  ("type",), func=lambda: by_type(True))
+        self.parse_errors = r.counter("collector_parse_errors_total", "Lines that could not be decoded",
+                                      ("kind",))
+
+        r.counter("collector_serial_bytes_total", "Bytes read from serial", ("port",),
+                  func=lambda: {rd.name: rd.bytes_in for rd in self.readers})
+        r.gauge("collector_serial_bytes_per_second", "Serial read rate", ("port",),
+                func=self._serial_rate)
+        r.counter("collector_serial_lines_total", "Complete lines read from serial", ("port",),
+                  func=lambda: {rd.name: rd.lines_in for rd in self.readers})
+        r.counter("collector_serial_dropped_total", "Lines dropped because the line queue was full",
+                  ("port",), func=lambda: {rd.name: rd.dropped for rd in self.readers})
+        r.counter("collector_serial_overflow_total", "Over-long lines discarded without a line end",
+                  ("port",), func=lambda: {rd.name: rd.splitter.overflow for rd in self.readers})
+        r.counter("collector_serial_errors_total", "Serial read errors (port lost etc.)",
+                  ("port",), func=lambda: {rd.name: rd.errors for rd in self.readers})
+        if line_queue is not None:
+            r.gauge("collector_line_queue_depth", "Lines waiting for the main loop",
+                    func=line_queue.qsize)
+
+        def uplink_counts(prefix):
+            out = {}
+            for lane, s in uplink.stats().items():
+                for k, v in s.items():
+                    if k.startswith(prefix):
+                        out[(lane, k[len(prefix):])] = v
+            return out
+
+        def uplink_field(name):
+            return lambda: {lane: s.get(name, 0) for lane, s in uplink.stats().items()}
+
+        r.counter("collector_http_responses_total", "Server responses by status code (error = no response)",
+                  ("lane", "code"), func=lambda: uplink_counts("http_"))
+        for name in ("queued", "coalesced", "dropped", "spilled", "spooled", "replayed"):
+            r.counter(f"collector_uplink_{name}_total", f"Uplink items {name}", ("lane",),
+                      func=uplink_field(name))
+        r.gauge("collector_uplink_queue_depth", "Items waiting in each uplink lane", ("lane",),
+                func=uplink_field("depth"))
+        r.gauge("collector_uplink_in_flight", "Requests being sent in each uplink lane", ("lane",),
+                func=uplink_field("in_flight"))
+        r.gauge("collector_uplink_state", "Uplink state (1 for the current one)", ("state",),
+                func=lambda: {uplink.state: 1})
+        if spool is not None:
+            r.gauge("collector_spool_rows", "Rows in the on-disk spool", func=spool.count)
+
+        self.mcu_to_serial = r.histogram("collector_mcu_to_serial_seconds",
+                                         "Record tick to serial arrival, above the minimum seen", ("source",))
+        self.serial_to_decoded = r.histogram("collector_serial_to_decoded_seconds",
+                                             "Serial arrival to dispatch done")
+        self.decoded_to_ack = r.histogram("collector_decoded_to_ack_seconds",
+                                          "Uplink submit to server response", ("lane",))
+
+    def _serial_rate(self):
+        now = time.monotonic()
+        with self._lock:
+            return {rd.name: self._rate.update(rd.name, rd.bytes_in, now) for rd in self.readers}
+
+    def observe_tick(self, source, tick, t_rx):
+        """레코드 "ts"(MCU 틱) → 시리얼 수신 지연 기록 (레코드에서 떼는 건 tracing.Tracer)"""
+        if t_rx is not None:
+            self.mcu_to_serial.observe(self.clock.delay(source, tick, t_rx), source=source)
+
+    def decoded(self, t_rx):
+        if t_rx is not None:
+            self.serial_to_decoded.observe(time.monotonic() - t_rx)
+
+    def on_uplink(self, lane, status, latency):
+        """응답(또는 실패)마다 호출 (Uplink observer 인 Tracer.on_uplink 가 넘겨줌)"""
+        if latency is not None:
+            self.decoded_to_ack.observe(latency, lane=lane)
@@ -0,0 +1,532 @@
+# 하드웨어 없이 수집기를 돌려 보기 위한 시리얼 시뮬레이터 + 가짜 서버
+#
+# 펌웨어가 UART 로 내보내는 줄을 그대로 흉내 내서 가상 포트(pty)에 씀
+#   - core   : 로드셀 노드 (Core/) 텔레메트리. ev/fill/h 레코드, 추적 필드 tr/t0/ts/te, {"b":[...]} 배치
+#              (telemetry.c 와 같은 기한/크기 규칙으로 묶음)
+#   - lorarx : TDMA 게이트웨이 (LoRaRX/) 출력 "[#노드:순번 rx=.. q=.. air=..] {...}"
+#              TX 노드 이벤트 = IR 시작 → IR 끝 → 레이저 조각들 → 컵 무게, 주기적인 LIVE 초음파
+#              게이트웨이 자체 출력: 시작 때 "TDMA slots=..." 한 번, 1 분마다 송신 시간 보고 {"m":"airtime",...}
+#              게이트웨이를 여러 개 주면 같은 패킷을 각자 따로 잃어버림 (중복 제거 시험용)
+#   - sensor : 센서 보드 UART 직결 (DashBoard/dataCollector.py 가 받는 줄)
+#              이벤트 = IR 시작 → IR 끝 → 레이저 샘플 한 줄 → 컵 무게 (가끔 물통 무게), 주기적인 LIVE 초음파
+# 손실/깨짐 비율, 이벤트 속도, 시간 배속을 줄 수 있음
+#
+#     python simulator.py core --rate 5                     → 가상 포트 경로 출력, 수집기에서 그 경로로 연결
+#     python simulator.py sensor --rate 1
+#     python simulator.py lorarx --gateways 2 --config gw.json --loss 0.1
+#     python ../LoRaRX/dataCollector.py --config gw.json
+#     python simulator.py backend --port 8080 --delay 0.02 --fail 0.01 --down-at 30 --down-for 20
+#
+# 수집기 쪽 지연/처리량은 수집기 /metrics 로 봄 (backend 는 받은 요청 수/초당 처리량만 출력)
+
+import argparse
+import json
+import os
+import random
+import threading
+import time
+import uuid
+from http.server import ThreadingHTTPServer, BaseHTTPRequestHandler
+
+# Core/Src/main.c, telemetry.c 와 같은 값
+FILL_PERIOD_MS = 5000
+HEALTH_PERIOD_MS = 10000
+TELEMETRY_MAX_PACKET = 200
+TELEMETRY_FLUSH_BYTES = 160
+TELEMETRY_STAMP_LEN = 16
+DEADLINE_MS = {"ev": 0, "h": 60000, "fill": 30000}
+
+# TX 노드 레이저: 250 샘플, LoRa 패킷 하나에 들어가도록 조각당 25 개
+LASER_SAMPLES = 250
+FRAGMENT_LEN = 25
+SONIC_PERIOD_S = 5.0
+TDMA_PERIOD_MS = 1000   # 노드가 자기 슬롯까지 기다리는 최대 시간 (q)
+
+# 게이트웨이 송신 시간 보고 (LoRaRX main.h / sx1272/airtime.h 와 같은 값)
+AIRTIME_STATS_PERIOD_MS = 60000
+AIRTIME_WINDOW_MS = 3600000
+AIRTIME_BUDGET_MS = AIRTIME_WINDOW_MS // 1000 * 100    # 10 %
+TDMA_BEACON_HDR_LEN = 8
+
+# 센서 보드 레이저: 한 줄에 전부 (빈 폭 mm)
+SENSOR_BIN_WIDTH_MM = 10
+
+
+def open_pty():
+    """(master fd, slave 경로). slave 경로를 수집기가 시리얼 포트처럼 엶"""
+    if not hasattr(os, "openpty"):
+        raise OSError("virtual serial ports need a POSIX pty (Linux/macOS)")
+    import tty
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    os.set_blocking(master, False)
+    return master, os.ttyname(slave)
+
+
+class Link:
+    """
+    시뮬레이터 → pty 한 개. 줄 단위로 손실/깨짐을 적용해서 씀
+    수집기가 안 읽어서 pty 버퍼가 차면 UART 처럼 그냥 버림 (overrun)
+    """
+
+    def __init__(self, fd, loss=0.0, corrupt=0.0, rng=None):
+        self.fd = fd
+        self.loss = loss
+        self.corrupt = corrupt
+        self.rng = rng or random.Random()
+        self.tick_offset = self.rng.randrange(1000000)
+        self.stats = {"lines": 0, "lost": 0, "corrupted": 0, "overrun": 0, "bytes": 0}
+
+    def write_line(self, text):
+        rng = self.rng
+        if self.loss and rng.random() < self.loss:
+            self.stats["lost"] += 1
+            return
+        data = bytearray(text.encode("utf-8") + b"\r\n")
+        if self.corrupt and rng.random() < self.corrupt:
+            self.stats["corrupted"] += 1
+            kind = rng.randrange(3)
+            if kind == 0:           # 비트 깨짐
+                i = rng.randrange(len(data) - 2)
+                data[i] ^= 1 << rng.randrange(8)
+            elif kind == 1:         # 중간에 끊김 (줄 끝은 옴)
+                data = data[:rng.randrange(1, len(data) - 1)] + b"\r\n"
+            else:                   # 줄 끝 유실 → 다음 줄과 붙음
+                data = data[:-2]
+        try:
+            os.write(self.fd, bytes(data))
+            self.stats["lines"] += 1
+            self.stats["bytes"] += len(data)
+        except BlockingIOError:
+            self.stats["overrun"] += 1
+
+
+class CoreNode:
+    """로드셀 노드 텔레메트리 (report_event + 주기 fill/h + Telemetry 배치)"""
+
+    def __init__(self, rng):
+        self.rng = rng
+        self.weight = 0.0
+        self.ev = []
+        self.latest = {}
+        self.trace_seq = 0
+        self.load_tick = 0
+        self.flush_at = None
+        self.next_fill = FILL_PERIOD_MS
+        self.next_health = HEALTH_PERIOD_MS
+
+    def _size(self):
+        recs = self.ev + list(self.latest.values())
+        n = len(recs)
+        return sum(len(r) for r in recs) + max(0, n - 1) + (8 if n > 1 else 0), n
+
+    def _flush(self, out, tick):
+        recs = self.ev + [self.latest[c] for c in ("h", "fill") if c in self.latest]
+        if recs:
+            pkt = recs[0] if len(recs) == 1 else '{"b":[' + ",".join(recs) + "]}"
+            out.append(pkt[:-1] + f',"te":{tick}}}')
+        self.ev, self.latest, self.flush_at = [], {}, None
+
+    def _push(self, cls, rec, tick, out):
+        rec = rec[:-1] + f',"ts":{tick}}}'
+        size, n = self._size()
+        if n and size + len(rec) + 9 + TELEMETRY_STAMP_LEN > TELEMETRY_MAX_PACKET:
+            self._flush(out, tick)
+        if cls == "ev":
+            self.ev.append(rec)
+        else:
+            self.latest[cls] = rec
+        due = tick + DEADLINE_MS[cls]
+        if self.flush_at is None or due < self.flush_at:
+            self.flush_at = due
+        if DEADLINE_MS[cls] == 0 or self._size()[0] >= TELEMETRY_FLUSH_BYTES:
+            self._flush(out, tick)
+
+    def event(self, tick):
+        """컵 올림/내림 하나 → 출력 줄 목록"""
+        out = []
+        rng = self.rng
+        if self.weight > 50 and rng.random() < 0.4:
+            dw = -min(self.weight, rng.uniform(10, 300))
+        else:
+            dw = rng.uniform(10, 400)
+        self.weight += dw
+        # 무게 변화가 처음 보인 샘플 → 안정 판정까지 (동적 추정/정적 판정 시간)
+        t0 = max(0, tick - int(rng.uniform(300, 1500)))
+        self.trace_seq = (self.trace_seq + 1) & 0xFFFF
+        rec = '{"m":"ev","uuid":"%s","ev":"%s","dw":%.2f,"weight":%.2f,"tr":%d,"t0":%d}' % (
+            uuid.uuid4(), "add" if dw > 0 else "remove", dw, self.weight, self.trace_seq, t0)
+        self._push("ev", rec, tick, out)
+        return out
+
+    def poll(self, tick):
+        """메인 루프 주기 작업 (fill/h 수집, 기한 지난 배치 전송)"""
+        out = []
+        if tick >= self.next_fill:
+            self.next_fill = tick + FILL_PERIOD_MS
+            self._push("fill", '{"m":"fill","fill":%.1f}' % self.weight, tick, out)
+        if tick >= self.next_health:
+            self.next_health = tick + HEALTH_PERIOD_MS
+            rec = ('{"m":"h","h":{"up":%d,"tare":0,"t":%.1f,"to":0,"sat":0,"sp":0,'
+                   '"stk":0,"ob":0,"nc":0,"f":0}}' % (tick // 1000, 24.0 + self.rng.uniform(-0.5, 0.5)))
+            self._push("h", rec, tick, out)
+        if self.flush_at is not None and tick >= self.flush_at:
+            self._flush(out, tick)
+        return out
+
+
+class TxNode:
+    """LoRa TX 노드 하나 (게이트웨이가 붙이는 "[#노드:순번]" 포함, 순번은 uint8)"""
+
+    def __init__(self, node_id, rng):
+        self.node = node_id
+        self.rng = rng
+        self.seq = 0
+        self.short_id = 0
+        self.trace_seq = 0
+        self.next_sonic = 0.0
+
+    def _pkt(self, body):
+        # (노드, 순번, 노드 대기 ms, 공중 시간 ms, 데이터) - 게이트웨이마다 자기 수신 틱을 붙여 한 줄로
+        self.seq = (self.seq + 1) & 0xFF
+        data = json.dumps(body, separators=(",", ":"))
+        air = int(20 + 0.6 * (len(data) + 5))      # SF7/125kHz 근사 (헤더 5 바이트 포함)
+        return (self.node, self.seq, self.rng.randrange(TDMA_PERIOD_MS), air, data)
+
+    def event(self):
+        rng = self.rng
+        self.short_id = self.short_id % 9999 + 1
+        sid = f"{self.short_id:04d}"
+        out = [self._pkt({"id": sid, "beamBlocked": True}),
+               self._pkt({"id": sid, "beamBlocked": False})]
+        # 빔이 풀린 뒤 측정해 둔 레이저 샘플을 조각으로 보냄 (컵이 지나가며 거리가 줄었다 늘어나는 모양)
+        base = rng.randint(300, 400)
+        depth = rng.randint(80, 200)
+        dist = [int(base - depth * max(0.0, 1 - abs(i - 125) / 90)) + rng.randint(-2, 2)
+                for i in range(LASER_SAMPLES)]
+        for i in range(0, LASER_SAMPLES, FRAGMENT_LEN):
+            out.append(self._pkt({"id": sid, "idx": i, "data": dist[i:i + FRAGMENT_LEN]}))
+        out.append(self._pkt({"id": sid, "type": "CUP", "weight": round(rng.uniform(5, 40), 1)}))
+        return out
+
+    def poll(self, now):
+        if now < self.next_sonic:
+            return []
+        self.next_sonic = now + SONIC_PERIOD_S
+        dist = round(self.rng.uniform(10, 60), 1)
+        return [self._pkt({"id": "LIVE", "distanceCm": dist, "fillRate": round(100 - dist * 1.5, 1)})]
+
+
+class SensorNode:
+    """센서 보드 UART 직결 (종류 필드 "m" 없는 예전 형식, 이벤트마다 uuid 하나)"""
+
+    def __init__(self, rng):
+        self.rng = rng
+        self.next_sonic = 0.0
+
+    def event(self):
+        rng = self.rng
+        uid = str(uuid.uuid4())
+        out = ['{"uuid":"%s","beamBlocked":true}' % uid,
+               '{"uuid":"%s","beamBlocked":false}' % uid]
+        base = rng.randint(300, 400)
+        depth = rng.randint(80, 200)
+        samples = [int(base - depth * max(0.0, 1 - abs(i - 125) / 90)) + rng.randint(-2, 2)
+                   for i in range(LASER_SAMPLES)]
+        out.append(json.dumps({"uuid": uid, "binWidthMm": SENSOR_BIN_WIDTH_MM, "samples": samples},
+                              separators=(",", ":")))
+        out.append('{"uuid":"%s","type":"CUP","weight":%.1f}' % (uid, rng.uniform(5, 40)))
+        if rng.random() < 0.3:
+            out.append('{"uuid":"%s","type":"WATER","weight":%.1f}' % (uid, rng.uniform(20, 300)))
+        return out
+
+    def poll(self, now):
+        if now < self.next_sonic:
+            return []
+        self.next_sonic = now + SONIC_PERIOD_S
+        dist = round(self.rng.uniform(10, 60), 1)
+        return ['{"distanceCm":%.1f,"fillRate":%.1f}' % (dist, 100 - dist * 1.5)]
+
+
+class Gateway:
+    """게이트웨이 자체 출력 (비콘 송신 시간 누적 → 1 분마다 airtime 보고, airtime.c 형식)"""
+
+    def __init__(self, slots):
+        self.slots = slots
+        self.beacon_air = int(20 + 0.6 * (TDMA_BEACON_HDR_LEN + slots))
+        self.next_report = AIRTIME_STATS_PERIOD_MS
+
+    def banner(self):
+        return f"TDMA slots={self.slots} slot=100ms guard=10ms period={TDMA_PERIOD_MS}ms"
+
+    def poll(self, tick):
+        if tick < self.next_report:
+            return []
+        self.next_report = tick + AIRTIME_STATS_PERIOD_MS
+        pkts = tick // TDMA_PERIOD_MS
+        used = min(tick, AIRTIME_WINDOW_MS) // TDMA_PERIOD_MS * self.beacon_air
+        permille = used * 1000 // AIRTIME_BUDGET_MS
+        level = sum(permille >= t for t in (500, 800, 950))
+        return ['{"m":"airtime","airtime":{"usedMs":%d,"budgetMs":%d,"level":%d,'
+                '"pkts":%d,"totalMs":%d,"deferred":0,"dropped":0}}'
+                % (used, AIRTIME_BUDGET_MS, level, pkts, pkts * self.beacon_air)]
+
+
+class Simulator:
+    """
+    profile: "core", "lorarx" 또는 "sensor"
+    rate   : 초당 이벤트 수 (노드 전체 합, 포아송 도착)
+    speed  : 시간 배속 (MCU 틱과 주기 작업이 speed 배로 흐름)
+    links  : 출력 Link 목록 (core 는 첫 번째만 씀, lorarx 는 게이트웨이마다 하나)
+    """
+
+    def __init__(self, profile, links, rate=1.0, nodes=1, speed=1.0, seed=None):
+        self.profile = profile
+        self.links = links
+        self.rate = rate
+        self.speed = speed
+        self.rng = random.Random(seed)
+        self.gateway = None
+        if profile == "core":
+            self.nodes = [CoreNode(self.rng)]
+        elif profile == "sensor":
+            self.nodes = [SensorNode(self.rng)]
+        else:
+            self.nodes = [TxNode(i + 1, self.rng) for i in range(nodes)]
+            self.gateway = Gateway(max(4, len(self.nodes)))
+        self.events = 0
+        self._stop = False
+
+    def _emit(self, lines, sim=0.0):
+        for line in lines:
+            if isinstance(line, str):
+                for ln in (self.links if self.profile == "lorarx" else self.links[:1]):
+                    ln.write_line(line)
+                continue
+            node, seq, q, air, data = line
+            for ln in self.links:
+                # 게이트웨이 틱은 보드마다 켜진 시각이 달라서 따로
+                rx = int(sim * 1000) + ln.tick_offset
+                ln.write_line(f"[#{node}:{seq} rx={rx} q={q} air={air}] {data}")
+
+    def run(self, duration=None):
+        t0 = time.monotonic()
+        if self.profile == "lorarx":
+            self._emit([self.gateway.banner()])
+        elif self.profile == "core":
+            self._emit(["calib #1 restored, drift= 0.00 g"])
+        next_ev = t0 + (self.rng.expovariate(self.rate) / self.speed if self.rate > 0 else float("inf"))
+
+        while not self._stop:
+            now = time.monotonic()
+            if duration is not None and now - t0 >= duration:
+                break
+            sim = (now - t0) * self.speed
+            tick = int(sim * 1000)
+
+            if now >= next_ev:
+                node = self.rng.choice(self.nodes)
+                self._emit(node.event(tick) if self.profile == "core" else node.event(), sim)
+                self.events += 1
+                next_ev += self.rng.expovariate(self.rate) / self.speed
+
+            for node in self.nodes:
+                self._emit(node.poll(tick) if self.profile == "core" else node.poll(sim), sim)
+            if self.gateway is not None:
+                self._emit(self.gateway.poll(tick), sim)
+
+            time.sleep(max(0.0, min(next_ev - time.monotonic(), 0.01)))
+
+    def start(self, duration=None):
+        threading.Thread(target=self.run, args=(duration,), name="simulator", daemon=True).start()
+        return self
+
+    def stop(self):
+        self._stop = True
+
+    def stats(self):
+        total = {}
+        for ln in self.links:
+            for k, v in ln.stats.items():
+                total[k] = total.get(k, 0) + v
+        total["events"] = self.events
+        return total
+
+
+def start_test_port(profile, rate=0.5, **kw):
+    """수집기 "test" 모드용: pty 하나 + 시뮬레이터 스레드. 수집기가 열 포트 경로를 돌려줌"""
+    master, path = open_pty()
+    Simulator(profile, [Link(master)], rate=rate, **kw).start()
+    print(f"[TEST] Simulated {profile} firmware on {path}")
+    return path
+
+
+class StubBackend:
+    """
+    가짜 서버: 모든 POST/PATCH/DELETE 에 200 {"isSuccess":true,...}
+      delay    : 응답 지연 [s] (지수 분포 평균)
+      fail     : 5xx 비율
+      down_at / down_for : 시작 후 down_at 초부터 down_for 초 동안 연결 거부 (복구 시험)
+    """
+
+    def __init__(self, port=8080, delay=0.0, fail=0.0, down_at=None, down_for=0.0, seed=None):
+        self.port = port
+        self.delay = delay
+        self.fail = fail
+        self.down_at = down_at
+        self.down_for = down_for
+        self.rng = random.Random(seed)
+        self.lock = threading.Lock()
+        self.counts = {}
+        self.total = 0
+        self.down = False
+        self.srv = None
+
+    def _handler(self):
+        backend = self
+
+        class Handler(BaseHTTPRequestHandler):
+            protocol_version = "HTTP/1.1"
+            # 헤더/본문을 따로 쓰므로 Nagle 을 끄지 않으면 keep-alive 요청마다 지연 ACK(~40ms)를 기다림
+            disable_nagle_algorithm = True
+
+            def _any(self):
+                n = int(self.headers.get("Content-Length", 0))
+                body = self.rfile.read(n)
+                if backend.down:
+                    # 이미 열려 있던 keep-alive 연결도 응답 없이 끊음 (서버가 죽은 것처럼)
+                    self.close_connection = True
+                    return
+                if backend.delay:
+                    time.sleep(backend.rng.expovariate(1.0 / backend.delay))
+                path = self.path.split("?")[0]
+                code = 500 if backend.fail and backend.rng.random() < backend.fail else 200
+                with backend.lock:
+                    key = (self.command, path, code)
+                    backend.counts[key] = backend.counts.get(key, 0) + 1
+                    backend.total += 1
+                try:
+                    payload = json.loads(body) if body else {}
+                except ValueError:
+                    payload = {}
+                out = json.dumps({"isSuccess": code == 200,
+                                  "result": {"uuid": payload.get("uuid") if isinstance(payload, dict) else None,
+                                             "isValidCup": True, "patternType": "SIM",
+                                             "patternDescription": "simulated",
+                                             "minDiameterMm": 60.0, "maxDiameterMm": 80.0}}).encode()
+                self.send_response(code)
+                self.send_header("Content-Type", "application/json")
+                self.send_header("Content-Length", str(len(out)))
+                self.end_headers()
+                self.wfile.write(out)
+
+            do_POST = _any
+            do_PATCH = _any
+            do_DELETE = _any
+
+            def log_message(self, *args):
+                pass
+
+        return Handler
+
+    def _serve(self):
+        self.srv = ThreadingHTTPServer(("127.0.0.1", self.port), self._handler())
+        self.srv.daemon_threads = True
+        threading.Thread(target=self.srv.serve_forever, name="backend", daemon=True).start()
+
+    def run(self):
+        t0 = time.monotonic()
+        self._serve()
+        last_total, last_t = 0, t0
+        while True:
+            time.sleep(1.0)
+            now = time.monotonic()
+            if self.down_at is not None:
+                in_window = self.down_at <= now - t0 < self.down_at + self.down_for
+                if in_window and not self.down:
+                    self.down = True
+                    self.srv.shutdown()
+                    self.srv.server_close()
+                    print("[BACKEND] down")
+                elif not in_window and self.down:
+                    self.down = False
+                    self._serve()
+                    print("[BACKEND] up")
+            with self.lock:
+                total = self.total
+            if now - last_t >= 5.0:
+                print(f"[BACKEND] {total} requests, {(total - last_total) / (now - last_t):.1f}/s")
+                last_total, last_t = total, now
+
+    def summary(self):
+        with self.lock:
+            return "\n".join(f"  {m} {p} {c}: {n}" for (m, p, c), n in sorted(self.counts.items()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Firmware serial simulator and stub server")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    for name in ("core", "lorarx", "sensor"):
+        p = sub.add_parser(name, help=f"simulate {name} serial output on a pty")
+        p.add_argument("--rate", type=float, default=1.0, help="events per second (all nodes)")
+        p.add_argument("--loss", type=float, default=0.0, help="line loss probability")
+        p.add_argument("--corrupt", type=float, default=0.0, help="line corruption probability")
+        p.add_argument("--speed", type=float, default=1.0, help="MCU time speed-up")
+        p.add_argument("--duration", type=float, help="stop after this many seconds")
+        p.add_argument("--seed", type=int)
+        if name == "lorarx":
+            p.add_argument("--nodes", type=int, default=1, help="TX nodes")
+            p.add_argument("--gateways", type=int, default=1, help="gateway ports (each loses independently)")
+            p.add_argument("--config", help="write a gateways.json for dataCollector.py --config")
+
+    p = sub.add_parser("backend", help="stub HTTP server")
+    p.add_argument("--port", type=int, default=8080)
+    p.add_argument("--delay", type=float, default=0.0, help="mean response delay [s]")
+    p.add_argument("--fail", type=float, default=0.0, help="5xx probability")
+    p.add_argument("--down-at", type=float, help="go down this many seconds after start")
+    p.add_argument("--down-for", type=float, default=10.0, help="outage length [s]")
+    p.add_argument("--seed", type=int)
+    args = parser.parse_args()
+
+    if args.cmd == "backend":
+        backend = StubBackend(args.port, args.delay, args.fail, args.down_at, args.down_for, args.seed)
+        print(f"[BACKEND] http://127.0.0.1:{args.port}")
+        try:
+            backend.run()
+        except KeyboardInterrupt:
+            print(backend.summary())
+        return
+
+    rng = random.Random(args.seed)
+    ports = []
+    links = []
+    for _ in range(args.gateways if args.cmd == "lorarx" else 1):
+        master, path = open_pty()
+        ports.append(path)
+        links.append(Link(master, args.loss, args.corrupt, random.Random(rng.random())))
+
+    for i, path in enumerate(ports):
+        print(f"[SIM] port {i}: {path}")
+    if args.cmd == "lorarx" and args.config:
+        with open(args.config, "w", encoding="utf-8") as f:
+            # 빈(bin)은 노드마다 (게이트웨이는 같은 노드를 겹쳐 들음)
+            json.dump({"nodes": {str(n + 1): n + 1 for n in range(args.nodes)},
+                       "gateways": [{"name": f"sim{i}", "port": path}
+                                    for i, path in enumerate(ports)]}, f, indent=2)
+        print(f"[SIM] wrote {args.config}")
+
+    sim = Simulator(args.cmd, links, args.rate, getattr(args, "nodes", 1), args.speed, args.seed).start()
+    t0 = time.monotonic()
+    try:
+        while args.duration is None or time.monotonic() - t0 < args.duration:
+            time.sleep(5.0)
+            print(f"[SIM] {sim.stats()}")
+    except KeyboardInterrupt:
+        pass
+    sim.stop()
+    print(f"[SIM] {sim.stats()}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+import json
+import sqlite3
+import threading
+
+
+class Spool:
+    """
+    서버로 보낼 항목을 보내기 전에 디스크에 먼저 기록하는 선기록(write-ahead) 저장소
+
+    - SQLite WAL 모드: 한 건 추가 = WAL 에 한 줄 append (+ fsync), 수집기가 죽어도 남음
+    - 서버가 성공 응답하면 ack() 로 지움 → 남아 있는 행 = 아직 서버에 안 들어간 것
+    - 같은 lane + key 의 안 보낸 행이 있으면 새 행 대신 그 행을 갱신 (PATCH 는 최신 값만 의미)
+    - 지운 자리는 compact() 에서 WAL 체크포인트 + incremental vacuum 으로 파일 크기 회수
+    """
+
+    def __init__(self, path, sync="FULL"):
+        self.path = path
+        self._lock = threading.Lock()
+        self._db = sqlite3.connect(path, check_same_thread=False, isolation_level=None)
+        self._db.execute("PRAGMA auto_vacuum=INCREMENTAL")     # 테이블 만들기 전에만 효과 있음
+        self._db.execute("PRAGMA journal_mode=WAL")
+        self._db.execute(f"PRAGMA synchronous={sync}")
+        self._db.execute(
+            "CREATE TABLE IF NOT EXISTS spool ("
+            " id      INTEGER PRIMARY KEY AUTOINCREMENT,"
+            " lane    TEXT NOT NULL,"
+            " method  TEXT NOT NULL,"
+            " url     TEXT NOT NULL,"
+            " payload TEXT NOT NULL,"
+            " key     TEXT,"
+            " t       REAL NOT NULL)")
+        self._db.execute("CREATE INDEX IF NOT EXISTS spool_key ON spool(lane, key)")
+
+    def put(self, lane, method, url, payload, key, t, skip=()):
+        """
+        한 건 기록하고 행 id 반환
+        key(문자열)가 같은 행이 있고 그 행이 skip(전송 중) 에 없으면 그 행을 갱신해서 같은 id 반환
+        """
+        k = key
+        body = json.dumps(payload, separators=(",", ":"))
+        with self._lock:
+            if k is not None:
+                row = self._db.execute(
+                    "SELECT id FROM spool WHERE lane=? AND key=? ORDER BY id DESC LIMIT 1",
+                    (lane, k)).fetchone()
+                if row is not None and row[0] not in skip:
+                    self._db.execute("UPDATE spool SET method=?, url=?, payload=? WHERE id=?",
+                                     (method, url, body, row[0]))
+                    return row[0]
+            cur = self._db.execute(
+                "INSERT INTO spool(lane, method, url, payload, key, t) VALUES (?,?,?,?,?,?)",
+                (lane, method, url, body, k, t))
+            return cur.lastrowid
+
+    def update(self, sid, method, url, payload):
+        body = json.dumps(payload, separators=(",", ":"))
+        with self._lock:
+            self._db.execute("UPDATE spool SET method=?, url=?, payload=? WHERE id=?",
+                             (method, url, body, sid))
+
+    def ack(self, sid):
+        with self._lock:
+            self._db.execute("DELETE FROM spool WHERE id=?", (sid,))
+
+    def exists(self, sid):
+        with self._lock:
+            return self._db.execute("SELECT 1 FROM spool WHERE id=?", (sid,)).fetchone() is not None
+
+    def pending(self, after=0, limit=64):
+        """id 가 after 보다 큰 행을 오래된 순으로 (id, lane, method, url, payload, key)"""
+        with self._lock:
+            rows = self._db.execute(
+                "SELECT id, lane, method, url, payload, key FROM spool WHERE id>? ORDER BY id LIMIT ?",
+                (after, limit)).fetchall()
+        return [(r[0], r[1], r[2], r[3], json.loads(r[4]), r[5]) for r in rows]
+
+    def count(self):
+        with self._lock:
+            return self._db.execute("SELECT COUNT(*) FROM spool").fetchone()[0]
+
+    def compact(self):
+        with self._lock:
+            self._db.execute("PRAGMA wal_checkpoint(TRUNCATE)")
+            self._db.execute("PRAGMA incremental_vacuum").fetchall()
+
+    def close(self):
+        with self._lock:
+            self._db.close()
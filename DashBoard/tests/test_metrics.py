@@ -0,0 +1,174 @@
+import math
+import os
+import random
+import sys
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from metrics import Histogram, Registry, TickClock
+
+
+class HistogramBucketTest(unittest.TestCase):
+
+    def setUp(self):
+        self.h = Histogram("lat_seconds", "latency")
+
+    def test_bounds(self):
+        b = self.h.bounds
+        self.assertEqual(len(b), 80)
+        self.assertEqual(b[0], 1.25 * 2.0 ** -14)
+        self.assertEqual(b[-1], 64.0)
+        self.assertEqual(b[55], 1.0)
+        for lo, hi in zip(b, b[1:]):
+            self.assertLess(lo, hi)
+            self.assertLessEqual(hi / lo, 1.25)
+
+    def test_bound_lands_in_own_bucket(self):
+        # le 는 '이하': 상한과 같은 값은 그 칸, 바로 위 값은 다음 칸
+        for i, bound in enumerate(self.h.bounds):
+            self.assertEqual(self.h._index(bound), i)
+            self.assertEqual(self.h._index(math.nextafter(bound, math.inf)), i + 1)
+
+    def test_in_range(self):
+        rnd = random.Random(1)
+        for _ in range(2000):
+            v = 2.0 ** rnd.uniform(-13.9, 5.9)
+            i = self.h._index(v)
+            if i:
+                self.assertLess(self.h.bounds[i - 1], v)
+            self.assertLessEqual(v, self.h.bounds[i])
+
+    def test_edges(self):
+        self.assertEqual(self.h._index(0.0), 0)
+        self.assertEqual(self.h._index(-1.0), 0)
+        self.assertEqual(self.h._index(1e-9), 0)
+        self.assertEqual(self.h._index(2.0 ** -14), 0)
+        self.assertEqual(self.h._index(64.0), 79)
+        self.assertEqual(self.h._index(64.001), self.h.nbuckets)
+        self.assertEqual(self.h._index(1e9), self.h.nbuckets)
+
+
+class HistogramQuantileTest(unittest.TestCase):
+
+    def test_empty(self):
+        h = Histogram("x", "x")
+        self.assertIsNone(h.quantile(0.5))
+        self.assertEqual(h.count(), 0)
+
+    def test_relative_error(self):
+        h = Histogram("x", "x", ("src",))
+        values = [0.001 * (k + 1) for k in range(1000)]     # 1 ms ~ 1 s
+        for v in values:
+            h.observe(v, src="a")
+        self.assertEqual(h.count(src="a"), 1000)
+        self.assertIsNone(h.quantile(0.5, src="b"))
+        for q in (0.5, 0.9, 0.99, 1.0):
+            exact = values[math.ceil(q * len(values)) - 1]
+            got = h.quantile(q, src="a")
+            self.assertGreaterEqual(got, exact)
+            self.assertLessEqual(got, exact * 1.25)
+
+    def test_overflow(self):
+        h = Histogram("x", "x")
+        h.observe(0.01)
+        h.observe(100.0)
+        self.assertEqual(h.quantile(0.5), h.bounds[h._index(0.01)])
+        self.assertEqual(h.quantile(1.0), math.inf)
+
+
+class RegistryRenderTest(unittest.TestCase):
+
+    def test_render(self):
+        reg = Registry()
+        c = reg.counter("rx_total", "received lines", ("port",))
+        c.inc(port="COM3")
+        c.inc(2, port='a"b\\c\nd')
+        reg.gauge("queue", "queued", func=lambda: 2.5)
+        reg.gauge("up", "up", ("lane",), func=lambda: {"cup": 1.0, ("ir",): 0})
+        h = reg.histogram("lat_seconds", "latency", ("stage",), min_exp=-2, max_exp=1, sub=2)
+        h.observe(0.375, stage="air")     # 1/4 ~ 3/8 칸 상한
+        h.observe(1.0, stage="air")       # 상한과 같은 값
+        h.observe(3.0, stage="air")       # +Inf
+        self.assertEqual(reg.render(), "\n".join([
+            "# HELP rx_total received lines",
+            "# TYPE rx_total counter",
+            'rx_total{port="COM3"} 1',
+            'rx_total{port="a\\"b\\\\c\\nd"} 2',
+            "# HELP queue queued",
+            "# TYPE queue gauge",
+            "queue 2.5",
+            "# HELP up up",
+            "# TYPE up gauge",
+            'up{lane="cup"} 1',
+            'up{lane="ir"} 0',
+            "# HELP lat_seconds latency",
+            "# TYPE lat_seconds histogram",
+            'lat_seconds_bucket{stage="air",le="0.375"} 1',
+            'lat_seconds_bucket{stage="air",le="0.5"} 1',
+            'lat_seconds_bucket{stage="air",le="0.75"} 1',
+            'lat_seconds_bucket{stage="air",le="1.0"} 2',
+            'lat_seconds_bucket{stage="air",le="1.5"} 2',
+            'lat_seconds_bucket{stage="air",le="2.0"} 2',
+            'lat_seconds_bucket{stage="air",le="+Inf"} 3',
+            'lat_seconds_sum{stage="air"} 4.375',
+            'lat_seconds_count{stage="air"} 3',
+        ]) + "\n")
+
+    def test_render_failure_is_isolated(self):
+        reg = Registry()
+        reg.gauge("bad", "bad", func=lambda: 1 / 0)
+        reg.counter("ok_total", "ok").inc()
+        self.assertEqual(reg.render(), "\n".join([
+            "# HELP bad bad",
+            "# TYPE bad gauge",
+            "# bad unavailable: division by zero",
+            "# HELP ok_total ok",
+            "# TYPE ok_total counter",
+            "ok_total 1",
+        ]) + "\n")
+
+
+class TickClockTest(unittest.TestCase):
+
+    def _run(self, skew, hours=1.0, period_ms=1000, seed=0):
+        """
+        MCU 클럭이 skew 만큼 빠른/느린 소스를 period_ms 마다 흉내
+        지연 = 2 ms + 지수분포 (평균 5 ms), 가끔 200 ms 묶음 지연
+        (틱, 실제 추가 지연 s, 추정 지연 s) 목록을 돌려줌
+        """
+        rnd = random.Random(seed)
+        clock = TickClock()
+        out = []
+        host0 = 5000.0
+        for k in range(int(hours * 3600e3 / period_ms)):
+            true_ms = k * period_ms
+            tick = int(true_ms * (1.0 + skew))
+            extra = rnd.expovariate(1 / 5.0) + (200.0 if rnd.random() < 0.02 else 0.0)
+            host_s = host0 + (true_ms + 2.0 + extra) / 1000.0
+            out.append((tick, extra / 1000.0, clock.delay("core", tick, host_s)))
+        return clock, out
+
+    def test_skew_does_not_accumulate(self):
+        for skew in (0.01, -0.01, 0.0):
+            clock, out = self._run(skew)
+            # 처음 1 분 (기울기 추정 전) 뒤로는 실제 추가 지연을 수 ms 안에서 따라감
+            errs = [abs(est - true) for _, true, est in out[60:]]
+            self.assertLess(max(errs), 0.02, skew)
+            self.assertLess(sum(errs) / len(errs), 0.005, skew)
+            # 추정 기울기 (d 는 호스트 - 틱 이므로 틱이 빠르면 음수)
+            want = 1.0 / (1.0 + skew) - 1.0
+            self.assertAlmostEqual(clock.skew_ppm("core") / 1e6, want, delta=50e-6)
+
+    def test_reset_on_tick_wrap(self):
+        clock = TickClock()
+        for k in range(100):
+            clock.delay("core", 1000000 + k * 1000, 10.0 + k)
+        self.assertEqual(clock.delay("core", 500, 200.0), 0.0)
+        self.assertAlmostEqual(clock.delay("core", 1500, 201.25), 0.25)
+        self.assertEqual(clock.skew_ppm("core"), 0.0)
+        self.assertIsNone(clock.skew_ppm("lorarx"))
+
+
+if __name__ == "__main__":
+    unittest.main()
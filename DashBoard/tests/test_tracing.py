@@ -0,0 +1,59 @@
+import contextlib
+import io
+import os
+import sys
+import time
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from tracing import Tracer
+
+
+class TracerPeriodicTest(unittest.TestCase):
+    """주기 레코드(fill/h)는 배치 대기가 길어도 추적/느림 출력이 없어야 함"""
+
+    def setUp(self):
+        self.tracer = Tracer(slow_s=2.0)
+
+    def _run(self, data, link=None):
+        out = io.StringIO()
+        with contextlib.redirect_stdout(out):
+            got = list(self.tracer.records(data, time.monotonic(), "COM3", link))
+        return got, out.getvalue()
+
+    def test_periodic_batch_not_traced(self):
+        data = {"b": [{"m": "fill", "fill": 12.5, "ts": 1000},
+                      {"m": "h", "h": {"up": 60}, "ts": 2000}],
+                "te": 61000}
+        got, printed = self._run(data)
+        self.assertEqual([t for _, t in got], [None, None])
+        self.assertEqual(got[0][0], {"m": "fill", "fill": 12.5})
+        self.assertEqual(printed, "")
+        self.assertEqual(len(self.tracer.recent), 0)
+
+    def test_legacy_periodic_not_traced(self):
+        got, _ = self._run({"fill": 3.0, "ts": 10, "te": 40000})
+        self.assertIsNone(got[0][1])
+
+    def test_event_traced(self):
+        data = {"b": [{"m": "ev", "ev": "STABLE", "tr": 7, "t0": 900, "ts": 1400},
+                      {"m": "fill", "fill": 1.0, "ts": 1000}],
+                "te": 1450}
+        got, printed = self._run(data)
+        trace = got[0][1]
+        self.assertIsNotNone(trace)
+        self.assertIsNone(got[1][1])
+        self.assertEqual(trace.key, "COM3#7")
+        self.assertEqual(trace.stages["settle"], 0.5)
+        self.assertEqual(trace.stages["batch"], 0.05)
+        self.assertEqual(printed, "")
+        self.assertEqual([k for k, _, _ in self.tracer.recent], ["COM3#7"])
+
+    def test_slow_event_reported(self):
+        _, printed = self._run({"m": "ev", "ev": "STABLE", "tr": 8, "t0": 0, "ts": 2500, "te": 2600})
+        self.assertIn("[TRACE] slow COM3#8: settle 2500, batch 100", printed)
+
+
+if __name__ == "__main__":
+    unittest.main()
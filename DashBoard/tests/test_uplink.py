@@ -0,0 +1,117 @@
+import os
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from spool import Spool
+from uplink import Uplink, CATCHUP
+
+
+class _Resp:
+    def __init__(self, status_code):
+        self.status_code = status_code
+
+
+class _Session:
+    """보낸 요청만 기록하고 항상 status 로 응답"""
+
+    def __init__(self, status=200):
+        self.status = status
+        self.sent = []
+
+    def request(self, method, url, json=None, timeout=None):
+        self.sent.append((method, url, json))
+        return _Resp(self.status)
+
+
+class UplinkSpoolTest(unittest.TestCase):
+    """워커/재전송 스레드 없이 (start() 안 부름) 병합과 스풀 행 정리만 확인"""
+
+    def setUp(self):
+        self.dir = tempfile.TemporaryDirectory()
+        self.spool = Spool(os.path.join(self.dir.name, "spool.db"), sync="OFF")
+        self.up = Uplink(spool=self.spool)
+        self.up.add_lane("cup")
+        self.up.session = _Session()
+        self.ln = self.up.lanes["cup"]
+
+    def tearDown(self):
+        self.spool._db.close()
+        self.dir.cleanup()
+
+    def _send_all(self):
+        while True:
+            with self.ln.cond:
+                batch = self.up._take(self.ln)
+            if not batch:
+                return
+            for it in batch:
+                self.up._send(self.ln, it)
+                with self.ln.cond:
+                    self.ln.busy.discard(it.key)
+
+    def test_replayed_row_merged_into_queued_item_is_acked(self):
+        # 같은 key: 첫 값은 실시간으로 큐에, 그다음 CATCHUP 중에 온 값은 스풀에만
+        self.up.submit("cup", "PATCH", "http://x/cup", {"w": 1}, key="K")
+        self.up.state = CATCHUP
+        self.up.submit("cup", "PATCH", "http://x/cup", {"w": 2}, key="K")
+        rows = self.spool.pending(0, 10)
+        self.assertEqual(len(rows), 2)
+
+        # 재전송이 두 번째 행을 큐의 첫 항목에 합침 → 첫 행은 ack, 항목은 두 번째 행을 가리킴
+        self.assertTrue(self.up._replay_row(self.ln, rows[1]))
+        self.assertEqual([r[0] for r in self.spool.pending(0, 10)], [rows[1][0]])
+        self.assertEqual(self.up._outstanding, {rows[1][0]})
+
+        self._send_all()
+        self.assertEqual(self.up.session.sent, [("PATCH", "http://x/cup", {"w": 2})])
+        self.assertEqual(self.spool.count(), 0)
+        self.assertEqual(self.up._outstanding, set())
+
+    def test_older_replayed_row_does_not_overwrite_newer_value(self):
+        self.up.submit("cup", "PATCH", "http://x/cup", {"w": 1}, key="K")
+        self.up.state = CATCHUP
+        self.up.submit("cup", "PATCH", "http://x/cup", {"w": 2}, key="K")
+        old, new = self.spool.pending(0, 10)
+
+        # 큐의 항목을 새 행으로 옮긴 뒤, 옛 행이 다시 재전송돼 들어오는 경우
+        self.up._replay_row(self.ln, new)
+        self.up._outstanding.discard(old[0])
+        self.spool._db.execute(
+            "INSERT INTO spool(id, lane, method, url, payload, key, t) VALUES (?,?,?,?,?,?,0)",
+            (old[0], "cup", "PATCH", "http://x/cup", '{"w":1}', old[5]))
+        self.up._replay_row(self.ln, old)
+
+        self.assertEqual([r[0] for r in self.spool.pending(0, 10)], [new[0]])
+        self._send_all()
+        self.assertEqual(self.up.session.sent, [("PATCH", "http://x/cup", {"w": 2})])
+        self.assertEqual(self.spool.count(), 0)
+
+    def test_row_acked_after_replay_snapshot_is_not_resent(self):
+        self.up.submit("cup", "POST", "http://x/cup", {"w": 1})
+        rows = self.spool.pending(0, 10)        # 재전송기가 잠금 밖에서 읽은 목록
+        self._send_all()                        # 그사이 워커가 보내고 ack
+        self.assertFalse(self.up._replay_row(self.ln, rows[0]))
+        self._send_all()
+        self.assertEqual(len(self.up.session.sent), 1)
+
+    def test_merge_updates_spool_while_holding_lane(self):
+        # 찾기-스풀 갱신-병합 사이에 워커가 항목을 가져가면 새 값의 디스크 사본이 지워짐
+        held = []
+        update = self.spool.update
+
+        def checked_update(*args):
+            held.append(self.ln.cond._is_owned())
+            update(*args)
+
+        self.spool.update = checked_update
+        self.up.submit("cup", "PATCH", "http://x/cup", {"w": 1}, key="K")
+        self.up.submit("cup", "PATCH", "http://x/cup", {"w": 2}, key="K")
+        self.assertEqual(held, [True])
+        self.assertEqual(self.spool.pending(0, 10)[0][4], {"w": 2})
+
+
+if __name__ == "__main__":
+    unittest.main()
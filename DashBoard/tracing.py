@@ -0,0 +1,195 @@
+import collections
+import threading
+import time
+
+from dispatch import MSG_TYPE_FIELD, legacy_type, unpack_batch
+from metrics import TickClock
+
+# 단계 (출력 순서). 값이 없는 단계는 그 경로에 없는 것 (예: 로드셀 직결이면 queue/air 없음)
+#   settle : 무게 변화가 처음 보인 HX711 샘플 "t0" → 안정 판정/레코드 생성 "ts"   (MCU 틱 차)
+#   batch  : 레코드 생성 "ts" → UART 송신 "te" (텔레메트리 배치 대기)          (MCU 틱 차)
+#   queue  : TX 노드 안에서 TDMA 슬롯을 기다린 시간 q                           (게이트웨이 줄머리)
+#   air    : LoRa 공중 시간 air                                                 (게이트웨이 줄머리)
+#   serial : 게이트웨이 수신 rx / 노드 송신 te → 수집기 수신 (최소 지연 대비 추가분, TickClock)
+#   decode : 수집기 수신 → 파싱/디스패치 끝
+#   uplink : 디스패치 끝 → 서버 응답 (레코드가 올린 요청이 모두 끝날 때까지)
+STAGES = ("settle", "batch", "queue", "air", "serial", "decode", "uplink")
+
+# 추적용 필드 (핸들러/서버로는 안 넘어가게 레코드에서 뗌)
+TRACE_FIELDS = ("tr", "t0", "ts", "te")
+
+# 주기 텔레메트리: 펌웨어가 마감 시각(h 60 s, fill 30 s)까지 일부러 모아 보내므로 batch 가 늘 길다
+# → 추적을 만들지 않음 (시계 맞춤/틱 지연 계측에만 씀). 추적 번호 "tr" 이 있으면 그대로 추적
+PERIODIC = ("h", "fill")
+
+
+def _tick(v):
+    return v if isinstance(v, int) and not isinstance(v, bool) else None
+
+
+class Trace:
+    __slots__ = ("key", "stages", "t_rx", "t_dec", "t_ack", "pending", "failed")
+
+    def __init__(self, key, t_rx):
+        self.key = key
+        self.stages = {}
+        self.t_rx = t_rx
+        self.t_dec = None
+        self.t_ack = None
+        self.pending = 0        # 아직 응답 안 온 uplink 요청 수
+        self.failed = False
+
+
+class Tracer:
+    """
+    레코드 하나 = 추적 하나. 펌웨어가 실어 보낸 틱과 수집기 시각을 이어 붙여 단계별 지연을 만듦
+
+        for rec, _ in tracer.records(data, t_rx, source, link):
+            dispatcher.dispatch(rec)
+
+    디스패치 중 uplink.submit 이 불리면 (Uplink(context=tracer.attach)) 그 요청이 끝날 때까지 추적을 열어 둠
+    끝나면 단계별 히스토그램에 넣고, 합계가 slow_s 를 넘으면 단계별 내역을 출력
+    주기 레코드 (PERIODIC) 는 추적 없이 (rec, None) 으로 넘어감
+    ttl 이 지나도 안 끝난 추적 (병합/재전송으로 응답이 안 돌아온 경우)은 unfinished 로 셈
+    """
+
+    def __init__(self, metrics=None, slow_s=2.0, ttl=60.0, keep=200):
+        self.metrics = metrics
+        self.slow_s = slow_s
+        self.ttl = ttl
+        self.clock = TickClock()
+        self.current = None
+        self.open = collections.OrderedDict()   # id -> Trace (수신 순서 = 만료 순서)
+        self.recent = collections.deque(maxlen=keep)
+        self._lock = threading.Lock()
+        if metrics is not None:
+            r = metrics.registry
+            self.h_stage = r.histogram("collector_trace_stage_seconds", "Per-stage latency of finished traces",
+                                       ("stage",))
+            self.h_total = r.histogram("collector_trace_total_seconds", "End-to-end latency of finished traces")
+            self.c_result = r.counter("collector_traces_total", "Traces by outcome", ("result",))
+
+    def records(self, data, t_rx, source, link=None):
+        """
+        패킷 → (레코드, Trace) 목록 (디스패치 동안 current 로 잡혀 있음)
+        link: 게이트웨이 줄머리 값 {"node", "seq", "rx", "q", "air"} (없으면 UART 직결)
+        """
+        self.current = None
+        self.sweep()
+        recs = unpack_batch(data)
+        te_pkt = data.pop("te", None) if len(recs) > 1 or recs[0] is not data else None
+        link = link or {}
+
+        for rec in recs:
+            tr_id, t0, ts, te = (rec.pop(f, None) for f in TRACE_FIELDS)
+            t0, ts, te = _tick(t0), _tick(ts), _tick(te if te is not None else te_pkt)
+
+            serial = None
+            if t_rx is not None:
+                # 게이트웨이를 거치면 게이트웨이 수신 틱 기준, 아니면 노드의 송신 틱 기준
+                # (주기 레코드도 시계 맞춤에는 넣음: 이벤트만으로는 최소 지연 표본이 모자람)
+                if "rx" in link:
+                    serial = self.clock.delay(("rx", source), link["rx"], t_rx)
+                elif te is not None:
+                    serial = self.clock.delay(("te", source), te, t_rx)
+            if ts is not None and self.metrics is not None:
+                self.metrics.observe_tick(source, ts, t_rx)
+
+            if tr_id is None and (rec.get(MSG_TYPE_FIELD) or legacy_type(rec)) in PERIODIC:
+                yield rec, None
+                continue
+
+            if tr_id is not None:
+                key = f"{source}#{tr_id}"
+            elif "seq" in link:
+                key = f"{source}:{link['node']}:{link['seq']}"
+            else:
+                key = None
+            trace = Trace(key, t_rx)
+            st = trace.stages
+            if t0 is not None and ts is not None:
+                st["settle"] = max(0, ts - t0) / 1000.0
+            if ts is not None and te is not None:
+                st["batch"] = max(0, te - ts) / 1000.0
+            if "q" in link:
+                st["queue"] = link["q"] / 1000.0
+            if "air" in link:
+                st["air"] = link["air"] / 1000.0
+            if serial is not None:
+                st["serial"] = serial
+
+            self.current = trace
+            yield rec, trace
+            self.current = None
+            self._decoded(trace)
+
+    def attach(self):
+        """Uplink context: 지금 디스패치 중인 추적에 요청 하나를 붙임"""
+        trace = self.current
+        if trace is not None:
+            with self._lock:
+                trace.pending += 1
+        return trace
+
+    def on_uplink(self, lane, status, latency, ctx):
+        """Uplink observer: 서버 응답 계측 + 그 요청에 실린 추적들 마무리"""
+        if self.metrics is not None:
+            self.metrics.on_uplink(lane, status, latency)
+        now = time.monotonic()
+        for trace in ctx:
+            with self._lock:
+                trace.pending -= 1
+                trace.t_ack = now
+                if status is None or status >= 500:
+                    trace.failed = True
+                done = trace.pending == 0 and trace.t_dec is not None
+            if done:
+                self._finish(trace)
+
+    def _decoded(self, trace):
+        now = time.monotonic()
+        if trace.t_rx is not None:
+            trace.stages["decode"] = now - trace.t_rx
+        with self._lock:
+            trace.t_dec = now
+            done = trace.pending == 0
+            if not done:
+                self.open[id(trace)] = trace
+        if done:
+            self._finish(trace)
+
+    def _finish(self, trace):
+        with self._lock:
+            self.open.pop(id(trace), None)
+        if trace.t_ack is not None:
+            trace.stages["uplink"] = max(0.0, trace.t_ack - trace.t_dec)
+        result = "failed" if trace.failed else "done"
+        total = sum(trace.stages.values())
+        self.recent.append((trace.key, result, dict(trace.stages)))
+
+        if self.metrics is not None:
+            self.c_result.inc(result=result)
+            if not trace.failed:
+                for stage, v in trace.stages.items():
+                    self.h_stage.observe(v, stage=stage)
+                self.h_total.observe(total)
+        if total >= self.slow_s or trace.failed:
+            print(f"[TRACE] {'failed' if trace.failed else 'slow'} {trace.key or '-'}: {self.format(trace.stages)}")
+
+    def sweep(self, now=None):
+        now = time.monotonic() if now is None else now
+        expired = []
+        with self._lock:
+            while self.open:
+                k, trace = next(iter(self.open.items()))
+                if now - trace.t_dec <= self.ttl:
+                    break
+                del self.open[k]
+                expired.append(trace)
+        if expired and self.metrics is not None:
+            self.c_result.inc(len(expired), result="unfinished")
+
+    @staticmethod
+    def format(stages):
+        parts = [f"{s} {stages[s] * 1000:.0f}" for s in STAGES if s in stages]
+        return ", ".join(parts) + f" (total {sum(stages.values()) * 1000:.0f} ms)"
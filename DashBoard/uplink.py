@@ -0,0 +1,397 @@
+import collections
+import json
+import threading
+import time
+
+import requests
+from requests.adapters import HTTPAdapter
+
+# 서버 연결 상태 (스풀을 쓸 때만 의미 있음)
+ONLINE = "online"       # 새 항목은 큐로 바로 (스풀에도 기록)
+OFFLINE = "offline"     # 서버 안 됨: 새 항목은 스풀에만, 가장 오래된 행으로 주기적으로 재시도
+CATCHUP = "catchup"     # 서버 복귀: 밀린 행을 오래된 순으로 제한된 속도로 다시 보냄
+
+PROBE_MIN_S = 1.0       # 오프라인 재시도 간격 (두 배씩 늘림)
+PROBE_MAX_S = 30.0
+COMPACT_EVERY_S = 60.0
+
+
+class _Item:
+    __slots__ = ("method", "url", "payload", "key", "on_done", "t_submit", "sid", "ctx")
+
+    def __init__(self, method, url, payload, key, on_done, t_submit, sid=None, ctx=()):
+        self.method = method
+        self.url = url
+        self.payload = payload
+        self.key = key
+        self.on_done = on_done
+        self.t_submit = t_submit
+        self.sid = sid          # 스풀 행 id (스풀 없으면 None)
+        self.ctx = list(ctx)    # 이 항목에 실린 추적 정보들 (병합되면 같이 합쳐짐)
+
+
+class _Lane:
+    """엔드포인트 하나의 대기 큐 + 전용 워커들"""
+
+    def __init__(self, name, workers, maxlen, batch, timeout, on_done):
+        self.name = name
+        self.workers = workers
+        self.maxlen = maxlen
+        self.batch = batch
+        self.timeout = timeout
+        self.on_done = on_done  # 항목에 콜백이 없을 때 (재전송 항목 등)
+        self.cond = threading.Condition()
+        self.queue = collections.deque()
+        self.pending = {}       # key -> 아직 안 보낸 항목 (병합용)
+        self.busy = set()       # 지금 전송 중인 key (같은 key 순서 보장용)
+        self.in_flight = 0
+        self.stats = collections.Counter()
+
+
+class Uplink:
+    """
+    서버 업로드 전용 백그라운드 전송기
+
+    - 시리얼 루프는 submit() 으로 큐에 넣기만 하고 바로 돌아감 (서버가 느려도 안 막힘)
+    - 엔드포인트마다 lane(큐 + 워커 스레드)을 따로 두어 느린 쪽이 빠른 쪽을 막지 않음
+    - 모든 워커가 Session 하나의 keep-alive 연결 풀을 같이 씀
+    - 같은 key 로 아직 안 보낸 항목이 있으면 새 값으로 덮어씀 (PATCH 는 최신 값만 의미 있음)
+    - 워커는 깨어날 때마다 최대 batch 개를 한꺼번에 꺼내서 연달아 보냄
+    - 큐가 가득 차면 가장 오래된 항목을 버림 (dropped 로 집계)
+
+    spool 을 주면 모든 항목을 보내기 전에 디스크에 기록하고, 서버가 받으면(2xx/4xx) 지움
+    - 연결 실패/타임아웃/5xx 는 스풀에 남기고 OFFLINE → 새 항목도 스풀에만 쌓음
+    - 복귀하면 CATCHUP: 밀린 행을 오래된 순으로 초당 replay_rate 건씩 다시 큐에 넣음
+      (밀린 게 다 빠질 때까지 새 항목도 스풀 뒤에 줄 세움 → 같은 key 의 옛 값이 새 값을 덮지 않음)
+    - 큐가 차서 밀려난 항목도 스풀에는 남아 있으므로 CATCHUP 으로 다시 보냄
+    """
+
+    def __init__(self, spool=None, replay_rate=50.0, observer=None, context=None):
+        self.lanes = {}
+        self.observer = observer            # observer(lane, status, 지연 s, ctx 목록) - 계측용 (status 없으면 None)
+        self.context = context              # submit 때 불러서 항목에 실을 추적 정보 (None 이면 안 실음)
+        self.session = None
+        self.spool = spool
+        self.replay_rate = replay_rate
+        self.state = ONLINE
+        self._lock = threading.Lock()       # state, _outstanding 보호 (lane.cond 보다 먼저 잡음)
+        self._outstanding = set()           # 큐에 있거나 전송 중인 스풀 행 id
+        self._wake = threading.Event()
+        self._threads = []
+        self._stop = False
+
+    def add_lane(self, name, workers=1, maxlen=1000, batch=16, timeout=5, on_done=None):
+        self.lanes[name] = _Lane(name, workers, maxlen, batch, timeout, on_done)
+
+    def start(self):
+        total = sum(ln.workers for ln in self.lanes.values())
+        self.session = requests.Session()
+        adapter = HTTPAdapter(pool_connections=max(1, len(self.lanes)),
+                              pool_maxsize=max(1, total + 1))
+        self.session.mount("http://", adapter)
+        self.session.mount("https://", adapter)
+
+        for ln in self.lanes.values():
+            for i in range(ln.workers):
+                self._spawn(self._worker, f"uplink-{ln.name}-{i}", ln)
+
+        if self.spool is not None:
+            # 지난번에 못 보낸 게 남아 있으면 그것부터
+            if self.spool.count() > 0:
+                self.state = CATCHUP
+            self._spawn(self._replayer, "uplink-replay")
+
+    def _spawn(self, fn, name, *args):
+        t = threading.Thread(target=fn, args=args, name=name, daemon=True)
+        t.start()
+        self._threads.append(t)
+
+    def submit(self, lane, method, url, payload, key=None, on_done=None):
+        """
+        전송 예약. 시리얼 스레드에서 불러도 서버를 기다리지 않음 (스풀 기록만 동기)
+        on_done(resp, err) 은 워커 스레드에서 호출 (resp 는 실패 시 None)
+        """
+        ln = self.lanes[lane]
+        now = time.monotonic()
+        # key 는 스풀에 저장되는 문자열 형태로 통일 (튜플/리스트 구분 없음)
+        key = None if key is None else json.dumps(key)
+        with self._lock:
+            if self.spool is None:
+                self._enqueue(ln, _Item(method, url, payload, key, on_done, now, ctx=self._ctx()))
+                return
+
+            if self.state != ONLINE:
+                self.spool.put(lane, method, url, payload, key, time.time(), self._outstanding)
+                ln.stats["spooled"] += 1
+                return
+
+            # 큐에서 병합되면 그 항목의 스풀 행을 갱신, 아니면 새 행
+            # (찾기-갱신-병합을 ln.cond 한 번에: 그 사이 워커가 옛 값을 보내고 행을 지우면 새 값이 디스크에서 사라짐)
+            with ln.cond:
+                item = ln.pending.get(key) if key is not None else None
+                if item is not None:
+                    self.spool.update(item.sid, method, url, payload)
+                    self._enqueue(ln, _Item(method, url, payload, key, on_done, now, item.sid, self._ctx()))
+                    return
+
+            sid = self.spool.put(lane, method, url, payload, key, time.time(), self._outstanding)
+            self._outstanding.add(sid)
+            self._enqueue(ln, _Item(method, url, payload, key, on_done, now, sid, self._ctx()))
+
+    def _ctx(self):
+        # 큐로 가는 항목에만 (스풀에만 쌓는 항목은 나중에 재전송될 때 추적 정보 없음)
+        c = self.context() if self.context is not None else None
+        return () if c is None else (c,)
+
+    # self._lock 잡은 상태에서 호출
+    def _enqueue(self, ln, new):
+        with ln.cond:
+            if new.key is not None:
+                item = ln.pending.get(new.key)
+                if item is not None:
+                    if new.sid is not None and item.sid is not None and new.sid != item.sid:
+                        # 스풀 행이 다른 두 항목 (재전송 행이 대기 중인 항목과 만날 때):
+                        # 나중 행(더 새 값)만 남기고 덮인 행은 ack, 아니면 영영 스풀에 남음
+                        if new.sid < item.sid:
+                            self._drop_row(new.sid)
+                            ln.stats["coalesced"] += 1
+                            return
+                        self._drop_row(item.sid)
+                        item.sid = new.sid
+                    item.method = new.method
+                    item.url = new.url
+                    item.payload = new.payload
+                    item.on_done = new.on_done or item.on_done
+                    item.ctx.extend(new.ctx)    # 새 값이 나가면 덮인 옛 값도 전달된 셈
+                    ln.stats["coalesced"] += 1
+                    return
+
+            if len(ln.queue) >= ln.maxlen:
+                old = ln.queue.popleft()
+                if old.key is not None:
+                    ln.pending.pop(old.key, None)
+                if old.sid is not None:
+                    # 스풀에는 남아 있으므로 나중에 CATCHUP 으로 다시 보냄
+                    self._outstanding.discard(old.sid)
+                    self.state = CATCHUP
+                    self._wake.set()
+                    ln.stats["spilled"] += 1
+                else:
+                    ln.stats["dropped"] += 1
+
+            ln.queue.append(new)
+            if new.key is not None:
+                ln.pending[new.key] = new
+            ln.stats["queued"] += 1
+            ln.cond.notify()
+
+    # self._lock 잡은 상태에서 호출
+    def _drop_row(self, sid):
+        self.spool.ack(sid)
+        self._outstanding.discard(sid)
+
+    def depth(self, lane=None):
+        if lane is not None:
+            return len(self.lanes[lane].queue)
+        return sum(len(ln.queue) for ln in self.lanes.values())
+
+    def stats(self):
+        out = {}
+        for ln in self.lanes.values():
+            with ln.cond:
+                s = dict(ln.stats)
+                s["depth"] = len(ln.queue)
+                s["in_flight"] = ln.in_flight
+            out[ln.name] = s
+        return out
+
+    def flush(self, timeout=10.0):
+        """큐(와 스풀)가 빌 때까지 기다림 (종료 직전용). 다 비우면 True"""
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            if all(not ln.queue and ln.in_flight == 0 for ln in self.lanes.values()) and \
+               (self.spool is None or self.spool.count() == 0):
+                return True
+            time.sleep(0.05)
+        return False
+
+    def close(self, timeout=10.0):
+        self.flush(timeout)
+        self._stop = True
+        self._wake.set()
+        for ln in self.lanes.values():
+            with ln.cond:
+                ln.cond.notify_all()
+        if self.session is not None:
+            self.session.close()
+
+    def _take(self, ln):
+        # 전송 중인 key 와 같은 항목은 건너뜀 (오래된 값이 새 값을 덮어쓰지 않게)
+        batch = []
+        skipped = []
+        while ln.queue and len(batch) < ln.batch:
+            it = ln.queue.popleft()
+            if it.key is not None and it.key in ln.busy:
+                skipped.append(it)
+                continue
+            if it.key is not None:
+                ln.pending.pop(it.key, None)
+                ln.busy.add(it.key)
+            batch.append(it)
+        ln.queue.extendleft(reversed(skipped))
+        return batch
+
+    def _worker(self, ln):
+        while True:
+            with ln.cond:
+                batch = self._take(ln)
+                while not batch and not self._stop:
+                    ln.cond.wait()
+                    batch = self._take(ln)
+                if not batch:
+                    return
+                ln.in_flight += len(batch)
+
+            for it in batch:
+                self._send(ln, it)
+
+            with ln.cond:
+                ln.in_flight -= len(batch)
+                for it in batch:
+                    if it.key is not None:
+                        ln.busy.discard(it.key)
+                # 건너뛰었던 같은 key 항목을 다른 워커가 가져갈 수 있게
+                ln.cond.notify_all()
+
+    def _send(self, ln, it):
+        resp, err = None, None
+        try:
+            resp = self.session.request(it.method, it.url, json=it.payload, timeout=ln.timeout)
+        except requests.exceptions.RequestException as e:
+            err = e
+
+        # 4xx 는 서버가 받고 거절한 것 → 다시 보내도 같으므로 ack
+        delivered = resp is not None and resp.status_code < 500
+        with ln.cond:
+            ln.stats[f"http_{resp.status_code}" if resp is not None else "http_error"] += 1
+            ln.stats["sent" if delivered else "failed"] += 1
+        if self.observer is not None:
+            self.observer(ln.name, resp.status_code if resp is not None else None,
+                          time.monotonic() - it.t_submit, it.ctx)
+
+        if it.sid is not None:
+            with self._lock:
+                self._outstanding.discard(it.sid)
+                if not delivered and it.key is not None:
+                    # 같은 key 의 새 값이 이미 큐에 있으면 이 행은 필요 없음 (나중에 옛 값으로 덮지 않게)
+                    with ln.cond:
+                        if it.key in ln.pending:
+                            delivered = True
+                if delivered:
+                    self.spool.ack(it.sid)
+                elif self.state != OFFLINE:
+                    self.state = OFFLINE
+                    self._wake.set()
+
+        on_done = it.on_done or ln.on_done
+        if on_done is not None:
+            try:
+                on_done(resp, err)
+            except Exception as e:
+                print(f"[ERROR] uplink {ln.name} callback: {e}")
+
+    def _probe(self, row):
+        # 오프라인 중 가장 오래된 행 하나를 직접 보내 봄
+        sid, lane, method, url, payload, _ = row
+        ln = self.lanes.get(lane)
+        try:
+            resp = self.session.request(method, url, json=payload,
+                                        timeout=ln.timeout if ln else 5)
+        except requests.exceptions.RequestException:
+            return False
+        if ln is not None:
+            with ln.cond:
+                ln.stats[f"http_{resp.status_code}"] += 1
+        if resp.status_code >= 500:
+            return False
+        with self._lock:
+            self.spool.ack(sid)
+        if ln is not None and ln.on_done is not None:
+            try:
+                ln.on_done(resp, None)
+            except Exception as e:
+                print(f"[ERROR] uplink {lane} callback: {e}")
+        return True
+
+    def _replayer(self):
+        backoff = PROBE_MIN_S
+        cursor = 0                      # 이번 바퀴에서 어디까지 다시 넣었는지 (행 id)
+        last_compact = time.monotonic()
+
+        while not self._stop:
+            if time.monotonic() - last_compact > COMPACT_EVERY_S:
+                self.spool.compact()
+                last_compact = time.monotonic()
+
+            if self.state == ONLINE:
+                self._wake.wait(1.0)
+                self._wake.clear()
+                cursor = 0
+                continue
+
+            if self.state == OFFLINE:
+                cursor = 0
+                with self._lock:
+                    rows = [r for r in self.spool.pending(0, 64) if r[0] not in self._outstanding]
+                if rows and not self._probe(rows[0]):
+                    print(f"[UPLINK] server down, {self.spool.count()} spooled, retry in {backoff:.0f}s")
+                    self._wake.wait(backoff)
+                    self._wake.clear()
+                    backoff = min(backoff * 2, PROBE_MAX_S)
+                    continue
+                backoff = PROBE_MIN_S
+                with self._lock:
+                    if self.state == OFFLINE:
+                        self.state = CATCHUP
+                print(f"[UPLINK] server back, replaying {self.spool.count()} spooled")
+                continue
+
+            # CATCHUP: 오래된 순으로 초당 replay_rate 건
+            rows = self.spool.pending(cursor, 64)
+            if not rows:
+                # 한 바퀴 끝: 큐에도 없고 전송 중도 아닌 행이 더 없으면 실시간 전송으로 복귀
+                # (이미 큐에 들어간 행은 lane FIFO 라 새 항목보다 먼저 나감)
+                with self._lock:
+                    left = [r for r in self.spool.pending(0, 1024) if r[0] not in self._outstanding]
+                    if not left and self.state == CATCHUP:
+                        self.state = ONLINE
+                        print("[UPLINK] backlog drained")
+                cursor = 0
+                self._wake.wait(0.2)
+                self._wake.clear()
+                continue
+
+            for row in rows:
+                if self._stop or self.state != CATCHUP:
+                    break
+                cursor = row[0]
+                ln = self.lanes.get(row[1])
+                if ln is None:
+                    continue
+                # 큐가 반 이상 차 있으면 비워질 때까지 (밀어내기 반복 방지)
+                while len(ln.queue) > ln.maxlen // 2 and not self._stop and self.state == CATCHUP:
+                    time.sleep(0.05)
+                if self._replay_row(ln, row):
+                    time.sleep(1.0 / self.replay_rate)
+
+    def _replay_row(self, ln, row):
+        """스풀 행 하나를 다시 큐에 (이미 큐/전송 중이거나 그새 ack 됐으면 False)"""
+        sid, _, method, url, payload, key = row
+        with self._lock:
+            # row 는 잠금 밖에서 읽은 것이라, 그 사이 전송이 끝나 지워졌을 수 있음 (중복 전송 방지)
+            if sid in self._outstanding or not self.spool.exists(sid):
+                return False
+            self._outstanding.add(sid)
+            self._enqueue(ln, _Item(method, url, payload, key, None, time.monotonic(), sid))
+            ln.stats["replayed"] += 1
+        return True
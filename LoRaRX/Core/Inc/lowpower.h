@@ -0,0 +1,28 @@
+#ifndef INC_LOWPOWER_H_
+#define INC_LOWPOWER_H_
+
+#include <stdint.h>
+
+// 배터리 수신기용 MCU 저전력 (STOP 모드)
+//
+// 메인 루프에서 할 일이 없을 때 LowPower_Enter() 를 부르면
+// 다음 타이머 만료까지 STOP 모드로 내려가고, RTC 웨이크업 타이머 또는
+// 라디오 DIO(EXTI) 인터럽트로 깨어남
+//   - STOP 중에는 SysTick 이 멈추므로 깨어난 뒤 RTC 로 잰 시간만큼 틱을 보정
+//   - STOP 중에는 TIM2 PWM(서보)도 멈춤 → 서보 유지 토크가 필요한 보드에서는 쓰지 말 것
+//
+// RTC 클럭은 LSE(32.768kHz), LSE 가 안 뜨면 LSI 로 대체 (오차 큼)
+
+#define LOWPOWER_MIN_STOP_MS    3       // 이보다 짧으면 STOP 대신 SLEEP (복귀 비용이 더 큼)
+#define LOWPOWER_MAX_STOP_MS    30000   // 웨이크업 타이머 최대값 (16비트 @ 2kHz) 이내
+
+// RTC 클럭/웨이크업 타이머 설정
+void LowPower_Init(void);
+
+// 다음 타이머 이벤트 또는 인터럽트까지 대기 (STOP 또는 SLEEP)
+void LowPower_Enter(void);
+
+// RTC_WKUP_IRQHandler 에서 호출
+void LowPower_WakeupIrq(void);
+
+#endif /* INC_LOWPOWER_H_ */
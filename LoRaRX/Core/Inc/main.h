@@ -49,6 +49,30 @@ extern SPI_HandleTypeDef hspi1;
 #define LORA_SYMBOL_TIMEOUT                         5         // Symbols
 #define LORA_FIX_LENGTH_PAYLOAD_ON                  false
 #define LORA_IQ_INVERSION_ON                        false
+#define LORA_TX_OUTPUT_POWER                        14        // dBm (비콘 송신용)
+#define LORA_TX_TIMEOUT                             3000      // ms
+
+// TDMA 게이트웨이 (1: 비콘 방송 + 슬롯 배정, 0: 기존 연속 수신만)
+#define TDMA_GATEWAY_ENABLE                         1
+#define TDMA_NUM_SLOTS                              24        // 배정할 업링크 슬롯 수
+
+#define AIRTIME_STATS_PERIOD_MS                     60000     // 송신 시간 카운터 출력 주기
+
+// 수신 듀티 사이클 (sniff, 배터리 수신기용)
+// 1: 짧은 수신 창 → 프리앰블 없으면 라디오 슬립 + MCU STOP 반복, 0: 연속 수신
+// TDMA 게이트웨이/서보 보드는 상시 전원이므로 0 (STOP 중에는 서보 PWM 도 멈춤)
+#define LORA_RX_DUTY_CYCLE_ON                       0
+#define LORA_RX_WINDOW_MS                           12        // 수신 창 (SF7/125kHz 기준 약 12 심볼)
+#define LORA_RX_SLEEP_MS                            200       // 창 사이 슬립
+
+// 송신측 프리앰블은 슬립+창 전체를 덮어야 어느 창에서든 잡힘 (TX 보드와 동일해야 함)
+#define LORA_SYMBOL_US                              ( ( 1000000UL << LORA_SPREADING_FACTOR ) / ( 125000UL << LORA_BANDWIDTH ) )
+#define LORA_WOR_PREAMBLE_LENGTH                    ( ( LORA_RX_SLEEP_MS + LORA_RX_WINDOW_MS ) * 1000UL / LORA_SYMBOL_US + LORA_PREAMBLE_LENGTH )
+#if LORA_RX_DUTY_CYCLE_ON
+#define LORA_LINK_PREAMBLE_LENGTH                   LORA_WOR_PREAMBLE_LENGTH
+#else
+#define LORA_LINK_PREAMBLE_LENGTH                   LORA_PREAMBLE_LENGTH
+#endif
 /* USER CODE END EC */
 
 /* Exported macro ------------------------------------------------------------*/
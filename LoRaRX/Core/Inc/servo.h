@@ -0,0 +1,55 @@
+#ifndef INC_SERVO_H_
+#define INC_SERVO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+
+// 서보 모션 (TIM2 CH2, PA1)
+//
+// 무선 'M' 패킷 → 명령 큐 → PWM 주기(20ms)마다 TIM2 업데이트 인터럽트에서
+// 사다리꼴 속도 프로파일로 다음 위치를 계산해 CCR 갱신
+//   - TIM2 는 1MHz 카운트 (PSC 83), 주기 20000 → CCR = 펄스폭 [us]
+//   - 메인 루프/라디오 경로는 큐에 넣기만 하고 절대 기다리지 않음
+//
+// 패킷 형식 (ASCII):  M<각도>[,<속도>[,<대기>]]
+//   각도: 0~180 [deg], 속도: 최대 속도 [deg/s], 대기: 도착 후 머무는 시간 [ms]
+//   예) "M90"  "M180,120"  "M0,60,1000"
+//   "MS" : 큐 비우고 그 자리에서 감속 정지
+
+#define SERVO_PERIOD_US         20000   // PWM 주기 (50Hz)
+#define SERVO_MIN_PULSE_US      500     // 0도
+#define SERVO_MAX_PULSE_US      2500    // 180도
+#define SERVO_MAX_ANGLE         180
+
+#define SERVO_DEFAULT_SPEED     90      // deg/s (패킷에 속도가 없을 때)
+#define SERVO_MAX_SPEED         360     // deg/s
+#define SERVO_ACCEL             360     // deg/s^2 (가감속)
+#define SERVO_QUEUE_LEN         8       // 명령 큐 길이
+
+typedef struct {
+    int16_t  angle;     // 목표 각도 [deg]
+    uint16_t speed;     // 최대 속도 [deg/s]
+    uint16_t dwell;     // 도착 후 대기 [ms]
+} Servo_Command_t;
+
+// 초기 위치로 PWM 시작 + 업데이트 인터럽트 시작
+void Servo_Init(TIM_HandleTypeDef *htim, uint32_t channel, int16_t angle);
+
+// 명령 추가 (큐가 차면 false)
+bool Servo_Queue(const Servo_Command_t *cmd);
+
+// 'M' 패킷 해석 후 큐에 추가 (형식이 틀리거나 큐가 차면 false)
+bool Servo_HandlePacket(const uint8_t *payload, uint16_t size);
+
+// 큐 비우고 현재 속도에서 감속 정지
+void Servo_Stop(void);
+
+// HAL_TIM_PeriodElapsedCallback 에서 호출 (PWM 주기마다)
+void Servo_OnPeriod(void);
+
+// 현재 각도 [deg], 움직이는 중/큐 대기 여부
+int16_t Servo_GetAngle(void);
+bool Servo_IsBusy(void);
+
+#endif /* INC_SERVO_H_ */
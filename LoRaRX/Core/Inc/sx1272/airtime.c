@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <string.h>
+#include "airtime.h"
+#include "timer.h"
+#include "main.h"
+
+#define AIRTIME_BUCKET_MS   ( AIRTIME_WINDOW_MS / AIRTIME_BUCKETS )
+
+// 칸별 송신 시간 링버퍼 (가장 오래된 칸부터 덮어씀)
+static uint32_t Buckets[AIRTIME_BUCKETS];
+static uint32_t BucketIdx = 0;
+static uint32_t BucketStart = 0;
+static uint32_t WindowSum = 0;
+
+static AirtimeStats_t Stats;
+
+/*!
+ * \brief 현재 시각까지 지난 칸들을 비우고 윈도를 앞으로 당김
+ */
+static void AirtimeAdvance( void )
+{
+    uint32_t now = TimerGetCurrentTime( );
+    uint32_t elapsed = now - BucketStart;
+
+    if( elapsed < AIRTIME_BUCKET_MS )
+    {
+        return;
+    }
+
+    uint32_t steps = elapsed / AIRTIME_BUCKET_MS;
+    if( steps >= AIRTIME_BUCKETS )
+    {
+        // 윈도 전체가 지나감
+        memset( Buckets, 0, sizeof( Buckets ) );
+        WindowSum = 0;
+    }
+    else
+    {
+        for( uint32_t i = 0; i < steps; i++ )
+        {
+            BucketIdx = ( BucketIdx + 1 ) % AIRTIME_BUCKETS;
+            WindowSum -= Buckets[BucketIdx];
+            Buckets[BucketIdx] = 0;
+        }
+    }
+    BucketStart += steps * AIRTIME_BUCKET_MS;
+}
+
+void AirtimeRecord( uint32_t ms )
+{
+    __disable_irq( );
+    AirtimeAdvance( );
+    Buckets[BucketIdx] += ms;
+    WindowSum += ms;
+    Stats.Packets++;
+    Stats.TotalMs += ms;
+    __enable_irq( );
+}
+
+uint32_t AirtimeGetUsed( void )
+{
+    __disable_irq( );
+    AirtimeAdvance( );
+    uint32_t used = WindowSum;
+    __enable_irq( );
+    return used;
+}
+
+uint32_t AirtimeGetRemaining( void )
+{
+    uint32_t used = AirtimeGetUsed( );
+    return ( used >= AIRTIME_BUDGET_MS ) ? 0 : ( AIRTIME_BUDGET_MS - used );
+}
+
+AirtimeLevel_t AirtimeGetLevel( void )
+{
+    uint32_t permille = ( uint32_t )( ( ( uint64_t )AirtimeGetUsed( ) * 1000u ) / AIRTIME_BUDGET_MS );
+
+    if( permille < 500 ) return AIRTIME_LEVEL_OK;
+    if( permille < 800 ) return AIRTIME_LEVEL_COALESCE;
+    if( permille < 950 ) return AIRTIME_LEVEL_DEGRADE;
+    return AIRTIME_LEVEL_HOLD;
+}
+
+AirtimeVerdict_t AirtimeAdmit( AirtimeClass_t cls, uint32_t ms )
+{
+    AirtimeVerdict_t verdict = AIRTIME_SEND;
+    AirtimeLevel_t level = AirtimeGetLevel( );
+
+    if( ms > AirtimeGetRemaining( ) )
+    {
+        // 예산 초과: 이벤트/제어는 기다렸다 보내고 나머지는 버림
+        verdict = ( cls <= AIRTIME_CLASS_CONTROL ) ? AIRTIME_DEFER : AIRTIME_DROP;
+    }
+    else
+    {
+        switch( cls )
+        {
+        case AIRTIME_CLASS_EVENT:
+            break;
+        case AIRTIME_CLASS_CONTROL:
+            if( level >= AIRTIME_LEVEL_HOLD ) verdict = AIRTIME_DEFER;
+            break;
+        case AIRTIME_CLASS_PERIODIC:
+            if( level >= AIRTIME_LEVEL_HOLD ) verdict = AIRTIME_DROP;
+            else if( level >= AIRTIME_LEVEL_COALESCE ) verdict = AIRTIME_DEFER;
+            break;
+        case AIRTIME_CLASS_RAW:
+        default:
+            if( level >= AIRTIME_LEVEL_DEGRADE ) verdict = AIRTIME_DROP;
+            break;
+        }
+    }
+
+    if( verdict == AIRTIME_DEFER ) Stats.Deferred++;
+    if( verdict == AIRTIME_DROP ) Stats.Dropped++;
+    return verdict;
+}
+
+void AirtimeGetStats( AirtimeStats_t *stats )
+{
+    __disable_irq( );
+    *stats = Stats;
+    __enable_irq( );
+}
+
+void AirtimePrintStats( void )
+{
+    AirtimeStats_t s;
+    AirtimeGetStats( &s );
+
+    printf( "{\"m\":\"airtime\",\"airtime\":{\"usedMs\":%lu,\"budgetMs\":%lu,\"level\":%d,"
+            "\"pkts\":%lu,\"totalMs\":%lu,\"deferred\":%lu,\"dropped\":%lu}}\r\n",
+            ( unsigned long )AirtimeGetUsed( ), ( unsigned long )AIRTIME_BUDGET_MS,
+            ( int )AirtimeGetLevel( ),
+            ( unsigned long )s.Packets, ( unsigned long )s.TotalMs,
+            ( unsigned long )s.Deferred, ( unsigned long )s.Dropped );
+}
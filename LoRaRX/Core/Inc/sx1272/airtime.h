@@ -0,0 +1,106 @@
+#ifndef __AIRTIME_H__
+#define __AIRTIME_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * 920MHz 대역 송신 시간(duty-cycle) 예산
+ *
+ * SX1272Send 가 보낸 패킷마다 SX1272GetTimeOnAir 를 누적해서
+ * AIRTIME_WINDOW_MS 슬라이딩 윈도 안에서 AIRTIME_DUTY_PERMILLE 를 넘지 않게 관리
+ */
+#define AIRTIME_WINDOW_MS           3600000u  // 윈도 길이 (1시간)
+#define AIRTIME_BUCKETS             60u       // 윈도를 나누는 칸 수 (1분 단위)
+#define AIRTIME_DUTY_PERMILLE       100u      // 허용 송신 비율 (100 = 10%)
+#define AIRTIME_BUDGET_MS           ( AIRTIME_WINDOW_MS / 1000u * AIRTIME_DUTY_PERMILLE )
+
+/*!
+ * 예산 사용률에 따른 송신 정책 단계
+ */
+typedef enum
+{
+    AIRTIME_LEVEL_OK = 0,       //!< < 50%  : 그대로 송신
+    AIRTIME_LEVEL_COALESCE,     //!< < 80%  : 주기 데이터는 최신값만 합쳐서 송신
+    AIRTIME_LEVEL_DEGRADE,      //!< < 95%  : 원시 스트림 드롭, 압축(요약) 포맷만
+    AIRTIME_LEVEL_HOLD,         //!< >= 95% : 이벤트 외 송신 보류
+}AirtimeLevel_t;
+
+/*!
+ * 송신 데이터 종류
+ */
+typedef enum
+{
+    AIRTIME_CLASS_EVENT = 0,    //!< 무게 이벤트 등 긴급 (예산이 있으면 항상 송신)
+    AIRTIME_CLASS_CONTROL,      //!< 비콘 등 제어 프레임
+    AIRTIME_CLASS_PERIODIC,     //!< 헬스/채움률 등 주기 데이터
+    AIRTIME_CLASS_RAW,          //!< 레이저 원시 샘플 등 대용량 스트림
+}AirtimeClass_t;
+
+/*!
+ * 송신 판정 결과
+ */
+typedef enum
+{
+    AIRTIME_SEND = 0,           //!< 지금 송신
+    AIRTIME_DEFER,              //!< 보류 (최신값으로 덮어쓰며 대기)
+    AIRTIME_DROP,               //!< 버림
+}AirtimeVerdict_t;
+
+typedef struct
+{
+    uint32_t Packets;           //!< 송신 패킷 수
+    uint32_t TotalMs;           //!< 누적 송신 시간 (ms)
+    uint32_t Deferred;          //!< 보류 판정 수
+    uint32_t Dropped;           //!< 드롭 판정 수
+}AirtimeStats_t;
+
+/*!
+ * \brief 송신 1건 기록 (SX1272Send 에서 호출)
+ *
+ * \param [IN] ms  패킷 TimeOnAir [ms]
+ */
+void AirtimeRecord( uint32_t ms );
+
+/*!
+ * \retval 윈도 안에서 사용한 송신 시간 [ms]
+ */
+uint32_t AirtimeGetUsed( void );
+
+/*!
+ * \retval 남은 송신 시간 예산 [ms]
+ */
+uint32_t AirtimeGetRemaining( void );
+
+/*!
+ * \retval 현재 정책 단계
+ */
+AirtimeLevel_t AirtimeGetLevel( void );
+
+/*!
+ * \brief 송신 전에 호출해서 보낼지/미룰지/버릴지 결정
+ *
+ * \param [IN] cls  데이터 종류
+ * \param [IN] ms   보낼 패킷의 TimeOnAir [ms]
+ */
+AirtimeVerdict_t AirtimeAdmit( AirtimeClass_t cls, uint32_t ms );
+
+/*!
+ * \brief 카운터 조회
+ */
+void AirtimeGetStats( AirtimeStats_t *stats );
+
+/*!
+ * \brief 디버그 UART 로 카운터 한 줄 출력 (JSON)
+ */
+void AirtimePrintStats( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __AIRTIME_H__
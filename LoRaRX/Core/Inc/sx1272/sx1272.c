@@ -29,6 +29,7 @@
 #include "radio.h"
 #include "sx1272.h"
 #include "sx1272-board.h"
+#include "airtime.h"
 
 /*
  * Local types definition
@@ -127,6 +128,16 @@ void SX1272OnDio5Irq( void* context );
  */
 void SX1272OnTimeoutIrq( void* context );
 
+/*!
+ * \brief Rx duty cycle sleep timer callback (opens the next reception window)
+ */
+static void SX1272OnRxDutyCycleIrq( void* context );
+
+/*!
+ * \brief Leaves the Rx duty cycle mode and restores the reception settings
+ */
+static void SX1272RxDutyCycleStop( void );
+
 /*
  * Private global constants
  */
@@ -212,6 +223,20 @@ TimerEvent_t TxTimeoutTimer;
 TimerEvent_t RxTimeoutTimer;
 TimerEvent_t RxTimeoutSyncWord;
 
+/*!
+ * Rx duty cycle (sniff) timer and state
+ */
+TimerEvent_t RxDutyCycleTimer;
+
+static struct
+{
+    bool     On;            //!< 듀티 사이클 수신 중
+    bool     Opening;       //!< 내부에서 수신 창을 여는 중 (SX1272SetRx 가 모드를 끄지 않도록)
+    bool     RxContinuous;  //!< 진입 전 연속 수신 설정 (종료 시 복원)
+    uint16_t SymbTimeout;   //!< 진입 전 SymbTimeout 레지스터 값 (종료 시 복원)
+    uint32_t SleepTime;     //!< 창 사이 슬립 시간 [ms]
+}RxDutyCycle;
+
 /*
  * Radio driver functions implementation
  */
@@ -226,6 +251,7 @@ void SX1272Init( RadioEvents_t *events )
     TimerInit( &TxTimeoutTimer, SX1272OnTimeoutIrq );
     TimerInit( &RxTimeoutTimer, SX1272OnTimeoutIrq );
     TimerInit( &RxTimeoutSyncWord, SX1272OnTimeoutIrq );
+    TimerInit( &RxDutyCycleTimer, SX1272OnRxDutyCycleIrq );
 
     SX1272Reset( );
 
@@ -673,6 +699,11 @@ void SX1272Send( uint8_t *buffer, uint8_t size )
 {
     uint32_t txTimeout = 0;
 
+    SX1272RxDutyCycleStop( );
+
+    // 송신 시간 예산 장부에 기록
+    AirtimeRecord( SX1272GetTimeOnAir( SX1272.Settings.Modem, size ) );
+
     switch( SX1272.Settings.Modem )
     {
     case MODEM_FSK:
@@ -745,6 +776,7 @@ void SX1272Send( uint8_t *buffer, uint8_t size )
 
 void SX1272SetSleep( void )
 {
+    SX1272RxDutyCycleStop( );
     TimerStop( &RxTimeoutTimer );
     TimerStop( &TxTimeoutTimer );
 
@@ -758,6 +790,7 @@ void SX1272SetSleep( void )
 
 void SX1272SetStby( void )
 {
+    SX1272RxDutyCycleStop( );
     TimerStop( &RxTimeoutTimer );
     TimerStop( &TxTimeoutTimer );
 
@@ -768,6 +801,11 @@ void SX1272SetStby( void )
 void SX1272SetRx( uint32_t timeout )
 {
     bool rxContinuous = false;
+
+    if( RxDutyCycle.Opening == false )
+    {
+        SX1272RxDutyCycleStop( );
+    }
     TimerStop( &TxTimeoutTimer );
 
     switch( SX1272.Settings.Modem )
@@ -882,6 +920,76 @@ void SX1272SetRx( uint32_t timeout )
     }
 }
 
+void SX1272SetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime )
+{
+    if( SX1272.Settings.Modem != MODEM_LORA )
+    {
+        // 프리앰블 검출로 창이 연장되는 건 LoRa 모뎀만 가능 → 연속 수신으로 대체
+        SX1272SetRx( 0 );
+        return;
+    }
+
+    SX1272RxDutyCycleStop( );
+
+    // 수신 창을 심볼 단위 SymbTimeout 으로 환산 (단일 수신 모드에서 이 안에
+    // 프리앰블이 안 잡히면 DIO1 RxTimeout, 잡히면 RxDone 까지 계속 수신)
+    uint32_t bandwidth = 125000u << SX1272.Settings.LoRa.Bandwidth;
+    uint32_t symbolUs = ( uint32_t )( ( 1000000ull << SX1272.Settings.LoRa.Datarate ) / bandwidth );
+    uint32_t symbols = ( rxTime * 1000u + symbolUs - 1 ) / symbolUs;
+
+    if( symbols < 4 )
+    {
+        symbols = 4;        // 프리앰블 검출에 필요한 최소 심볼
+    }
+    else if( symbols > 0x3FF )
+    {
+        symbols = 0x3FF;    // 레지스터 10비트
+    }
+
+    RxDutyCycle.SymbTimeout = ( ( SX1272Read( REG_LR_MODEMCONFIG2 ) & ~RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) << 8 ) |
+                              SX1272Read( REG_LR_SYMBTIMEOUTLSB );
+    SX1272Write( REG_LR_MODEMCONFIG2,
+                 ( SX1272Read( REG_LR_MODEMCONFIG2 ) & RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) |
+                 ( ( symbols >> 8 ) & ~RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) );
+    SX1272Write( REG_LR_SYMBTIMEOUTLSB, ( uint8_t )( symbols & 0xFF ) );
+
+    RxDutyCycle.RxContinuous = SX1272.Settings.LoRa.RxContinuous;
+    SX1272.Settings.LoRa.RxContinuous = false;
+    RxDutyCycle.SleepTime = sleepTime;
+    RxDutyCycle.On = true;
+
+    SX1272OnRxDutyCycleIrq( NULL );
+}
+
+static void SX1272OnRxDutyCycleIrq( void* context )
+{
+    if( RxDutyCycle.On == false )
+    {
+        return;
+    }
+
+    // 슬립에서 바로 단일 수신 창 열기
+    RxDutyCycle.Opening = true;
+    SX1272SetRx( 0 );
+    RxDutyCycle.Opening = false;
+}
+
+static void SX1272RxDutyCycleStop( void )
+{
+    if( RxDutyCycle.On == false )
+    {
+        return;
+    }
+    RxDutyCycle.On = false;
+    TimerStop( &RxDutyCycleTimer );
+
+    SX1272.Settings.LoRa.RxContinuous = RxDutyCycle.RxContinuous;
+    SX1272Write( REG_LR_MODEMCONFIG2,
+                 ( SX1272Read( REG_LR_MODEMCONFIG2 ) & RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) |
+                 ( ( RxDutyCycle.SymbTimeout >> 8 ) & ~RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) );
+    SX1272Write( REG_LR_SYMBTIMEOUTLSB, ( uint8_t )( RxDutyCycle.SymbTimeout & 0xFF ) );
+}
+
 void SX1272SetTx( uint32_t timeout )
 {
     TimerStop( &RxTimeoutTimer );
@@ -1222,6 +1330,7 @@ void SX1272OnDio0Irq( void* context )
                             SX1272.Settings.State = RF_IDLE;
                         }
                         TimerStop( &RxTimeoutTimer );
+                        SX1272RxDutyCycleStop( );
 
                         if( ( RadioEvents != NULL ) && ( RadioEvents->RxError != NULL ) )
                         {
@@ -1253,6 +1362,7 @@ void SX1272OnDio0Irq( void* context )
                         SX1272.Settings.State = RF_IDLE;
                     }
                     TimerStop( &RxTimeoutTimer );
+                    SX1272RxDutyCycleStop( );
 
                     if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
                     {
@@ -1299,6 +1409,15 @@ void SX1272OnDio1Irq( void* context )
 			SX1272Write( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXTIMEOUT );
 
 			SX1272.Settings.State = RF_IDLE;
+			if( RxDutyCycle.On == true )
+			{
+				// 창 안에 프리앰블 없음: 라디오 슬립 후 다음 창 예약 (앱에는 알리지 않음)
+				SX1272SetOpMode( RF_OPMODE_SLEEP );
+				TimerStop( &RxDutyCycleTimer );
+				TimerSetValue( &RxDutyCycleTimer, RxDutyCycle.SleepTime );
+				TimerStart( &RxDutyCycleTimer );
+				break;
+			}
 			if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
 			{
 				RadioEvents->RxTimeout( );
@@ -331,6 +331,21 @@ void SX1272SetStby( void );
  */
 void SX1272SetRx( uint32_t timeout );
 
+/*!
+ * \brief Sets the radio in reception duty cycle (sniff) mode
+ *
+ * \remark LoRa only. The radio opens a single reception window of rxTime and
+ *         goes back to sleep for sleepTime when no preamble is detected in it.
+ *         A detected preamble keeps the window open until RxDone.
+ *         The mode ends on RxDone/RxError or on any other Rx/Sleep/Standby/Send
+ *         call, so the application must call it again to resume.
+ *         Transmitters must use a preamble covering rxTime + sleepTime.
+ *
+ * \param [IN] rxTime    Reception window [ms]
+ * \param [IN] sleepTime Sleep time between windows [ms]
+ */
+void SX1272SetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime );
+
 /*!
  * \brief Start a Channel Activity Detection
  */
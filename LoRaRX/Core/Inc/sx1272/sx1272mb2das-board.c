@@ -70,7 +70,7 @@ const struct Radio_s Radio =
     SX1272GetWakeupTime,
     NULL, // void ( *IrqProcess )( void )
     NULL, // void ( *RxBoosted )( uint32_t timeout ) - SX126x Only
-    NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime ) - SX126x Only
+    SX1272SetRxDutyCycle, // rxTime, sleepTime [ms] (소프트웨어 sniff, LoRa 전용)
 };
 
 void SX1272SetBoardTcxo( uint8_t state )
@@ -1,8 +1,8 @@
 #include "timer.h"
 #include "main.h"
 
-// TIM2 핸들러 extern 선언 (main.c에서 생성된 것 사용)
-extern TIM_HandleTypeDef htim2;
+// 틱 소스는 SysTick (stm32f4xx_it.c 의 SysTick_Handler 에서 TimerIrqHandler 호출)
+// TIM2 는 서보 PWM 전용이라 여기서 건드리지 않음
 
 // 타이머 이벤트 링크드 리스트
 static TimerEvent_t *TimerListHead = NULL;
@@ -117,26 +117,7 @@ void TimerStart( TimerEvent_t *obj )
     obj->Timestamp = TimerTickCounter + obj->ReloadValue;
     obj->IsStarted = true;
 
-    if( TimerListHead == NULL )
-    {
-        // TIM2 시작
-        HAL_TIM_Base_Start_IT(&htim2);
-        TimerInsertInList( obj );
-    }
-    else
-    {
-//        elapsedTime = TimerTickCounter - TimerListHead->Timestamp;
-
-        // 새로운 타이머가 더 빨리 만료되는 경우
-        if( obj->Timestamp < TimerListHead->Timestamp )
-        {
-            TimerInsertInList( obj );
-        }
-        else
-        {
-            TimerInsertInList( obj );
-        }
-    }
+    TimerInsertInList( obj );
 
     __enable_irq( );
 }
@@ -149,12 +130,6 @@ void TimerStop( TimerEvent_t *obj )
     TimerRemoveFromList( obj );
     obj->IsStarted = false;
 
-    // 리스트가 비어있으면 타이머 정지
-    if( TimerListHead == NULL )
-    {
-        HAL_TIM_Base_Stop_IT(&htim2);
-    }
-
     __enable_irq( );
 }
 
@@ -201,6 +176,35 @@ uint32_t TimerGetElapsedTime( uint32_t past )
     }
 }
 
+uint32_t TimerGetTimeToNextEvent( void )
+{
+    uint32_t remaining = 0xFFFFFFFF;
+
+    __disable_irq( );
+    if( TimerListHead != NULL )
+    {
+        remaining = ( TimerListHead->Timestamp > TimerTickCounter ) ?
+                    ( TimerListHead->Timestamp - TimerTickCounter ) : 0;
+    }
+    __enable_irq( );
+
+    return remaining;
+}
+
+void TimerAdvance( uint32_t elapsed )
+{
+    if( elapsed == 0 )
+    {
+        return;
+    }
+
+    // 마지막 1ms 는 TimerIrqHandler 가 올리면서 만료 타이머 처리
+    __disable_irq( );
+    TimerTickCounter += elapsed - 1;
+    TimerIrqHandler( );
+    __enable_irq( );
+}
+
 uint32_t TimerTempCompensation( uint32_t period, float temperature )
 {
     // 온도 보상은 필요에 따라 구현
@@ -243,17 +247,4 @@ void TimerIrqHandler( void )
 
         cur = next;
     }
-
-    // 모든 타이머가 처리되면 TIM2 정지
-    if( TimerListHead == NULL )
-    {
-        HAL_TIM_Base_Stop_IT(&htim2);
-    }
 }
-
-// TIM2 인터럽트 핸들러 (stm32f4xx_it.c에 추가해야 함)
-//void TIM2_IRQHandler(void)
-//{
-//    HAL_TIM_IRQHandler(&htim2);
-//    TimerIrqHandler();
-//}
@@ -84,6 +84,23 @@ uint32_t TimerGetCurrentTime( void );
  */
 uint32_t TimerGetElapsedTime( uint32_t past );
 
+/*!
+ * \brief Time until the next timer event expires
+ *
+ * \retval time in milliseconds [0xFFFFFFFF: no timer running]
+ */
+uint32_t TimerGetTimeToNextEvent( void );
+
+/*!
+ * \brief Advances the time base after the tick source was stopped
+ *
+ * \remark Called after MCU STOP mode (SysTick does not run). Expired timers
+ *         are processed as in TimerIrqHandler.
+ *
+ * \param [IN] elapsed      Time spent without tick [ms]
+ */
+void TimerAdvance( uint32_t elapsed );
+
 /*!
  * \brief Computes the temperature compensation for a period of time on a
  *        specific temperature.
@@ -0,0 +1,99 @@
+#ifndef INC_TDMA_H_
+#define INC_TDMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sx1272/airtime.h"
+
+// 비콘 동기 TDMA (게이트웨이 = LoRaRX 보드, 노드 = 로드셀/레이저 TX 보드)
+//
+// 슈퍼프레임 구조
+//   | 비콘 | 슬롯 0 | 슬롯 1 | ... | 슬롯 N-1 | 가입(join) 슬롯 |
+//   - 비콘: 게이트웨이가 주기적으로 슬롯 배정표를 방송
+//   - 슬롯: 배정된 노드 하나만 송신 (충돌 없음)
+//   - 가입 슬롯: 슬롯이 없는 노드가 ALOHA 로 가입 요청
+//
+// 패킷 첫 바이트로 종류 구분 ('M' 모터 패킷과 공존)
+#define TDMA_FRAME_BEACON       'B'   // 게이트웨이 → 노드
+#define TDMA_FRAME_JOIN         'J'   // 노드 → 게이트웨이 (가입 요청)
+#define TDMA_FRAME_UPLINK       'U'   // 노드 → 게이트웨이 (슬롯 내 데이터)
+
+#define TDMA_MAX_SLOTS          32    // 슈퍼프레임당 최대 노드 수
+#define TDMA_MAX_PAYLOAD        48    // 업링크 데이터 최대 길이 (슬롯 길이 계산 기준)
+#define TDMA_SLOT_FREE          0xFF  // 빈 슬롯 표시
+#define TDMA_NODE_EXPIRE        8     // 이 슈퍼프레임 수 동안 소식 없으면 슬롯 회수
+#define TDMA_TX_QUEUE_LEN       16    // 노드 송신 FIFO (이벤트/원시). 이벤트 하나 = IR 2 + 조각 10 + 컵 1
+
+// 클럭 오차 (게이트웨이 대비). 보드가 HSI → PLL 로 돌아서 보정 전에는 ±1 %
+//   RAW  : 보정 전 (HSI 정확도). 비콘 간격 측정값을 받아들이는 범위, 수렴 전 노드의 송신 가능 판단
+//   TRIM : 비콘으로 보정한 뒤 남는 오차 (RxDone 틱 흔들림 ~1 ms / 1 s 를 1/8 필터로 줄인 값 + 온도 여유)
+//          게이트웨이가 방송하는 가드는 이 값 기준
+#define TDMA_CLOCK_PPM_RAW      10000
+#define TDMA_CLOCK_PPM_TRIM     500
+#define TDMA_SYNC_BEACONS       8     // 이만큼 비콘 간격을 받아들이면 수렴으로 봄 (연속 이상치도 이만큼이면 다시 잡음)
+#define TDMA_TURNAROUND_MS      2     // RX→TX 전환 + SPI 여유
+
+// 비콘 헤더: 'B', seq, period(2), slotLen(2), guard, nSlots, 그 뒤에 슬롯별 nodeId
+//   period/slotLen 은 16 비트, guard 는 8 비트로 실림 → TDMA_ComputeTiming 이 그 안에 들도록 슬롯 수를 줄임
+#define TDMA_BEACON_HDR_LEN     8
+#define TDMA_BEACON_MAX_LEN     ( TDMA_BEACON_HDR_LEN + TDMA_MAX_SLOTS )
+// 업링크 헤더: 'U', nodeId, seq, 대기(2, LE)
+//   대기 = 데이터를 큐에 넣은 뒤 실제 송신까지 걸린 ms (슬롯 기다림/미룸 포함, 65535 에서 포화)
+#define TDMA_UPLINK_HDR_LEN     5
+
+typedef struct {
+    uint16_t slotLen;        // 슬롯 길이 (ms, 가드 포함)
+    uint16_t guard;          // 슬롯 앞뒤 가드 (ms)
+    uint16_t beaconLen;      // 비콘 구간 길이 (ms)
+    uint8_t  nSlots;         // 배정 가능한 슬롯 수
+    uint32_t period;         // 슈퍼프레임 길이 (ms, 비콘에는 16비트로 실림)
+} TDMA_Timing_t;
+
+// ===================== 공통 =====================
+
+// 슬롯/가드/주기 계산. toaBeacon, toaSlot 은 SX1272GetTimeOnAir 결과 (ms)
+// 주기가 비콘 필드(16 비트)를 넘으면 nSlots 를 줄임 (결과는 t->nSlots). 슬롯 하나도 안 들면 false
+bool TDMA_ComputeTiming(TDMA_Timing_t *t, uint8_t nSlots,
+                        uint32_t toaBeacon, uint32_t toaSlot);
+
+// ===================== 게이트웨이 =====================
+
+// 비콘 주기 타이머 시작. 슬롯이 하나도 안 들어가는 설정 (SF 가 너무 큼 등) 이면 false (비콘 안 보냄)
+bool TDMA_GatewayInit(uint8_t nSlots);
+
+// 메인 루프에서 호출. 비콘 보낼 차례면 true (frame/len 채움)
+bool TDMA_GatewayPoll(uint8_t *frame, uint8_t *len);
+
+// 수신 패킷 처리. 업링크면 데이터 부분을 data/dataLen 으로 돌려주고 true
+// seq 는 노드의 업링크 순번 (여러 게이트웨이가 같은 패킷을 들었을 때 수집기에서 중복 제거용)
+// waitMs 는 노드 안에서 송신을 기다린 시간 (지연 추적용)
+bool TDMA_GatewayOnRx(const uint8_t *payload, uint16_t size,
+                      const uint8_t **data, uint16_t *dataLen, uint8_t *nodeId, uint8_t *seq,
+                      uint16_t *waitMs);
+
+const TDMA_Timing_t *TDMA_GetTiming(void);
+
+// ===================== 노드 =====================
+
+void TDMA_NodeInit(uint8_t nodeId);
+
+// 비콘 수신 시 호출 (rxDoneTick = RxDone 시점의 TimerGetCurrentTime)
+// 클럭 보정이 수렴하기 전에는 RAW 오차로 벌어질 시간이 가드를 넘는 슬롯에서는 송신하지 않음
+bool TDMA_NodeOnBeacon(const uint8_t *payload, uint16_t size, uint32_t rxDoneTick);
+
+// 다음 내 슬롯부터 보낼 데이터 등록 (슬롯 하나에 한 패킷)
+//   EVENT/RAW : FIFO 에 차례로 쌓음, 가득 차면 false (보류 중인 항목은 덮어쓰지 않음)
+//   PERIODIC  : 한 칸만, 아직 못 보낸 이전 값은 새 값으로 대체 (FIFO 가 빌 때 송신)
+bool TDMA_NodeQueue(const uint8_t *data, uint8_t len, AirtimeClass_t cls);
+
+// 메인 루프에서 호출. 지금 보낼 차례면 true (frame/len 채움)
+// 송신 시간 예산이 빠듯하면 종류별로 미루거나(다음 슬롯, 최신값으로 합쳐짐) 버림
+bool TDMA_NodePoll(uint8_t *frame, uint8_t *len);
+
+// 보정된 로컬 클럭 비율 (Q16, 65536 = 1.0)
+uint32_t TDMA_NodeClockRatio(void);
+
+// 클럭 보정 수렴 여부 (TDMA_SYNC_BEACONS 개 받아들임)
+bool TDMA_NodeClockLocked(void);
+
+#endif /* INC_TDMA_H_ */
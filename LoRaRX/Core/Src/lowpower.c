@@ -0,0 +1,155 @@
+#include "main.h"
+#include "lowpower.h"
+#include "sx1272/timer.h"
+
+// main.c (CubeMX 생성) - STOP 에서 깨어나면 PLL 이 꺼져 있어서 다시 설정
+extern void SystemClock_Config(void);
+
+// RTC 비동기 분주 16 → SSR/웨이크업 타이머 모두 RTCCLK/16 (LSE 면 2048Hz)
+#define LOWPOWER_PREDIV_A   15u
+
+static uint8_t  rtc_ready = 0;
+static uint32_t rtc_hz = 0;         // SSR 카운트 주파수
+static uint32_t prediv_s = 0;       // rtc_hz - 1 (1초 = rtc_hz 카운트)
+
+static void LowPower_RtcUnlock(void)
+{
+    RTC->WPR = 0xCA;
+    RTC->WPR = 0x53;
+}
+
+static void LowPower_RtcLock(void)
+{
+    RTC->WPR = 0xFF;
+}
+
+// 하루 안에서의 RTC 카운트 (초 * rtc_hz + 서브초)
+static uint32_t LowPower_RtcTicks(void)
+{
+    uint32_t ssr, tr;
+
+    // 섀도 레지스터 우회 상태라 두 번 읽어서 초 경계에 걸리지 않았는지 확인
+    do {
+        ssr = RTC->SSR;
+        tr  = RTC->TR;
+    } while (ssr != RTC->SSR);
+
+    uint32_t hour = ((tr >> 20) & 0x3) * 10 + ((tr >> 16) & 0xF);
+    uint32_t min  = ((tr >> 12) & 0x7) * 10 + ((tr >> 8) & 0xF);
+    uint32_t sec  = ((tr >> 4) & 0x7) * 10 + (tr & 0xF);
+
+    return (hour * 3600u + min * 60u + sec) * rtc_hz + (prediv_s - ssr);
+}
+
+static void LowPower_WakeupArm(uint32_t ticks)
+{
+    if (ticks == 0) ticks = 1;
+    if (ticks > 0x10000) ticks = 0x10000;
+
+    LowPower_RtcUnlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    while ((RTC->ISR & RTC_ISR_WUTWF) == 0) { }
+
+    RTC->WUTR = ticks - 1;
+    RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | RTC_CR_WUTIE | RTC_CR_WUTE;   // WUCKSEL=000: RTCCLK/16
+    LowPower_RtcLock();
+}
+
+static void LowPower_WakeupDisarm(void)
+{
+    LowPower_RtcUnlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    LowPower_RtcLock();
+    LowPower_WakeupIrq();
+}
+
+void LowPower_Init(void)
+{
+    RCC_OscInitTypeDef osc = {0};
+    RCC_PeriphCLKInitTypeDef clk = {0};
+
+    osc.OscillatorType = RCC_OSCILLATORTYPE_LSE;
+    osc.LSEState = RCC_LSE_ON;
+    osc.PLL.PLLState = RCC_PLL_NONE;
+    clk.PeriphClockSelection = RCC_PERIPHCLK_RTC;
+    clk.RTCClockSelection = RCC_RTCCLKSOURCE_LSE;
+    rtc_hz = LSE_VALUE / (LOWPOWER_PREDIV_A + 1);
+
+    if (HAL_RCC_OscConfig(&osc) != HAL_OK)
+    {
+        // LSE 가 안 뜨는 보드: LSI 로 (±수십 % 오차 → 틱 보정도 그만큼 부정확)
+        osc.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+        osc.LSEState = RCC_LSE_OFF;
+        osc.LSIState = RCC_LSI_ON;
+        if (HAL_RCC_OscConfig(&osc) != HAL_OK) return;
+
+        clk.RTCClockSelection = RCC_RTCCLKSOURCE_LSI;
+        rtc_hz = LSI_VALUE / (LOWPOWER_PREDIV_A + 1);
+    }
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK) return;
+    __HAL_RCC_RTC_ENABLE();
+
+    // 1Hz 캘린더 + 서브초, 섀도 레지스터 우회 (STOP 복귀 직후 RSF 대기 없이 읽기)
+    prediv_s = rtc_hz - 1;
+    LowPower_RtcUnlock();
+    RTC->ISR |= RTC_ISR_INIT;
+    while ((RTC->ISR & RTC_ISR_INITF) == 0) { }
+    RTC->PRER = prediv_s;
+    RTC->PRER |= (LOWPOWER_PREDIV_A << RTC_PRER_PREDIV_A_Pos);
+    RTC->CR |= RTC_CR_BYPSHAD;
+    RTC->ISR &= ~RTC_ISR_INIT;
+    LowPower_RtcLock();
+
+    // RTC 웨이크업은 EXTI 22 (상승 에지)
+    EXTI->IMR  |= EXTI_IMR_MR22;
+    EXTI->RTSR |= EXTI_RTSR_TR22;
+    HAL_NVIC_SetPriority(RTC_WKUP_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+    rtc_ready = 1;
+}
+
+void LowPower_WakeupIrq(void)
+{
+    RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT) | (RTC->ISR & RTC_ISR_INIT);
+    EXTI->PR = EXTI_PR_PR22;
+}
+
+void LowPower_Enter(void)
+{
+    uint32_t next = TimerGetTimeToNextEvent();
+
+    if (!rtc_ready || next < LOWPOWER_MIN_STOP_MS)
+    {
+        // 다음 SysTick 또는 인터럽트까지 SLEEP (틱은 그대로 돎)
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+        return;
+    }
+    if (next > LOWPOWER_MAX_STOP_MS) next = LOWPOWER_MAX_STOP_MS;
+
+    // 마지막 printf 바이트가 다 나갈 때까지 (STOP 중에는 UART 클럭이 멈춤)
+    while ((USART2->SR & USART_SR_TC) == 0) { }
+
+    // 깨어난 뒤 클럭 복구 전에 ISR 이 돌지 않도록 막아둠 (WFI 는 PRIMASK 와 상관없이 깨어남)
+    __disable_irq();
+    uint32_t start = LowPower_RtcTicks();
+    LowPower_WakeupArm(next * rtc_hz / 1000u);
+
+    HAL_SuspendTick();
+    HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+    // 복귀: HSI 16MHz 로 깨어나므로 PLL/버스 클럭 다시 설정
+    SystemClock_Config();
+    HAL_ResumeTick();
+    LowPower_WakeupDisarm();
+
+    uint32_t now = LowPower_RtcTicks();
+    if (now < start) now += 86400u * rtc_hz;    // 자정 넘김
+    uint32_t elapsed = (uint32_t)(((uint64_t)(now - start) * 1000u) / rtc_hz);
+
+    // 잠든 동안 못 센 틱 보정 (HAL_GetTick / 타이머 서비스 둘 다)
+    uwTick += elapsed;
+    TimerAdvance(elapsed);
+
+    __enable_irq();
+}
@@ -21,7 +21,14 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include <stdio.h>
+#include <string.h>
+#include "sx1272/radio.h"
+#include "sx1272/timer.h"
+#include "sx1272/airtime.h"
+#include "tdma.h"
+#include "lowpower.h"
+#include "servo.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -31,7 +38,9 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+#if LORA_RX_DUTY_CYCLE_ON && TDMA_GATEWAY_ENABLE
+#error "TDMA 게이트웨이는 슬롯마다 들어야 하므로 연속 수신만 가능"
+#endif
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -50,7 +59,9 @@ UART_HandleTypeDef huart2;
 static RadioEvents_t RadioEvents;
 static uint8_t RxBuffer[257];   // 마지막 1바이트는 '\0' 위해
 static uint16_t RxSize = 0;
-static int motor_command_received = 0;
+static uint8_t TxBuffer[TDMA_BEACON_MAX_LEN];
+static TimerEvent_t StatsTimer;
+static volatile uint8_t stats_due = 0;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -63,9 +74,13 @@ static void MX_TIM2_Init(void);
 
 /* LoRa 초기화 및 콜백 */
 void LoRa_Init(void);
+static void LoRa_RxStart(void);
 static void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr);
 static void OnRxTimeout(void);
 static void OnRxError(void);
+static void OnTxDone(void);
+static void OnTxTimeout(void);
+static void OnStatsTimer(void *context);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -107,7 +122,7 @@ int main(void)
   MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
   LoRa_Init();   // LoRa 수신 초기화
-  HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_2); // PWM 시작
+  Servo_Init(&htim2, TIM_CHANNEL_2, 90);    // PWM 시작 (가운데 위치)
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -117,6 +132,29 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
+#if TDMA_GATEWAY_ENABLE
+    // 비콘 차례면 수신을 잠시 멈추고 송신 (TxDone 에서 다시 수신)
+    uint8_t len;
+    if (TDMA_GatewayPoll(TxBuffer, &len) &&
+        AirtimeAdmit(AIRTIME_CLASS_CONTROL, Radio.TimeOnAir(MODEM_LORA, len)) == AIRTIME_SEND)
+    {
+        // 예산이 없으면 이번 비콘은 건너뜀 (노드는 이전 배정표로 계속 동작)
+        Radio.Standby();
+        Radio.Send(TxBuffer, len);
+    }
+#endif
+
+    // 송신 시간 예산 카운터 주기 출력
+    if (stats_due)
+    {
+        stats_due = 0;
+        AirtimePrintStats();
+    }
+
+#if LORA_RX_DUTY_CYCLE_ON
+    // 할 일이 없으면 다음 타이머(수신 창) 또는 DIO 인터럽트까지 STOP
+    LowPower_Enter();
+#endif
   }
   /* USER CODE END 3 */
 }
@@ -226,9 +264,9 @@ static void MX_TIM2_Init(void)
 
   /* USER CODE END TIM2_Init 1 */
   htim2.Instance = TIM2;
-  htim2.Init.Prescaler = 8399;
+  htim2.Init.Prescaler = 83;
   htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim2.Init.Period = 199;
+  htim2.Init.Period = 19999;
   htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
   htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
@@ -251,7 +289,7 @@ static void MX_TIM2_Init(void)
     Error_Handler();
   }
   sConfigOC.OCMode = TIM_OCMODE_PWM1;
-  sConfigOC.Pulse = 15;
+  sConfigOC.Pulse = 1500;
   sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
   sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
   if (HAL_TIM_PWM_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_2) != HAL_OK)
@@ -391,6 +429,8 @@ void LoRa_Init(void)
     RadioEvents.RxDone    = OnRxDone;
     RadioEvents.RxTimeout = OnRxTimeout;
     RadioEvents.RxError   = OnRxError;
+    RadioEvents.TxDone    = OnTxDone;
+    RadioEvents.TxTimeout = OnTxTimeout;
 
     /* 드라이버 초기화 */
     Radio.Init(&RadioEvents);
@@ -404,7 +444,7 @@ void LoRa_Init(void)
         LORA_SPREADING_FACTOR,
         LORA_CODINGRATE,
         0,                      // fdev (FSK용)
-        LORA_PREAMBLE_LENGTH,
+        LORA_LINK_PREAMBLE_LENGTH,
         LORA_SYMBOL_TIMEOUT,
         LORA_FIX_LENGTH_PAYLOAD_ON,
         0,                      // payloadLen (가변일 때 0)
@@ -415,14 +455,61 @@ void LoRa_Init(void)
         true                    // continuous mode
     );
 
-    /* 수신 시작 (0이면 연속 수신) */
-    Radio.Rx(0);
+    Radio.SetTxConfig(
+        MODEM_LORA,
+        LORA_TX_OUTPUT_POWER,
+        0,                      // fdev (FSK용)
+        LORA_BANDWIDTH,
+        LORA_SPREADING_FACTOR,
+        LORA_CODINGRATE,
+        LORA_LINK_PREAMBLE_LENGTH,
+        LORA_FIX_LENGTH_PAYLOAD_ON,
+        true,                   // crcOn
+        0,                      // freqHopOn
+        0,                      // hopPeriod
+        LORA_IQ_INVERSION_ON,
+        LORA_TX_TIMEOUT
+    );
+
+    /* 송신 시간 예산 카운터 출력 타이머 */
+    TimerInit(&StatsTimer, OnStatsTimer);
+    TimerSetValue(&StatsTimer, AIRTIME_STATS_PERIOD_MS);
+    TimerStart(&StatsTimer);
+
+#if TDMA_GATEWAY_ENABLE
+    /* 슬롯 길이/가드는 위 설정 기준 TimeOnAir 로 계산 */
+    if (TDMA_GatewayInit(TDMA_NUM_SLOTS)) {
+        const TDMA_Timing_t *t = TDMA_GetTiming();
+        printf("TDMA slots=%u slot=%ums guard=%ums period=%lums\r\n",
+               t->nSlots, t->slotLen, t->guard, (unsigned long)t->period);
+    } else {
+        // 슬롯 하나도 비콘 필드(주기 16 비트)에 안 들어감 → 비콘 없이 연속 수신만
+        printf("TDMA disabled: superframe exceeds 65535 ms at this SF\r\n");
+    }
+#endif
+
+#if LORA_RX_DUTY_CYCLE_ON
+    LowPower_Init();
+#endif
+
+    LoRa_RxStart();
+}
+
+/* 수신 (재)시작: 듀티 사이클 모드면 sniff, 아니면 연속 수신 */
+static void LoRa_RxStart(void)
+{
+#if LORA_RX_DUTY_CYCLE_ON
+    Radio.SetRxDutyCycle(LORA_RX_WINDOW_MS, LORA_RX_SLEEP_MS);
+#else
+    Radio.Rx(0);    // 0이면 연속 수신
+#endif
 }
 
 /* 실제 패킷 수신 콜백 */
 static void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
 {
 	static uint32_t packet_count = 0;
+	uint32_t rx_tick = HAL_GetTick();     // 수신 완료 시각 (지연 추적: 수집기로 같이 보냄)
 	packet_count++;
 
 	/* 수신된 데이터 보관 */
@@ -434,7 +521,26 @@ static void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
 	RxBuffer[RxSize] = '\0';
     
 	/* 다시 수신 모드로 빠르게 전환 (printf 전에!) */
-    Radio.Rx(0);
+    LoRa_RxStart();
+
+#if TDMA_GATEWAY_ENABLE
+    // TDMA 가입/업링크 패킷: 업링크 데이터는 수집기로 한 줄씩 전달
+    const uint8_t *data;
+    uint16_t dataLen;
+    uint8_t nodeId, seq;
+    uint16_t waitMs;
+    if (RxSize > 0 && (RxBuffer[0] == TDMA_FRAME_JOIN || RxBuffer[0] == TDMA_FRAME_UPLINK))
+    {
+        if (TDMA_GatewayOnRx(RxBuffer, RxSize, &data, &dataLen, &nodeId, &seq, &waitMs))
+        {
+            // [#노드:순번 rx=수신틱 q=노드대기ms air=공중ms] 데이터
+            // (게이트웨이 여러 대가 같은 패킷을 올리면 수집기가 순번으로 걸러냄, 나머지는 지연 추적용)
+            printf("[#%u:%u rx=%lu q=%u air=%lu] %.*s\r\n", nodeId, seq, (unsigned long)rx_tick,
+                   waitMs, (unsigned long)Radio.TimeOnAir(MODEM_LORA, size), (int)dataLen, (const char *)data);
+        }
+        return;
+    }
+#endif
 
     // 패킷 식별 및 모터 동작
     if (RxSize > 0 && RxBuffer[0] == 'M')
@@ -442,8 +548,9 @@ static void OnRxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
         // (디버깅용 출력)
         printf("Motor Packet: %s\n", (char *)RxBuffer); // M을 제외한 데이터 출력
 
-    	// 모터 동작용 플래그
-    	motor_command_received = 1;
+    	// 모션 큐에 넣기만 함 (실제 동작은 TIM2 인터럽트에서)
+    	if (!Servo_HandlePacket(RxBuffer, RxSize))
+    	    printf("Motor Packet rejected\r\n");
     }
     // 가창 앞이 'M'이 아닌 패킷은 무시하고, 다음 수신 대기 상태로 전환 완료
 }
@@ -452,14 +559,42 @@ static void OnRxTimeout(void)
 {
     /* 타임아웃 후 다시 수신 시작 */
     printf("LoRa RX Timeout\r\n");
-    Radio.Rx(0);
+    LoRa_RxStart();
 }
 
 static void OnRxError(void)
 {
     /* 오류 발생 시도 다시 수신 시작 */
     printf("LoRa RX Error\r\n");
-    Radio.Rx(0);
+    LoRa_RxStart();
+}
+
+static void OnTxDone(void)
+{
+    /* 비콘 송신 완료 → 연속 수신 복귀 */
+    LoRa_RxStart();
+}
+
+static void OnTxTimeout(void)
+{
+    printf("LoRa TX Timeout\r\n");
+    LoRa_RxStart();
+}
+
+static void OnStatsTimer(void *context)
+{
+    stats_due = 1;
+    TimerSetValue(&StatsTimer, AIRTIME_STATS_PERIOD_MS);
+    TimerStart(&StatsTimer);
+}
+
+/* PWM 주기(20ms)마다 서보 프로파일 진행 */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance == TIM2)
+    {
+        Servo_OnPeriod();
+    }
 }
 
 /* SX1272 IRQ 핸들러 extern 선언 */
@@ -482,7 +617,7 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
     {
         /* 버튼으로 디버깅 */
         printf("B1 pressed\r\n");
-        Radio.Rx(0);
+        LoRa_RxStart();
     }
 }
 /* USER CODE END 4 */
@@ -0,0 +1,206 @@
+#include "main.h"
+#include "servo.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SERVO_PERIOD_MS     ( SERVO_PERIOD_US / 1000 )
+#define SERVO_FULL_MDEG     ( SERVO_MAX_ANGLE * 1000 )
+// 한 주기당 속도 변화량 [mdeg/s]
+#define SERVO_DV            ( SERVO_ACCEL * SERVO_PERIOD_MS )
+
+typedef enum {
+    SERVO_IDLE = 0,
+    SERVO_MOVING,
+    SERVO_DWELL,
+} Servo_State_t;
+
+static TIM_HandleTypeDef *htim_servo = NULL;
+static uint32_t servo_ch;
+
+// 명령 큐 (넣는 쪽: 라디오 콜백, 빼는 쪽: TIM2 인터럽트)
+static Servo_Command_t queue[SERVO_QUEUE_LEN];
+static volatile uint8_t q_head = 0;
+static volatile uint8_t q_tail = 0;
+
+// 프로파일 상태 (위치/속도는 밀리도 단위 정수)
+static volatile Servo_State_t state = SERVO_IDLE;
+static volatile int32_t pos_md = 0;     // 현재 위치 [mdeg]
+static int32_t target_md = 0;           // 목표 위치 [mdeg]
+static int32_t vel = 0;                 // 현재 속도 크기 [mdeg/s]
+static int32_t vmax = 0;                // 이번 명령 최대 속도 [mdeg/s]
+static uint32_t dwell_left = 0;         // 남은 대기 [ms]
+static uint16_t dwell_cmd = 0;          // 이번 명령 대기 [ms]
+
+static uint16_t Servo_PulseUs(int32_t md)
+{
+    return (uint16_t)(SERVO_MIN_PULSE_US +
+                      (md * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) + SERVO_FULL_MDEG / 2) / SERVO_FULL_MDEG);
+}
+
+// 현재 속도에서 멈추는 데 필요한 거리 [mdeg]
+static int32_t Servo_BrakeDistance(void)
+{
+    return (int32_t)(((int64_t)vel * vel) / (2 * SERVO_ACCEL * 1000));
+}
+
+static bool Servo_NextCommand(void)
+{
+    if (q_tail == q_head) return false;
+
+    const Servo_Command_t *cmd = &queue[q_tail];
+    target_md = (int32_t)cmd->angle * 1000;
+    vmax = (int32_t)cmd->speed * 1000;
+    dwell_cmd = cmd->dwell;
+    q_tail = (q_tail + 1) % SERVO_QUEUE_LEN;
+    return true;
+}
+
+// 한 주기 진행. 도착하면 true
+static bool Servo_Step(void)
+{
+    int32_t remain = target_md - pos_md;
+    int32_t dist = (remain >= 0) ? remain : -remain;
+
+    if (dist == 0) {
+        vel = 0;
+        return true;
+    }
+
+    // 감속 거리 안에 들어오면 감속, 아니면 최대 속도까지 가속
+    if (Servo_BrakeDistance() >= dist) {
+        vel -= SERVO_DV;
+    } else if (vel < vmax) {
+        vel += SERVO_DV;
+        if (vel > vmax) vel = vmax;
+    }
+    // 마지막 구간에서 속도가 0 이 되어 멈춰버리지 않도록 최소 속도 유지
+    if (vel < SERVO_DV) vel = SERVO_DV;
+
+    int32_t step = vel * SERVO_PERIOD_MS / 1000;
+    if (step >= dist) {
+        pos_md = target_md;
+        vel = 0;
+        return true;
+    }
+    pos_md += (remain > 0) ? step : -step;
+    return false;
+}
+
+void Servo_Init(TIM_HandleTypeDef *htim, uint32_t channel, int16_t angle)
+{
+    htim_servo = htim;
+    servo_ch = channel;
+
+    pos_md = target_md = (int32_t)angle * 1000;
+    vel = 0;
+    state = SERVO_IDLE;
+
+    __HAL_TIM_SET_COMPARE(htim, channel, Servo_PulseUs(pos_md));
+    HAL_TIM_Base_Start_IT(htim);    // 업데이트 인터럽트 = PWM 주기
+    HAL_TIM_PWM_Start(htim, channel);
+}
+
+bool Servo_Queue(const Servo_Command_t *cmd)
+{
+    uint8_t next = (q_head + 1) % SERVO_QUEUE_LEN;
+    if (next == q_tail) return false;   // 큐 가득
+
+    Servo_Command_t *slot = &queue[q_head];
+    slot->angle = cmd->angle;
+    if (slot->angle < 0) slot->angle = 0;
+    if (slot->angle > SERVO_MAX_ANGLE) slot->angle = SERVO_MAX_ANGLE;
+    slot->speed = (cmd->speed == 0) ? SERVO_DEFAULT_SPEED :
+                  (cmd->speed > SERVO_MAX_SPEED) ? SERVO_MAX_SPEED : cmd->speed;
+    slot->dwell = cmd->dwell;
+
+    q_head = next;
+    return true;
+}
+
+bool Servo_HandlePacket(const uint8_t *payload, uint16_t size)
+{
+    char buf[32];
+
+    if (size < 2 || payload[0] != 'M') return false;
+    if (payload[1] == 'S') {
+        Servo_Stop();
+        return true;
+    }
+
+    // 'M' 뒤 숫자들만 복사해서 문자열로
+    uint16_t len = size - 1;
+    if (len > sizeof(buf) - 1) len = sizeof(buf) - 1;
+    memcpy(buf, &payload[1], len);
+    buf[len] = '\0';
+
+    char *p = buf, *end;
+    long v[3] = { -1, SERVO_DEFAULT_SPEED, 0 };
+    for (int i = 0; i < 3; i++) {
+        v[i] = strtol(p, &end, 10);
+        if (end == p) return false;     // 숫자 없음
+        if (*end != ',') break;
+        p = end + 1;
+    }
+
+    if (v[0] < 0 || v[0] > SERVO_MAX_ANGLE || v[1] < 0 || v[2] < 0) return false;
+
+    Servo_Command_t cmd = {
+        .angle = (int16_t)v[0],
+        .speed = (uint16_t)(v[1] > 0xFFFF ? 0xFFFF : v[1]),
+        .dwell = (uint16_t)(v[2] > 0xFFFF ? 0xFFFF : v[2]),
+    };
+    return Servo_Queue(&cmd);
+}
+
+void Servo_Stop(void)
+{
+    __disable_irq();
+    q_tail = q_head;    // 남은 명령 버림
+
+    if (state == SERVO_MOVING) {
+        // 지금 속도에서 감속해서 멈출 수 있는 지점으로 목표를 당김
+        int32_t brake = Servo_BrakeDistance();
+        target_md = (target_md > pos_md) ? pos_md + brake : pos_md - brake;
+        if (target_md < 0) target_md = 0;
+        if (target_md > SERVO_FULL_MDEG) target_md = SERVO_FULL_MDEG;
+    } else {
+        state = SERVO_IDLE;
+    }
+    dwell_cmd = 0;
+    __enable_irq();
+}
+
+void Servo_OnPeriod(void)
+{
+    if (htim_servo == NULL) return;
+
+    switch (state) {
+    case SERVO_IDLE:
+        if (!Servo_NextCommand()) break;
+        state = SERVO_MOVING;
+        // fall through
+    case SERVO_MOVING:
+        if (Servo_Step()) {
+            dwell_left = dwell_cmd;
+            state = (dwell_left > 0) ? SERVO_DWELL : SERVO_IDLE;
+        }
+        break;
+    case SERVO_DWELL:
+        if (dwell_left > SERVO_PERIOD_MS) dwell_left -= SERVO_PERIOD_MS;
+        else state = SERVO_IDLE;
+        break;
+    }
+
+    // 프리로드라 다음 주기 시작부터 적용
+    __HAL_TIM_SET_COMPARE(htim_servo, servo_ch, Servo_PulseUs(pos_md));
+}
+
+int16_t Servo_GetAngle(void)
+{
+    return (int16_t)((pos_md + 500) / 1000);
+}
+
+bool Servo_IsBusy(void)
+{
+    return (state != SERVO_IDLE) || (q_tail != q_head);
+}
@@ -0,0 +1,391 @@
+#include "main.h"
+#include "tdma.h"
+#include <string.h>
+#include "sx1272/timer.h"
+#include "sx1272/radio.h"
+#include "sx1272/utilities.h"
+
+// 슬롯 타이밍 (게이트웨이: 직접 계산, 노드: 비콘에서 받음)
+static TDMA_Timing_t timing;
+
+// ===================== 공통 =====================
+
+// 이 시간 동안 오차 ppm 인 두 클럭이 벌어질 수 있는 최대 시간 (ms, 올림)
+// (ms 는 비콘 필드 16 비트 이내 → 65535 * 2 * 10000 도 32 비트 안)
+static uint32_t TDMA_DriftMs(uint32_t ms, uint32_t ppm)
+{
+    return (ms * 2u * ppm + 999999u) / 1000000u;
+}
+
+bool TDMA_ComputeTiming(TDMA_Timing_t *t, uint8_t nSlots,
+                        uint32_t toaBeacon, uint32_t toaSlot)
+{
+    if (nSlots > TDMA_MAX_SLOTS) nSlots = TDMA_MAX_SLOTS;
+
+    // 가드 = 전환 시간 + 라디오 기상 시간 + 한 주기 동안의 (보정 후) 클럭 드리프트
+    // 주기가 가드에 의존하므로 두 번 돌려서 수렴
+    // 비콘에는 주기/슬롯 길이 16 비트, 가드 8 비트로 실리므로 넘치면 슬롯 수를 줄임 (SF 가 클 때)
+    for (; nSlots > 0; nSlots--) {
+        uint32_t guard = TDMA_TURNAROUND_MS + Radio.GetWakeupTime();
+        uint32_t period = 0;
+        for (int i = 0; i < 2; i++) {
+            uint32_t slotLen = toaSlot + 2u * guard;
+            period = toaBeacon + guard + (uint32_t)(nSlots + 1) * slotLen;
+            if (period > 0xFFFFu) break;
+            guard = TDMA_TURNAROUND_MS + Radio.GetWakeupTime() + TDMA_DriftMs(period, TDMA_CLOCK_PPM_TRIM);
+        }
+        uint32_t slotLen = toaSlot + 2u * guard;
+        period = toaBeacon + guard + (uint32_t)(nSlots + 1) * slotLen;
+        if (period > 0xFFFFu || guard > 0xFFu) continue;
+
+        t->guard     = (uint16_t)guard;
+        t->slotLen   = (uint16_t)slotLen;
+        t->beaconLen = (uint16_t)(toaBeacon + guard);
+        t->nSlots    = nSlots;
+        t->period    = period;
+        return true;
+    }
+    return false;
+}
+
+const TDMA_Timing_t *TDMA_GetTiming(void)
+{
+    return &timing;
+}
+
+// ===================== 게이트웨이 =====================
+
+static TimerEvent_t BeaconTimer;
+static volatile uint8_t beacon_due = 0;
+static uint8_t  beacon_seq = 0;
+static uint32_t superframe = 0;
+
+static uint8_t  slot_node[TDMA_MAX_SLOTS];     // 슬롯 → nodeId
+static uint32_t slot_seen[TDMA_MAX_SLOTS];     // 마지막으로 소식 들은 슈퍼프레임
+
+// 타이머 콜백은 SysTick 인터럽트 안에서 돌기 때문에 플래그만 세움
+static void OnBeaconTimer(void *context)
+{
+    beacon_due = 1;
+    TimerSetValue(&BeaconTimer, timing.period);
+    TimerStart(&BeaconTimer);
+}
+
+bool TDMA_GatewayInit(uint8_t nSlots)
+{
+    // 비콘 길이는 요청한 슬롯 수 기준 (줄어들면 실제 비콘은 더 짧음 → 여유)
+    if (!TDMA_ComputeTiming(&timing, nSlots,
+                            Radio.TimeOnAir(MODEM_LORA, TDMA_BEACON_HDR_LEN + nSlots),
+                            Radio.TimeOnAir(MODEM_LORA, TDMA_UPLINK_HDR_LEN + TDMA_MAX_PAYLOAD))) {
+        return false;
+    }
+
+    memset(slot_node, TDMA_SLOT_FREE, sizeof(slot_node));
+    memset(slot_seen, 0, sizeof(slot_seen));
+    beacon_seq = 0;
+    superframe = 0;
+
+    TimerInit(&BeaconTimer, OnBeaconTimer);
+    TimerSetValue(&BeaconTimer, timing.period);
+    TimerStart(&BeaconTimer);
+    beacon_due = 1;   // 첫 비콘은 바로
+    return true;
+}
+
+static int TDMA_FindSlot(uint8_t nodeId)
+{
+    for (int i = 0; i < timing.nSlots; i++) {
+        if (slot_node[i] == nodeId) return i;
+    }
+    return -1;
+}
+
+bool TDMA_GatewayPoll(uint8_t *frame, uint8_t *len)
+{
+    if (!beacon_due) return false;
+    beacon_due = 0;
+    superframe++;
+
+    // 오래 조용한 노드의 슬롯 회수
+    for (int i = 0; i < timing.nSlots; i++) {
+        if (slot_node[i] != TDMA_SLOT_FREE &&
+            superframe - slot_seen[i] > TDMA_NODE_EXPIRE) {
+            slot_node[i] = TDMA_SLOT_FREE;
+        }
+    }
+
+    uint8_t n = 0;
+    frame[n++] = TDMA_FRAME_BEACON;
+    frame[n++] = beacon_seq++;
+    frame[n++] = (uint8_t)(timing.period & 0xFF);
+    frame[n++] = (uint8_t)(timing.period >> 8);
+    frame[n++] = (uint8_t)(timing.slotLen & 0xFF);
+    frame[n++] = (uint8_t)(timing.slotLen >> 8);
+    frame[n++] = (uint8_t)timing.guard;
+    frame[n++] = timing.nSlots;
+    memcpy(&frame[n], slot_node, timing.nSlots);
+    n += timing.nSlots;
+
+    *len = n;
+    return true;
+}
+
+bool TDMA_GatewayOnRx(const uint8_t *payload, uint16_t size,
+                      const uint8_t **data, uint16_t *dataLen, uint8_t *nodeId, uint8_t *seq,
+                      uint16_t *waitMs)
+{
+    if (size < 2) return false;
+
+    uint8_t id = payload[1];
+    int slot = TDMA_FindSlot(id);
+
+    if (payload[0] == TDMA_FRAME_JOIN) {
+        // 이미 슬롯이 있으면 그대로, 없으면 첫 빈 슬롯 배정 (다음 비콘에 반영)
+        if (slot < 0) slot = TDMA_FindSlot(TDMA_SLOT_FREE);
+        if (slot >= 0) {
+            slot_node[slot] = id;
+            slot_seen[slot] = superframe;
+        }
+        return false;
+    }
+
+    if (payload[0] == TDMA_FRAME_UPLINK && size >= TDMA_UPLINK_HDR_LEN) {
+        if (slot >= 0) slot_seen[slot] = superframe;
+        *nodeId  = id;
+        *seq     = payload[2];
+        *waitMs  = payload[3] | ((uint16_t)payload[4] << 8);
+        *data    = &payload[TDMA_UPLINK_HDR_LEN];
+        *dataLen = size - TDMA_UPLINK_HDR_LEN;
+        return true;
+    }
+
+    return false;
+}
+
+// ===================== 노드 =====================
+
+static TimerEvent_t SlotTimer;
+static volatile uint8_t slot_due = 0;
+
+static uint8_t  node_id = 0;
+static int      node_slot = -1;          // 배정받은 슬롯 (-1: 없음 → 가입 필요)
+static uint8_t  node_seq = 0;
+
+static uint8_t  last_beacon_seq = 0;
+static uint32_t last_beacon_tick = 0;
+static uint8_t  node_synced = 0;
+static uint32_t clock_ratio = 65536;     // 로컬 ms / 게이트웨이 ms (Q16)
+static uint8_t  ratio_n = 0;             // 받아들인 비콘 간격 수 (TDMA_SYNC_BEACONS 에서 멈춤 = 수렴)
+static uint8_t  ratio_rej = 0;           // 연속으로 버린 비콘 간격 수
+
+typedef struct {
+    uint8_t  buf[TDMA_MAX_PAYLOAD];
+    uint8_t  len;                        // 0: 비어 있음
+    AirtimeClass_t cls;
+    uint32_t queued_tick;                // 큐에 들어간 시각 (송신 대기 시간 계산용)
+} TDMA_TxItem_t;
+
+// 이벤트/원시 데이터는 하나도 잃으면 안 되므로 FIFO, 주기 데이터는 최신값 하나만
+static TDMA_TxItem_t tx_fifo[TDMA_TX_QUEUE_LEN];
+static uint8_t  tx_head = 0;
+static uint8_t  tx_count = 0;
+static TDMA_TxItem_t tx_latest;
+
+static void OnSlotTimer(void *context)
+{
+    slot_due = 1;
+}
+
+void TDMA_NodeInit(uint8_t nodeId)
+{
+    node_id = nodeId;
+    node_slot = -1;
+    node_synced = 0;
+    clock_ratio = 65536;
+    ratio_n = 0;
+    ratio_rej = 0;
+    tx_head = 0;
+    tx_count = 0;
+    tx_latest.len = 0;
+    TimerInit(&SlotTimer, OnSlotTimer);
+}
+
+uint32_t TDMA_NodeClockRatio(void)
+{
+    return clock_ratio;
+}
+
+bool TDMA_NodeClockLocked(void)
+{
+    return ratio_n >= TDMA_SYNC_BEACONS;
+}
+
+// 비콘 간격 측정값 하나 반영
+//   수렴 전: 명목(1.0) ± 2배 HSI 오차 안이면 받아들임 (측정 흔들림 여유). 첫 값은 그대로, 그 뒤는 1/8 필터
+//   수렴 후: 지금 비율 ± 4배 TRIM 밖이면 IRQ 지연 등 이상치로 보고 버림
+//            연속으로 TDMA_SYNC_BEACONS 번 버리면 (온도 급변 등) 수렴 전 상태로 다시 잡음
+static void TDMA_NodeTrackClock(uint32_t meas)
+{
+    bool locked = TDMA_NodeClockLocked();
+    uint32_t ref = locked ? clock_ratio : 65536u;
+    uint32_t ppm = locked ? 4u * TDMA_CLOCK_PPM_TRIM : 2u * TDMA_CLOCK_PPM_RAW;
+    uint32_t lim = (uint32_t)((65536ull * ppm) / 1000000u) + 1u;
+
+    if (meas > ref - lim && meas < ref + lim) {
+        if (ratio_n == 0) {
+            clock_ratio = meas;
+        } else {
+            clock_ratio = (uint32_t)((int32_t)clock_ratio + ((int32_t)meas - (int32_t)clock_ratio) / 8);
+        }
+        if (ratio_n < TDMA_SYNC_BEACONS) ratio_n++;
+        ratio_rej = 0;
+    } else if (locked && ++ratio_rej >= TDMA_SYNC_BEACONS) {
+        ratio_n = 0;
+        ratio_rej = 0;
+    }
+}
+
+// 게이트웨이 기준 시간 → 로컬 타이머 시간
+static uint32_t TDMA_ToLocal(uint32_t gw_ms)
+{
+    return (uint32_t)(((uint64_t)gw_ms * clock_ratio) >> 16);
+}
+
+bool TDMA_NodeOnBeacon(const uint8_t *payload, uint16_t size, uint32_t rxDoneTick)
+{
+    if (size < TDMA_BEACON_HDR_LEN || payload[0] != TDMA_FRAME_BEACON) return false;
+
+    uint8_t  seq     = payload[1];
+    uint32_t period  = payload[2] | ((uint32_t)payload[3] << 8);
+    uint16_t slotLen = payload[4] | ((uint16_t)payload[5] << 8);
+    uint8_t  guard   = payload[6];
+    uint8_t  nSlots  = payload[7];
+    if (nSlots > TDMA_MAX_SLOTS || size < TDMA_BEACON_HDR_LEN + nSlots) return false;
+
+    // 드리프트 보정: 비콘 도착 간격(로컬) / 명목 간격(게이트웨이)
+    if (node_synced) {
+        uint8_t  missed  = (uint8_t)(seq - last_beacon_seq);
+        uint32_t local   = rxDoneTick - last_beacon_tick;
+        uint32_t nominal = period * missed;
+        if (missed > 0 && missed < 8 && nominal > 0) {
+            TDMA_NodeTrackClock((uint32_t)(((uint64_t)local << 16) / nominal));
+        }
+    }
+    last_beacon_seq  = seq;
+    last_beacon_tick = rxDoneTick;
+    node_synced = 1;
+
+    timing.period  = period;
+    timing.slotLen = slotLen;
+    timing.guard   = guard;
+    timing.nSlots  = nSlots;
+
+    node_slot = -1;
+    for (int i = 0; i < nSlots; i++) {
+        if (payload[TDMA_BEACON_HDR_LEN + i] == node_id) {
+            node_slot = i;
+            break;
+        }
+    }
+
+    // 비콘 끝(RxDone) 기준 오프셋. 가입 슬롯은 마지막(nSlots) 슬롯
+    uint32_t slot = (node_slot >= 0) ? (uint32_t)node_slot : nSlots;
+    uint32_t offset = guard + slot * slotLen + guard;
+
+    // 가입은 슈퍼프레임마다 50% 확률로만 시도 (가입 충돌 완화)
+    if (node_slot < 0 && (randr(0, 1) == 0)) return true;
+
+    // 수렴 전에는 HSI 오차 그대로 벌어짐: 비콘부터 내 슬롯까지 벌어질 시간이 가드(드리프트 몫)를
+    // 넘으면 이웃 슬롯을 침범하므로 이번 슈퍼프레임은 쉼 (앞쪽 슬롯은 수렴 전에도 송신 가능)
+    uint32_t margin = TDMA_TURNAROUND_MS + Radio.GetWakeupTime();
+    uint32_t drift = TDMA_DriftMs(offset + slotLen, TDMA_NodeClockLocked() ? TDMA_CLOCK_PPM_TRIM
+                                                                             : TDMA_CLOCK_PPM_RAW);
+    if (guard < margin || drift > guard - margin) {
+        TimerStop(&SlotTimer);
+        return true;
+    }
+
+    TimerStop(&SlotTimer);
+    TimerSetValue(&SlotTimer, TDMA_ToLocal(offset));
+    TimerStart(&SlotTimer);
+    return true;
+}
+
+// 보낸(또는 버린) 항목 비우기 (인터럽트 막힌 상태에서 호출)
+static void TDMA_NodeTxPop(TDMA_TxItem_t *item)
+{
+    item->len = 0;
+    if (item != &tx_latest) {
+        tx_head = (tx_head + 1) % TDMA_TX_QUEUE_LEN;
+        tx_count--;
+    }
+}
+
+bool TDMA_NodeQueue(const uint8_t *data, uint8_t len, AirtimeClass_t cls)
+{
+    if (len == 0 || len > TDMA_MAX_PAYLOAD) return false;
+    __disable_irq();
+    TDMA_TxItem_t *item;
+    if (cls == AIRTIME_CLASS_PERIODIC) {
+        item = &tx_latest;                       // 아직 못 보낸 이전 값은 새 값으로 대체
+    } else {
+        if (tx_count >= TDMA_TX_QUEUE_LEN) {     // 가득 차면 거절 (보류 중인 이벤트를 덮어쓰지 않음)
+            __enable_irq();
+            return false;
+        }
+        item = &tx_fifo[(tx_head + tx_count) % TDMA_TX_QUEUE_LEN];
+        tx_count++;
+    }
+    memcpy(item->buf, data, len);
+    item->len = len;
+    item->cls = cls;
+    item->queued_tick = HAL_GetTick();
+    __enable_irq();
+    return true;
+}
+
+bool TDMA_NodePoll(uint8_t *frame, uint8_t *len)
+{
+    if (!slot_due) return false;
+    slot_due = 0;
+
+    if (node_slot < 0) {
+        frame[0] = TDMA_FRAME_JOIN;
+        frame[1] = node_id;
+        *len = 2;
+        return AirtimeAdmit(AIRTIME_CLASS_CONTROL, Radio.TimeOnAir(MODEM_LORA, 2)) == AIRTIME_SEND;
+    }
+
+    // FIFO 앞쪽 (이벤트/원시) 먼저, 비어 있을 때만 주기 데이터
+    __disable_irq();
+    TDMA_TxItem_t *item = (tx_count > 0) ? &tx_fifo[tx_head] : &tx_latest;
+    __enable_irq();
+    if (item->len == 0) return false;
+
+    switch (AirtimeAdmit(item->cls, Radio.TimeOnAir(MODEM_LORA, TDMA_UPLINK_HDR_LEN + item->len))) {
+    case AIRTIME_SEND:
+        break;
+    case AIRTIME_DROP:
+        __disable_irq();
+        TDMA_NodeTxPop(item);
+        __enable_irq();
+        return false;
+    case AIRTIME_DEFER:
+    default:
+        return false;   // 다음 슈퍼프레임에 다시 (주기 데이터는 그 사이 새 값이 오면 덮어씀)
+    }
+
+    __disable_irq();
+    uint32_t wait = HAL_GetTick() - item->queued_tick;
+    if (wait > 0xFFFF) wait = 0xFFFF;
+    frame[0] = TDMA_FRAME_UPLINK;
+    frame[1] = node_id;
+    frame[2] = node_seq++;
+    frame[3] = (uint8_t)(wait & 0xFF);
+    frame[4] = (uint8_t)(wait >> 8);
+    memcpy(&frame[TDMA_UPLINK_HDR_LEN], item->buf, item->len);
+    *len = TDMA_UPLINK_HDR_LEN + item->len;
+    TDMA_NodeTxPop(item);
+    __enable_irq();
+    return true;
+}
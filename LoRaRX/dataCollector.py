@@ -1,9 +1,24 @@
+import argparse
 import json
+import os
+import queue
+import re
+import sys
 import time
 import requests
 import serial.tools.list_ports
 import threading
-import uuid
+
+# Shared collector modules live in DashBoard/
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "DashBoard"))
+from linereader import SerialReader, merged_lines
+from metrics import CollectorMetrics
+from tracing import Tracer
+from spool import Spool
+from uplink import Uplink
+from dispatch import Dispatcher, Schema, NUMBER
+from eventtable import EventTable, RecentKeys
+from laserstore import LaserStore, GAP_LINEAR, GAP_HOLD, GAP_DROP
 
 # --- Configuration ---
 BASE_URL_LASER = "http://localhost:8080/api/sensor/laser"
@@ -17,47 +32,165 @@ LIVE_UUID = "LIVE"
 TIMEOUT = 1
 MAX_SAMPLES = 250
 FRAGMENT_TIMEOUT = 10.0  # Seconds to wait for all fragments
+SAMPLE_PERIOD_MS = 20  # Laser sample interval on the TX board
+LASER_GAP_FILL = GAP_LINEAR  # How lost samples are filled: GAP_LINEAR, GAP_HOLD or GAP_DROP
+LASER_MIN_FILL = 0.5  # Fraction of samples needed to send an event that timed out
+EVENT_TTL = 120.0  # Seconds an idle short id keeps its UUID
+EVENT_REOPEN_GAP = 3.0  # IR start after this much silence opens a new event for the same id
+EVENT_MAX = 4096  # Upper bound on remembered ids (least recently used dropped first)
+CLEANUP_PERIOD = 0.5  # Seconds between incomplete-fragment sweeps
+SPOOL_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "uplink_spool.db")
+REPLAY_RATE = 50  # Backlog replay rate after an outage [requests/s]
+METRICS_PORT = 9109  # Default port for http://127.0.0.1:<port>/metrics (0 disables)
+TRACE_SLOW_S = 2.0  # Print the per-stage breakdown of events slower than this end to end
+
+# "[#node]", "[#node:seq]" or "[#node:seq rx=<gw tick> q=<node wait ms> air=<ms>]"
+NODE_PREFIX = re.compile(r"\[#(\d+)(?::(\d+))?((?: \w+=\d+)*)\]")
+LINK_FIELD = re.compile(r"(\w+)=(\d+)")
+DEDUP_WINDOW = 10.0  # Seconds a (node, seq) is remembered for cross-gateway de-duplication
 
 # --- Global State ---
-# Dictionary to store partial laser data: { uuid: { 'timestamp': time, 'samples': [None]*250, 'received_count': 0, 'binId': default } }
-laser_buffers = {}
-# Mapping from short 'id' (from TX) to full 'uuid' (for Server)
-id_map = {}
+# Partial laser events, one preallocated row per uuid (see laserstore.py)
+laser_store = LaserStore(MAX_SAMPLES, SAMPLE_PERIOD_MS, LASER_GAP_FILL, LASER_MIN_FILL)
+# Mapping from short 'id' (from TX) to full 'uuid' (for Server), expires idle ids
+event_table = EventTable(EVENT_TTL, EVENT_REOPEN_GAP, EVENT_MAX)
+# Uplinks already handled, so copies heard by other gateways are skipped
+recent_packets = RecentKeys(DEDUP_WINDOW)
 
 # --- Serial Connection ---
-ports = serial.tools.list_ports.comports()
-print("=== Available COM Ports ===")
-for port in ports:
-    print(f"Port: {port.device}")
-    print(f"Description: {port.description}")
-    print(f"HWID: {port.hwid}")
-    print("---------------------------")
-
-ser = None
-while True:
-    time.sleep(0.1)
-    portName = input("Enter the port name (or 'test' for test mode): ")
-    if portName == "test":
-        break
-    try:
-        ser = serial.Serial(
-            port=portName,
-            baudrate=115200,
-            parity=serial.PARITY_NONE,
-            stopbits=serial.STOPBITS_ONE,
-            bytesize=serial.EIGHTBITS,
-            timeout=1
-        )
-        print(f"[OK] Connected to {portName}")
-        break
-    except Exception as e:
-        print(f"[ERROR] Connection failed: {e}")
+def open_port(port_name):
+    return serial.Serial(
+        port=port_name,
+        baudrate=115200,
+        parity=serial.PARITY_NONE,
+        stopbits=serial.STOPBITS_ONE,
+        bytesize=serial.EIGHTBITS,
+        timeout=1
+    )
+
+# Each gateway is {"name", "port"}. With --config the list comes from a JSON
+# file (see gateways.json) and every port gets its own reader thread; without it
+# a single port is picked interactively as before.
+# The bin belongs to the TX node, not to the gateway that happened to hear it:
+# gateways overlap and de-duplication keeps whichever copy arrives first, so the
+# config maps node id -> bin under "nodes" ("bin" is the default for unlisted nodes).
+parser = argparse.ArgumentParser(description="LoRa gateway data collector")
+parser.add_argument("--config", help="JSON file listing gateway serial ports")
+parser.add_argument("--metrics-port", type=int, default=METRICS_PORT,
+                    help="port for the local /metrics endpoint (0 disables)")
+args = parser.parse_args()
+
+gateways = []
+node_bins = {}
+if args.config:
+    with open(args.config, encoding="utf-8") as f:
+        cfg = json.load(f)
+    BIN_ID_DEFAULT = cfg.get("bin", BIN_ID_DEFAULT)
+    node_bins = {int(node): int(b) for node, b in cfg.get("nodes", {}).items()}
+    for gw in cfg["gateways"]:
+        if "bin" in gw:
+            print(f"[WARN] {gw.get('name', gw['port'])}: per-gateway 'bin' is ignored, "
+                  f"map node ids to bins under 'nodes'")
+        gateways.append({
+            "name": gw.get("name", gw["port"]),
+            "port": gw["port"],
+        })
+    print(f"[OK] {len(gateways)} gateway(s), {len(node_bins)} node bin(s) from {args.config}")
+else:
+    ports = serial.tools.list_ports.comports()
+    print("=== Available COM Ports ===")
+    for port in ports:
+        print(f"Port: {port.device}")
+        print(f"Description: {port.description}")
+        print(f"HWID: {port.hwid}")
+        print("---------------------------")
+
+    while True:
+        time.sleep(0.1)
+        portName = input("Enter the port name (or 'test' for test mode): ")
+        if portName == "test":
+            # No board: a virtual port fed with simulated gateway output (DashBoard/simulator.py)
+            from simulator import start_test_port
+            try:
+                gateways.append({"name": "test", "port": start_test_port("lorarx")})
+                break
+            except Exception as e:
+                print(f"[ERROR] Test mode unavailable: {e}")
+                continue
+        try:
+            open_port(portName).close()
+            print(f"[OK] Connected to {portName}")
+            gateways.append({"name": portName, "port": portName})
+            break
+        except Exception as e:
+            print(f"[ERROR] Connection failed: {e}")
 
 # --- Helper Functions ---
 
+# --- Uplink ---
+# All HTTP traffic goes through background lanes so the serial loop never waits on the server.
+
+def on_Laser_done(resp, err):
+    if err is not None:
+        if isinstance(err, requests.exceptions.ConnectionError):
+            print(f"[ERROR] Connection failed: Server not running at {BASE_URL_LASER}")
+        elif isinstance(err, requests.exceptions.Timeout):
+            print(f"[ERROR] Request timeout")
+        else:
+            print(f"[ERROR] {err}")
+        return
+
+    print("\n" + "=" * 60)
+    if resp.status_code == 200:
+        result = resp.json()
+        print("[SUCCESS] Server Response!")
+        print("=" * 60)
+
+        if result.get('isSuccess'):
+            res_data = result.get('result', {})
+            print(f"Event ID: {res_data.get('uuid')}")
+            print(f"Valid Cup: {res_data.get('isValidCup')}")
+            print(f"Pattern: {res_data.get('patternType')} - {res_data.get('patternDescription')}")
+            print(f"Diameter: {res_data.get('minDiameterMm'):.1f}mm -> {res_data.get('maxDiameterMm'):.1f}mm")
+
+            if res_data.get('rejectionReason'):
+                print(f"[WARNING] Rejection: {res_data.get('rejectionReason')}")
+        else:
+            print(f"[ERROR] {result.get('message')}")
+    else:
+        print(f"[ERROR] HTTP Error {resp.status_code}")
+        print(f"Response: {resp.text}")
+
+    print("=" * 60 + "\n")
+
+def log_status(tag):
+    """Callback that just prints the HTTP status."""
+    def done(resp, err):
+        if err is not None:
+            print(f"[{tag}] Error: {err}")
+        else:
+            print(f"[{tag}] {resp.request.method} -> Status: {resp.status_code}")
+    return done
+
+# Everything is written to the on-disk spool before upload, so a server outage
+# only delays data; the backlog is replayed once the server answers again.
+spool = Spool(SPOOL_PATH)
+uplink = Uplink(spool=spool, replay_rate=REPLAY_RATE)
+uplink.add_lane("laser",  workers=2, maxlen=200, on_done=on_Laser_done)
+uplink.add_lane("cup",    workers=2, on_done=log_status("CUP"))
+uplink.add_lane("liquid", workers=1, on_done=log_status("LIQUID"))
+uplink.add_lane("sonic",  workers=1, on_done=log_status("SONIC"))
+uplink.add_lane("ir",     workers=2, on_done=log_status("IR"))
+uplink.start()
+
+# --- Dispatch ---
+# Message type -> handler. Records carry an explicit "m" type field; older TX
+# firmware without it is classified by the legacy key checks in dispatch.py.
+dispatcher = Dispatcher()
+
 def request_Laser(assembled_data):
     """
-    Sends the reassembled laser data to the server.
+    Queues the reassembled laser data for the server.
     assembled_data structure:
     {
         "uuid": "...",
@@ -65,60 +198,30 @@ def request_Laser(assembled_data):
         "samples": [ {"distanceMm": 45, "timeMsec": 0}, ... ]
     }
     """
-    try:
-        print("\n" + "=" * 60)
-        print("Sending LASER data to server...")
-        print(f"URL: {BASE_URL_LASER}/insertion-event")
-        print(f"UUID: {assembled_data.get('uuid')}")
-        print(f"Samples: {len(assembled_data['samples'])} measurements")
-
-        # The server expects a JSON with 'uuid', 'binId', 'samples', etc.
-        # We might need to add 'binWidthMm' if the server requires it, or the server handles it.
-        # Assuming server needs 'binId' and 'samples'.
-        
-        payload = {
-            "uuid": assembled_data.get("uuid"),
-            "binId": assembled_data.get("binId", BIN_ID_DEFAULT),
-            "samples": assembled_data.get("samples"),
-            # Add other fields if necessary, e.g., "binWidthMm": 100
-        }
-
-        response = requests.post(
-            f"{BASE_URL_LASER}/insertion-event",
-            json=payload,
-            headers={"Content-Type": "application/json"},
-            timeout=5
-        )
-
-        if response.status_code == 200:
-            result = response.json()
-            print("\n[SUCCESS] Server Response!")
-            print("=" * 60)
-
-            if result.get('isSuccess'):
-                res_data = result.get('result', {})
-                print(f"Event ID: {res_data.get('uuid')}")
-                print(f"Valid Cup: {res_data.get('isValidCup')}")
-                print(f"Pattern: {res_data.get('patternType')} - {res_data.get('patternDescription')}")
-                print(f"Diameter: {res_data.get('minDiameterMm'):.1f}mm -> {res_data.get('maxDiameterMm'):.1f}mm")
-
-                if res_data.get('rejectionReason'):
-                    print(f"[WARNING] Rejection: {res_data.get('rejectionReason')}")
-            else:
-                print(f"[ERROR] {result.get('message')}")
-        else:
-            print(f"[ERROR] HTTP Error {response.status_code}")
-            print(f"Response: {response.text}")
+    # The server expects a JSON with 'uuid', 'binId', 'samples', etc.
+    # We might need to add 'binWidthMm' if the server requires it, or the server handles it.
+    payload = {
+        "uuid": assembled_data.get("uuid"),
+        "binId": assembled_data.get("binId", BIN_ID_DEFAULT),
+        "samples": assembled_data.get("samples"),
+        # Add other fields if necessary, e.g., "binWidthMm": 100
+    }
 
-        print("=" * 60 + "\n")
+    print(f"[LASER] Queued UUID {payload['uuid']} ({len(payload['samples'])} samples)")
+    uplink.submit("laser", "POST", f"{BASE_URL_LASER}/insertion-event", payload)
 
-    except requests.exceptions.ConnectionError:
-        print(f"[ERROR] Connection failed: Server not running at {BASE_URL_LASER}")
-    except requests.exceptions.Timeout:
-        print(f"[ERROR] Request timeout")
-    except Exception as e:
-        print(f"[ERROR] {e}")
+@dispatcher.register("laser", Schema({"samples": list}))
+def request_Laser_legacy(data):
+    """Legacy laser (full packet in one message) - just in case"""
+    assembled = {
+        "uuid": data.get("uuid", "UNKNOWN"),
+        "binId": data.get("binId", BIN_ID_DEFAULT),
+        "samples": data.get("samples", [])
+    }
+    request_Laser(assembled)
 
+@dispatcher.register("sonic", Schema({"distanceCm": NUMBER, "fillRate": NUMBER},
+                                     {"binId": int, "uuid": str}))
 def request_sonic(data):
     bin_id = data.get("binId", BIN_ID_DEFAULT)
     dist_cm = data.get("distanceCm")
@@ -138,23 +241,11 @@ def request_sonic(data):
         "fillRate": fill_rate,
     }
 
-    try:
-        print("\n" + "=" * 60)
-        print("Sending SONIC data to server...")
-        print(f"URL: {BASE_URL_SONIC}")
-        print("Payload:", payload)
-
-        resp = requests.post(
-            BASE_URL_SONIC,
-            json=payload,
-            headers={"Content-Type": "application/json"},
-            timeout=5,
-        )
-        print(f"[HTTP] Status: {resp.status_code}")
-
-    except Exception as e:
-        print("[ERROR]", e)
+    # A newer LIVE reading replaces one that hasn't been sent yet
+    key = (bin_id, uuid) if uuid == LIVE_UUID else None
+    uplink.submit("sonic", "POST", BASE_URL_SONIC, payload, key=key)
 
+@dispatcher.register("cup", Schema({"weight": NUMBER}, {"uuid": str}))
 def request_Cup(data):
     uuid_val = data.get("uuid")
     weight = data.get("weight")
@@ -165,17 +256,15 @@ def request_Cup(data):
 
     payload = {
         "uuid": uuid_val,
-        "binId": BIN_ID_DEFAULT,
+        "binId": data.get("binId", BIN_ID_DEFAULT),
         "weight": weight,
         "type": cup_type
     }
 
-    try:
-        resp = requests.patch(BASE_URL_CUP, json=payload, timeout=3)
-        print(f"[CUP] PATCH -> Status: {resp.status_code}")
-    except Exception as e:
-        print(f"[CUP] Error: {e}")
+    # PATCH: only the latest weight per uuid matters
+    uplink.submit("cup", "PATCH", BASE_URL_CUP, payload, key=uuid_val)
 
+@dispatcher.register("liquid", Schema({"weight": NUMBER}, {"uuid": str}))
 def request_Liquid(data):
     uuid_val = data.get("uuid")
     weight = data.get("weight")
@@ -184,43 +273,30 @@ def request_Liquid(data):
     if weight is None or weight <= 0:
         return
 
-    url = f"{BASE_URL_LIQUID}/by-bin/{BIN_ID_DEFAULT}"
+    bin_id = data.get("binId", BIN_ID_DEFAULT)
+    url = f"{BASE_URL_LIQUID}/by-bin/{bin_id}"
     payload = {
         "weight": weight,
         "uuid": uuid_val,
         "type": liquid_type
     }
 
-    try:
-        resp = requests.patch(url, json=payload, timeout=3)
-        print(f"[LIQUID] PATCH -> Status: {resp.status_code}")
-    except Exception as e:
-        print(f"[LIQUID] Error: {e}")
+    uplink.submit("liquid", "PATCH", url, payload, key=(bin_id, uuid_val))
 
+@dispatcher.register("ir", Schema({"beamBlocked": bool}, {"binId": int, "uuid": str}))
 def request_IR(data):
     # Sniff binId and uuid to help with laser data association
     uuid_val = data.get("uuid")
     bin_id = data.get("binId")
     
     if uuid_val and bin_id:
-        # If we already have a buffer for this UUID, update the binId
-        if uuid_val in laser_buffers:
-            laser_buffers[uuid_val]['binId'] = bin_id
-        else:
-            # Create a new buffer entry with this binId
-            laser_buffers[uuid_val] = {
-                'timestamp': time.time(),
-                'samples': [None] * MAX_SAMPLES,
-                'received_count': 0,
-                'binId': bin_id
-            }
+        # Creates the reassembly slot if needed, otherwise just updates its binId
+        laser_store.set_bin(uuid_val, bin_id, time.monotonic())
 
-    try:
-        resp = requests.post(BASE_URL_IR, json=data, timeout=3)
-        print(f"[IR] SEND -> Status: {resp.status_code}")
-    except Exception as e:
-        print(f"[IR] Error: {e}")
+    # Every IR event counts, so never coalesce these
+    uplink.submit("ir", "POST", BASE_URL_IR, data)
 
+@dispatcher.register("frag", Schema({"idx": int, "data": list}, {"uuid": str}))
 def process_laser_fragment(data):
     uuid_val = data.get("uuid")
     idx = data.get("idx")
@@ -229,76 +305,133 @@ def process_laser_fragment(data):
     if not uuid_val or idx is None or not fragment_data:
         return
 
-    # Initialize buffer if not exists
-    if uuid_val not in laser_buffers:
-        laser_buffers[uuid_val] = {
-            'timestamp': time.time(),
-            'samples': [None] * MAX_SAMPLES,
-            'received_count': 0,
-            'binId': BIN_ID_DEFAULT # Default, might be updated by IR event
-        }
-
-    buffer = laser_buffers[uuid_val]
-    buffer['timestamp'] = time.time() # Update timestamp to keep alive
-
-    # Fill samples
-    for i, val in enumerate(fragment_data):
-        target_idx = idx + i
-        if target_idx < MAX_SAMPLES:
-            if buffer['samples'][target_idx] is None:
-                buffer['samples'][target_idx] = val
-                buffer['received_count'] += 1
-
-    # Check if complete (or sufficiently complete?)
-    # For now, let's assume we need all 250 samples.
-    # Or we can check if we received the last chunk?
-    # Since we know MAX_SAMPLES is 250, we can check if received_count is close to 250.
-    # But packets might be lost. We should probably have a timeout-based flush or a strict check.
-    
-    if buffer['received_count'] >= MAX_SAMPLES:
-        # Reassemble and send
+    # binId (node default) might be updated later by the IR event
+    if laser_store.insert(uuid_val, idx, fragment_data, data.get("binId", BIN_ID_DEFAULT), time.monotonic()):
         finalize_laser_data(uuid_val)
 
+# Load-cell health / fill / weight-event records are only logged here
+@dispatcher.register("h")
+@dispatcher.register("fill")
+@dispatcher.register("ev")
+def log_telemetry(data):
+    print("Telemetry:", data)
+
+# Gateway's once-a-minute LoRa airtime budget report (sx1272/airtime.c)
+@dispatcher.register("airtime", Schema({"airtime": dict}))
+def log_airtime(data):
+    a = data["airtime"]
+    print(f"[AIRTIME] used {a.get('usedMs')}/{a.get('budgetMs')} ms (level {a.get('level')}), "
+          f"pkts {a.get('pkts')}, deferred {a.get('deferred')}, dropped {a.get('dropped')}")
+
 def finalize_laser_data(uuid_val):
-    if uuid_val not in laser_buffers:
+    if uuid_val not in laser_store:
         return
 
-    buffer = laser_buffers[uuid_val]
-    
-    # Construct samples list with timeMsec
-    formatted_samples = []
-    for i, dist in enumerate(buffer['samples']):
-        # If packet was lost, dist might be None. We can skip or interpolate.
-        # For now, let's use 0 or skip.
-        if dist is not None:
-            formatted_samples.append({
-                "distanceMm": dist,
-                "timeMsec": i * 20 # Assuming 20ms interval
-            })
-    
+    received = laser_store.received(uuid_val)
+    bin_id, samples = laser_store.pop(uuid_val)
+    if received < MAX_SAMPLES:
+        print(f"[WARN] Flushing partial laser data for UUID {uuid_val}. "
+              f"Received: {received}/{MAX_SAMPLES}, gaps filled ({LASER_GAP_FILL})")
+
     assembled_data = {
         "uuid": uuid_val,
-        "binId": buffer['binId'],
-        "samples": formatted_samples
+        "binId": bin_id,
+        "samples": samples
     }
 
     request_Laser(assembled_data)
-    
-    # Remove from buffer
-    del laser_buffers[uuid_val]
 
 def cleanup_buffers():
-    """Removes old incomplete buffers"""
-    now = time.time()
-    to_remove = []
-    for uuid_val, buffer in laser_buffers.items():
-        if now - buffer['timestamp'] > FRAGMENT_TIMEOUT:
-            print(f"[WARN] Dropping incomplete laser data for UUID {uuid_val}. Received: {buffer['received_count']}/{MAX_SAMPLES}")
-            # Optional: Send partial data?
-            to_remove.append(uuid_val)
-    
-    for uuid_val in to_remove:
-        del laser_buffers[uuid_val]
+    """Flushes (or drops, if too sparse) events that stopped receiving fragments"""
+    now = time.monotonic()
+    event_table.expire(now)
+    for uuid_val in laser_store.expired(now - FRAGMENT_TIMEOUT):
+        if laser_store.flushable(uuid_val):
+            finalize_laser_data(uuid_val)
+        else:
+            print(f"[WARN] Dropping incomplete laser data for UUID {uuid_val}. "
+                  f"Received: {laser_store.received(uuid_val)}/{MAX_SAMPLES}")
+            laser_store.discard(uuid_val)
+
+def handle_line(line, gw, t_rx=None):
+    if not line:
+        return
+
+    # Check for bracketed debug messages first (e.g. [#1]...)
+    node = 0
+    link = None
+    if line.startswith('[') and ']' in line:
+        # It might be "[#1:23] {...}" (TDMA gateway prefixes node id and uplink seq)
+        m = NODE_PREFIX.match(line)
+        if m:
+            node = int(m.group(1))
+            # Several gateways in range all forward the same uplink; keep the first
+            if m.group(2) is not None and recent_packets.seen((node, int(m.group(2))), time.monotonic()):
+                return
+            # Gateway RX tick, node queue wait and airtime, for latency tracing
+            link = {k: int(v) for k, v in LINK_FIELD.findall(m.group(3))}
+            link["node"] = node
+            if m.group(2) is not None:
+                link["seq"] = int(m.group(2))
+        # Try to find the JSON part
+        json_start = line.find('{')
+        if json_start != -1:
+            # Extract JSON
+            line = line[json_start:]
+
+    # JSON Parsing
+    if line.startswith('{') and '}' in line:
+        try:
+            # Find the last closing brace to handle cases like "OK {json}"
+            json_end = line.rindex('}') + 1
+            json_str = line[:json_end]
+
+            data = json.loads(json_str)
+
+            # The sending node's bin (same whichever gateway's copy won de-duplication)
+            data.setdefault('binId', node_bins.get(node, BIN_ID_DEFAULT))
+
+            # --- UUID Mapping Logic ---
+            # The TX sends a short 'id' (e.g. "0001") that it reuses; the server needs
+            # a full UUID per event. event_table gives one UUID per (node, id, epoch)
+            # and forgets ids that have gone quiet (see eventtable.py).
+            short_id = data.get('id')
+            if short_id:
+                # If it's the special LIVE id, keep it as is
+                if short_id == "LIVE":
+                    data['uuid'] = "LIVE"
+                else:
+                    # An IR start after a pause is a new event even if the id is reused
+                    new_event = data.get('beamBlocked') is True
+                    uuid_val, epoch, is_new = event_table.lookup(node, short_id, time.monotonic(), new_event)
+                    if is_new:
+                        print(f"[INFO] New Event Detected via {gw['name']}. "
+                              f"Mapped ID {node}/{short_id}#{epoch} -> {uuid_val}")
+                    data['uuid'] = uuid_val
+
+            # Ensure 'uuid' key exists if 'id' was used
+            if 'uuid' not in data and 'id' in data:
+                 data['uuid'] = data['id'] # Fallback
+
+            # --------------------------
+
+            # Exactly one handler per record, picked by message type (see dispatch.py).
+            # Each record is traced from its firmware ticks to the server ack (see tracing.py);
+            # tick stamps are per node clock, so the reference is per gateway and node.
+            for rec, _ in tracer.records(data, t_rx, f"{gw['name']}/{node}", link):
+                dispatcher.dispatch(rec)
+            metrics.decoded(t_rx)
+
+        except json.JSONDecodeError:
+            # Not a JSON or incomplete
+            metrics.parse_errors.inc(kind="json")
+        except Exception as e:
+            metrics.parse_errors.inc(kind="processing")
+            print(f"[ERROR] Processing Error: {e}")
+    else:
+        # Print non-JSON lines for debugging
+        if line:
+            print(f"[STM32 {gw['name']}] {line}")
 
 # --- Main Loop ---
 print("\n" + "=" * 60)
@@ -306,131 +439,40 @@ print("Data Collector Started (Fragment Support)")
 print("Waiting for data from STM32...")
 print("=" * 60 + "\n")
 
-full_buffer = ""
+# One reader thread per gateway, all feeding one queue. Each blocks on its port
+# (no polling) and reopens it if the board is unplugged. A short timeout on the
+# queue keeps the fragment cleanup running when idle.
+line_queue = queue.Queue(10000)
+readers = []
+for gw in gateways:
+    def reopen(port=gw["port"]):
+        return open_port(port)
+    try:
+        ser = open_port(gw["port"])
+    except Exception as e:
+        print(f"[ERROR] {gw['name']}: {e} (will keep retrying)")
+        ser = None
+    readers.append(SerialReader(ser, gw["name"], out=line_queue, reopen=reopen).start())
+gateway_by_name = {gw["name"]: gw for gw in gateways}
+
+# Counters per message type, serial rate, parse errors, HTTP codes, queue depths,
+# spool size and per-stage latency histograms (see DashBoard/metrics.py)
+metrics = CollectorMetrics(dispatcher, uplink, readers, spool, line_queue)
+tracer = Tracer(metrics, TRACE_SLOW_S)
+uplink.observer = tracer.on_uplink
+uplink.context = tracer.attach
+if args.metrics_port:
+    metrics.registry.serve(args.metrics_port)
+    print(f"[OK] Metrics at http://127.0.0.1:{args.metrics_port}/metrics")
+
+lines = merged_lines(line_queue, timeout=CLEANUP_PERIOD)
+last_cleanup = time.monotonic()
 
 while True:
-    time.sleep(0.01)
-    
-    # Periodic cleanup
-    cleanup_buffers()
-
-    if ser and ser.in_waiting > 0:
-        try:
-            chunk = ser.read(ser.in_waiting).decode('utf-8', errors='ignore')
-            full_buffer += chunk
-
-            while '\n' in full_buffer or '\r' in full_buffer:
-                line_end = full_buffer.find('\n')
-                if line_end == -1:
-                    line_end = full_buffer.find('\r')
-
-                line = full_buffer[:line_end].strip()
-                full_buffer = full_buffer[line_end + 1:]
-
-                if not line:
-                    continue
-                
-                # Check for bracketed debug messages first (e.g. [#1]...)
-                if line.startswith('[') and ']' in line:
-                    # It might be "[#1] {...}"
-                    # Try to find the JSON part
-                    json_start = line.find('{')
-                    if json_start != -1:
-                        # Extract JSON
-                        line = line[json_start:]
-
-                # JSON Parsing
-                if line.startswith('{') and '}' in line:
-                    try:
-                        # Find the last closing brace to handle cases like "OK {json}"
-                        json_end = line.rindex('}') + 1
-                        json_str = line[:json_end]
-                        
-                        data = json.loads(json_str)
-
-                        # --- UUID Mapping Logic ---
-                        # The TX might send 'id' instead of 'uuid'.
-                        # We need to map short 'id' (e.g. "0001") to a full UUID for the server.
-                        
-                        short_id = data.get('id')
-                        if short_id:
-                            # If it's the special LIVE id, keep it as is
-                            if short_id == "LIVE":
-                                data['uuid'] = "LIVE"
-                            else:
-                                # Check if we need to generate a new UUID
-                                # If this is a new IR event (beamBlocked=true), force a new UUID?
-                                # Or just use existing mapping?
-                                # Problem: If we reuse mapping forever, all events will have same UUID.
-                                # Solution: If 'beamBlocked' is present (IR event), we assume it's the start of a new event.
-                                # But we might receive multiple IR packets for same event.
-                                # Let's generate a new UUID if 'id' is not in map, OR if it's an IR event start?
-                                # Actually, simpler: If 'id' is not in map, generate one.
-                                # We rely on the script being restarted or some timeout to clear old IDs?
-                                # Better: If we see 'beamBlocked': true, we *could* refresh, but risk splitting event if multiple IRs trigger.
-                                # Let's stick to: Create if missing.
-                                
-                                if short_id not in id_map:
-                                    id_map[short_id] = str(uuid.uuid4())
-                                    print(f"[INFO] New Event Detected. Mapped ID {short_id} -> {id_map[short_id]}")
-                                
-                                data['uuid'] = id_map[short_id]
-                        
-                        # Ensure 'uuid' key exists if 'id' was used
-                        if 'uuid' not in data and 'id' in data:
-                             data['uuid'] = data['id'] # Fallback
-
-                        # --------------------------
-
-                        # 1. Laser Fragment (has 'idx' and 'data')
-                        if 'idx' in data and 'data' in data:
-                            process_laser_fragment(data)
-                        
-                        # 2. Legacy Laser (full packet) - just in case
-                        elif 'binWidthMm' in data:
-                            # Convert to new format if needed or just pass
-                            # But request_Laser expects our assembled format now.
-                            # Let's adapt it quickly.
-                            samples = data.get('samples', [])
-                            assembled = {
-                                "uuid": data.get("uuid", "UNKNOWN"),
-                                "binId": data.get("binId", BIN_ID_DEFAULT),
-                                "samples": samples
-                            }
-                            request_Laser(assembled)
-
-                        # 3. Cup
-                        elif 'type' in data and data['type'] == 'CUP':
-                            request_Cup(data)
-
-                        # 4. Liquid
-                        elif 'type' in data and data['type'] == 'WATER':
-                            request_Liquid(data)
-
-                        # 5. Ultrasonic
-                        elif 'distanceCm' in data:
-                            request_sonic(data)
-
-                        # 6. IR Event
-                        elif 'beamBlocked' in data:
-                            # If this is a new IR event, maybe we should force refresh the UUID?
-                            # If we assume IR comes first, we can do:
-                            # id_map[short_id] = str(uuid.uuid4())
-                            # But let's be careful about duplicates.
-                            # For now, let's just use the mapping logic above.
-                            request_IR(data)
-
-                    except json.JSONDecodeError:
-                        # Not a JSON or incomplete
-                        pass
-                    except Exception as e:
-                        print(f"[ERROR] Processing Error: {e}")
-                else:
-                    # Print non-JSON lines for debugging
-                    if line:
-                        print(f"[STM32] {line}")
+    t_rx, gw_name, line = next(lines)
+    if line is not None:
+        handle_line(line, gateway_by_name[gw_name], t_rx)
 
-        except Exception as e:
-            print(f"[ERROR] Serial Read Error: {e}")
-            full_buffer = ""
-            continue
+    if time.monotonic() - last_cleanup >= CLEANUP_PERIOD:
+        cleanup_buffers()
+        last_cleanup = time.monotonic()
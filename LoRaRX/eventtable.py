@@ -0,0 +1,112 @@
+import heapq
+import itertools
+import uuid
+from collections import OrderedDict
+
+
+class _Entry:
+    __slots__ = ("uuid", "epoch", "last_seen")
+
+    def __init__(self, uuid_val, epoch, now):
+        self.uuid = uuid_val
+        self.epoch = epoch
+        self.last_seen = now
+
+
+class EventTable:
+    """
+    Maps the TX board's short event id to a server UUID.
+
+    Entries are keyed by (node, short id) and carry an epoch, so the full
+    identity of an event is (node, short id, epoch):
+      - an entry expires `ttl` seconds after its last packet; the next packet
+        with that short id opens a new epoch with a fresh UUID
+      - an IR start (beamBlocked) for an entry idle longer than `reopen_gap`
+        also opens a new epoch, so a quickly reused id doesn't merge events
+      - at most `max_entries` are kept; the least recently used goes first
+
+    Expiry is driven by a min-heap of deadlines. Touching an entry only updates
+    its last_seen; a popped deadline that turns out to be stale is pushed back
+    with the real one. Each call costs O(expired * log n) instead of a full scan.
+    """
+
+    def __init__(self, ttl=120.0, reopen_gap=3.0, max_entries=4096):
+        self.ttl = ttl
+        self.reopen_gap = reopen_gap
+        self.max_entries = max_entries
+        self.entries = OrderedDict()        # (node, short_id) -> _Entry, LRU order
+        self.heap = []                      # (deadline, seq, key)
+        self._seq = itertools.count()
+        self._epoch = itertools.count(1)
+
+    def __len__(self):
+        return len(self.entries)
+
+    def lookup(self, node, short_id, now, new_event=False):
+        """Returns (uuid, epoch, is_new) for the current event of (node, short_id)."""
+        key = (node, short_id)
+        e = self.entries.get(key)
+        if e is not None and (now - e.last_seen > self.ttl or
+                              (new_event and now - e.last_seen > self.reopen_gap)):
+            del self.entries[key]
+            e = None
+
+        if e is None:
+            e = _Entry(str(uuid.uuid4()), next(self._epoch), now)
+            self.entries[key] = e
+            heapq.heappush(self.heap, (now + self.ttl, next(self._seq), key))
+            while len(self.entries) > self.max_entries:
+                self.entries.popitem(last=False)
+            return e.uuid, e.epoch, True
+
+        e.last_seen = now
+        self.entries.move_to_end(key)
+        return e.uuid, e.epoch, False
+
+    def expire(self, now):
+        """Drops entries idle longer than ttl. Returns [(node, short_id, epoch, uuid)]."""
+        out = []
+        heap = self.heap
+        while heap and heap[0][0] <= now:
+            _, _, key = heapq.heappop(heap)
+            e = self.entries.get(key)
+            if e is None:
+                continue                    # already replaced or evicted
+            deadline = e.last_seen + self.ttl
+            if deadline > now:
+                heapq.heappush(heap, (deadline, next(self._seq), key))
+                continue
+            del self.entries[key]
+            out.append((key[0], key[1], e.epoch, e.uuid))
+
+        # Entries replaced by a new epoch leave a stale deadline behind; rebuild
+        # once those outnumber the live ones so the heap stays proportional
+        if len(heap) > 2 * len(self.entries) + 64:
+            self.heap = [(e.last_seen + self.ttl, next(self._seq), k) for k, e in self.entries.items()]
+            heapq.heapify(self.heap)
+        return out
+
+
+class RecentKeys:
+    """
+    Keys seen in the last `window` seconds (insertion order == time order, so
+    expiry just pops from the front). Used to drop the same uplink heard by
+    several gateways: key = (node, seq).
+    """
+
+    def __init__(self, window=10.0):
+        self.window = window
+        self.seen_at = OrderedDict()
+
+    def seen(self, key, now):
+        """True if key was already seen within the window; records it otherwise."""
+        d = self.seen_at
+        while d:
+            k, t = next(iter(d.items()))
+            if now - t <= self.window:
+                break
+            del d[k]
+        if key in d:
+            return True
+        d[key] = now
+        return False
@@ -0,0 +1,162 @@
+import heapq
+import itertools
+
+import numpy as np
+
+GAP_LINEAR = "linear"   # interpolate between the nearest received samples
+GAP_HOLD = "hold"       # repeat the last received sample
+GAP_DROP = "drop"       # leave lost samples out (old behaviour)
+
+
+class LaserStore:
+    """
+    Reassembly store for fragmented laser events.
+
+    All events share preallocated 2-D arrays (one row per event slot):
+      dist[slot, i]  - distance sample i [mm]
+      mask[slot, i]  - True once sample i has been received
+    A fragment is one slice assignment, so the per-sample Python loop is gone.
+    Slots are recycled through a free list and the arrays double when full,
+    so hundreds of concurrent events cost a few row writes each.
+    """
+
+    def __init__(self, n_samples=250, period_ms=20, gap=GAP_LINEAR, min_fill=0.5, capacity=64):
+        self.n = n_samples
+        self.period_ms = period_ms
+        self.gap = gap
+        self.min_fill = min_fill        # fraction needed to flush a partial event
+        self.slots = {}                 # uuid -> slot
+        self.free = []
+        self.heap = []                  # (touched, seq, uuid), lazily refreshed in expired()
+        self._seq = itertools.count()
+        self._alloc(capacity)
+
+    def _alloc(self, capacity):
+        old = getattr(self, "dist", None)
+        start = 0 if old is None else old.shape[0]
+
+        dist = np.zeros((capacity, self.n), dtype=np.int32)
+        mask = np.zeros((capacity, self.n), dtype=bool)
+        count = np.zeros(capacity, dtype=np.int32)
+        bin_id = np.zeros(capacity, dtype=np.int32)
+        touched = np.full(capacity, np.inf)         # last fragment time (inf = free slot)
+        if old is not None:
+            dist[:start] = self.dist
+            mask[:start] = self.mask
+            count[:start] = self.count
+            bin_id[:start] = self.bin_id
+            touched[:start] = self.touched
+        self.dist, self.mask, self.count, self.bin_id, self.touched = dist, mask, count, bin_id, touched
+        self.owner = getattr(self, "owner", []) + [None] * (capacity - start)
+        self.free.extend(range(capacity - 1, start - 1, -1))
+
+    def __len__(self):
+        return len(self.slots)
+
+    def __contains__(self, uuid_val):
+        return uuid_val in self.slots
+
+    def open(self, uuid_val, bin_id, now):
+        """Slot for uuid_val, created (with bin_id) if it doesn't exist yet."""
+        slot = self.slots.get(uuid_val)
+        if slot is None:
+            if not self.free:
+                self._alloc(self.dist.shape[0] * 2)
+            slot = self.free.pop()
+            self.mask[slot] = False
+            self.count[slot] = 0
+            self.bin_id[slot] = bin_id
+            self.owner[slot] = uuid_val
+            self.slots[uuid_val] = slot
+            heapq.heappush(self.heap, (now, next(self._seq), uuid_val))
+        self.touched[slot] = now
+        return slot
+
+    def set_bin(self, uuid_val, bin_id, now):
+        self.bin_id[self.open(uuid_val, bin_id, now)] = bin_id
+
+    def insert(self, uuid_val, idx, values, bin_id, now):
+        """Store one fragment starting at sample idx. Returns True once every sample is in."""
+        slot = self.open(uuid_val, bin_id, now)
+        if idx < 0 or idx >= self.n:
+            return False
+        end = min(idx + len(values), self.n)
+        seg = self.mask[slot, idx:end]
+        # The first copy of a sample wins (duplicates from several gateways are identical anyway)
+        fresh = ~seg
+        self.dist[slot, idx:end][fresh] = np.asarray(values[:end - idx], dtype=np.int32)[fresh]
+        self.count[slot] += int(np.count_nonzero(fresh))
+        seg[:] = True
+        return self.count[slot] >= self.n
+
+    def received(self, uuid_val):
+        slot = self.slots.get(uuid_val)
+        return 0 if slot is None else int(self.count[slot])
+
+    def flushable(self, uuid_val):
+        """True if a partial event has enough samples to be worth sending."""
+        return self.received(uuid_val) >= self.min_fill * self.n
+
+    def pop(self, uuid_val):
+        """
+        Remove the event and return (binId, samples) with lost samples filled per
+        the gap policy. samples is [{"distanceMm", "timeMsec"}, ...].
+        """
+        slot = self.slots.pop(uuid_val)
+        self._release(slot)
+        m = self.mask[slot]
+        d = self.dist[slot]
+        t = np.arange(self.n, dtype=np.int32) * self.period_ms
+
+        if self.count[slot] == 0:
+            return int(self.bin_id[slot]), []
+
+        if self.gap == GAP_DROP or self.count[slot] == self.n:
+            keep = np.flatnonzero(m)
+            dist, times = d[keep], t[keep]
+        elif self.gap == GAP_HOLD:
+            # Index of the most recent received sample at or before i (leading gap takes the first one)
+            idx = np.where(m, np.arange(self.n), -1)
+            np.maximum.accumulate(idx, out=idx)
+            idx[idx < 0] = np.flatnonzero(m)[0]
+            dist, times = d[idx], t
+        else:
+            have = np.flatnonzero(m)
+            dist = np.rint(np.interp(np.arange(self.n), have, d[have])).astype(np.int32)
+            times = t
+
+        samples = [{"distanceMm": dv, "timeMsec": tv}
+                   for dv, tv in zip(dist.tolist(), times.tolist())]
+        return int(self.bin_id[slot]), samples
+
+    def discard(self, uuid_val):
+        slot = self.slots.pop(uuid_val, None)
+        if slot is not None:
+            self._release(slot)
+
+    def expired(self, cutoff):
+        """
+        uuids whose last fragment arrived before cutoff; the caller must pop()
+        or discard() each of them.
+        Only heap entries older than cutoff are looked at; one that was touched
+        since is pushed back with its new time, so idle calls cost O(1).
+        """
+        out = []
+        heap = self.heap
+        while heap and heap[0][0] < cutoff:
+            _, _, uuid_val = heapq.heappop(heap)
+            slot = self.slots.get(uuid_val)
+            if slot is None:
+                continue                    # already flushed
+            touched = float(self.touched[slot])
+            if touched < cutoff:
+                out.append(uuid_val)
+            else:
+                heapq.heappush(heap, (touched, next(self._seq), uuid_val))
+        return out
+
+    def _release(self, slot):
+        # Row contents stay valid until the slot is reused (pop reads them after this)
+        self.touched[slot] = np.inf
+        self.owner[slot] = None
+        self.free.append(slot)
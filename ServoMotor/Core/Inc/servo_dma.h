@@ -0,0 +1,54 @@
+#ifndef INC_SERVO_DMA_H_
+#define INC_SERVO_DMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+
+// TIM2 4채널 서보 (PA0=CH1, PB3=CH2, PB10=CH3, PB2=CH4)
+//
+// TIM2 는 1MHz 카운트 (PSC 83), 주기 20000 → CCR = 펄스폭 [us]
+// 프레임(20ms)마다 CCR1~4 를 업데이트 이벤트 DMA 버스트(DMAR)로 한 번에 씀
+//   - 프레임 표는 원형 DMA 버퍼 두 칸(반 버퍼씩)으로 나눠서
+//     DMA 가 한쪽을 읽는 동안 반대쪽을 다음 프레임들로 채움 (반/완료 인터럽트)
+//   - 프레임마다 CPU 가 할 일은 없음, 반 버퍼(SERVO_HALF_FRAMES 프레임)마다 한 번 계산
+//   - 큐에 넣은 이동은 최대 버퍼 한 바퀴(2 * SERVO_HALF_FRAMES 프레임) 뒤에 시작
+
+#define SERVO_CHANNELS          4
+#define SERVO_PERIOD_US         20000   // PWM 주기 (50Hz)
+#define SERVO_PERIOD_MS         ( SERVO_PERIOD_US / 1000 )
+#define SERVO_MIN_PULSE_US      500     // 0도
+#define SERVO_MAX_PULSE_US      2500    // 180도
+#define SERVO_MAX_ANGLE         180
+
+#define SERVO_HALF_FRAMES       5       // 반 버퍼 프레임 수 (100ms 마다 채움)
+#define SERVO_MOVE_QUEUE_LEN    4
+
+#define SERVO_HOLD              0       // 이동 목표에서 "이 채널은 그대로"
+
+// 여러 채널 동시 이동: 모든 채널이 같은 시간에 출발해서 같은 시간에 도착
+typedef struct {
+    uint16_t pulse[SERVO_CHANNELS];     // 목표 펄스폭 [us] (SERVO_HOLD = 현재값 유지)
+    uint32_t duration;                  // 이동 시간 [ms]
+} ServoDMA_Move_t;
+
+// 초기 펄스로 표를 채우고 PWM + DMA 버스트 시작 (pulse 가 NULL 이면 전부 가운데)
+void ServoDMA_Init(TIM_HandleTypeDef *htim, const uint16_t pulse[SERVO_CHANNELS]);
+
+// 이동 추가 (큐가 차면 false)
+bool ServoDMA_Queue(const ServoDMA_Move_t *move);
+
+// 각도 [deg] → 펄스폭 [us]
+uint16_t ServoDMA_AngleToPulse(uint16_t deg);
+
+// 이동 중이거나 큐에 남아 있으면 true
+bool ServoDMA_IsBusy(void);
+
+// HAL_TIM_PeriodElapsedHalfCpltCallback / HAL_TIM_PeriodElapsedCallback 에서 호출
+void ServoDMA_OnHalfTransfer(void);
+void ServoDMA_OnTransferComplete(void);
+
+// 다음 n 프레임의 CCR1~4 를 frames[n][SERVO_CHANNELS] 에 생성 (DMA 없이도 호출 가능)
+void ServoDMA_Generate(uint32_t *frames, uint32_t n);
+
+#endif /* INC_SERVO_DMA_H_ */
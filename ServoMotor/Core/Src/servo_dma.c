@@ -0,0 +1,140 @@
+#include "main.h"
+#include "servo_dma.h"
+#include <string.h>
+
+#define SERVO_TABLE_FRAMES  ( 2 * SERVO_HALF_FRAMES )
+#define SERVO_CENTER_US     ( ( SERVO_MIN_PULSE_US + SERVO_MAX_PULSE_US ) / 2 )
+
+// DMA 가 CCR1~4 로 버스트 전송하는 원형 표 (TIM2 CCR 은 32비트)
+static uint32_t table[SERVO_TABLE_FRAMES][SERVO_CHANNELS];
+
+// 이동 큐 (넣는 쪽: 메인 루프, 빼는 쪽: DMA 인터럽트)
+static ServoDMA_Move_t queue[SERVO_MOVE_QUEUE_LEN];
+static volatile uint8_t q_head = 0;
+static volatile uint8_t q_tail = 0;
+
+// 현재 이동
+static volatile bool moving = false;
+static uint16_t cur[SERVO_CHANNELS];        // 마지막으로 낸 펄스폭 [us]
+static uint16_t from[SERVO_CHANNELS];       // 이번 이동 출발 [us]
+static uint16_t to[SERVO_CHANNELS];         // 이번 이동 도착 [us]
+static uint32_t frame_idx;                  // 이번 이동에서 진행한 프레임 수
+static uint32_t frame_total;                // 이번 이동 전체 프레임 수
+
+static uint16_t ServoDMA_Clamp(uint16_t us)
+{
+    if (us < SERVO_MIN_PULSE_US) return SERVO_MIN_PULSE_US;
+    if (us > SERVO_MAX_PULSE_US) return SERVO_MAX_PULSE_US;
+    return us;
+}
+
+// 0~1 (Q16) 진행률 → 부드러운 위치 비율 3u^2 - 2u^3 (Q16)
+// 출발/도착에서 속도 0, 중간에서 최대 → 모든 채널이 같은 곡선을 따라가므로 동시에 도착
+static uint32_t ServoDMA_Ease(uint32_t u)
+{
+    uint64_t u2 = ((uint64_t)u * u) >> 16;
+    uint64_t u3 = (u2 * u) >> 16;
+    return (uint32_t)(3 * u2 - 2 * u3);
+}
+
+static bool ServoDMA_StartNext(void)
+{
+    if (q_tail == q_head) return false;
+
+    const ServoDMA_Move_t *m = &queue[q_tail];
+    for (int ch = 0; ch < SERVO_CHANNELS; ch++) {
+        from[ch] = cur[ch];
+        to[ch] = (m->pulse[ch] == SERVO_HOLD) ? cur[ch] : ServoDMA_Clamp(m->pulse[ch]);
+    }
+    frame_total = m->duration / SERVO_PERIOD_MS;
+    if (frame_total == 0) frame_total = 1;
+    frame_idx = 0;
+    q_tail = (q_tail + 1) % SERVO_MOVE_QUEUE_LEN;
+    moving = true;
+    return true;
+}
+
+void ServoDMA_Generate(uint32_t *frames, uint32_t n)
+{
+    for (uint32_t f = 0; f < n; f++) {
+        if (moving || ServoDMA_StartNext()) {
+            frame_idx++;
+            uint32_t u = (uint32_t)(((uint64_t)frame_idx << 16) / frame_total);
+            uint32_t s = ServoDMA_Ease(u);
+
+            for (int ch = 0; ch < SERVO_CHANNELS; ch++) {
+                int32_t delta = (int32_t)to[ch] - (int32_t)from[ch];
+                cur[ch] = (uint16_t)(from[ch] + (int32_t)(((int64_t)delta * s + 0x8000) >> 16));
+            }
+            if (frame_idx >= frame_total) {
+                memcpy(cur, to, sizeof(cur));
+                moving = false;
+            }
+        }
+
+        for (int ch = 0; ch < SERVO_CHANNELS; ch++) {
+            frames[f * SERVO_CHANNELS + ch] = cur[ch];
+        }
+    }
+}
+
+void ServoDMA_Init(TIM_HandleTypeDef *htim, const uint16_t pulse[SERVO_CHANNELS])
+{
+    for (int ch = 0; ch < SERVO_CHANNELS; ch++) {
+        cur[ch] = (pulse != NULL) ? ServoDMA_Clamp(pulse[ch]) : SERVO_CENTER_US;
+    }
+    moving = false;
+    q_head = q_tail = 0;
+    ServoDMA_Generate(&table[0][0], SERVO_TABLE_FRAMES);
+
+    if (htim == NULL) return;
+
+    // 첫 주기는 CCR 직접, 이후는 업데이트 DMA 버스트
+    __HAL_TIM_SET_COMPARE(htim, TIM_CHANNEL_1, cur[0]);
+    __HAL_TIM_SET_COMPARE(htim, TIM_CHANNEL_2, cur[1]);
+    __HAL_TIM_SET_COMPARE(htim, TIM_CHANNEL_3, cur[2]);
+    __HAL_TIM_SET_COMPARE(htim, TIM_CHANNEL_4, cur[3]);
+
+    HAL_TIM_DMABurst_MultiWriteStart(htim, TIM_DMABASE_CCR1, TIM_DMA_UPDATE,
+                                     &table[0][0], TIM_DMABURSTLENGTH_4TRANSFERS,
+                                     SERVO_TABLE_FRAMES * SERVO_CHANNELS);
+
+    HAL_TIM_PWM_Start(htim, TIM_CHANNEL_1);
+    HAL_TIM_PWM_Start(htim, TIM_CHANNEL_2);
+    HAL_TIM_PWM_Start(htim, TIM_CHANNEL_3);
+    HAL_TIM_PWM_Start(htim, TIM_CHANNEL_4);
+}
+
+bool ServoDMA_Queue(const ServoDMA_Move_t *move)
+{
+    uint8_t next = (q_head + 1) % SERVO_MOVE_QUEUE_LEN;
+    if (next == q_tail) return false;   // 큐 가득
+
+    queue[q_head] = *move;
+    q_head = next;
+    return true;
+}
+
+uint16_t ServoDMA_AngleToPulse(uint16_t deg)
+{
+    if (deg > SERVO_MAX_ANGLE) deg = SERVO_MAX_ANGLE;
+    return (uint16_t)(SERVO_MIN_PULSE_US +
+                      ((uint32_t)deg * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) + SERVO_MAX_ANGLE / 2) / SERVO_MAX_ANGLE);
+}
+
+bool ServoDMA_IsBusy(void)
+{
+    return moving || (q_tail != q_head);
+}
+
+// DMA 가 뒤쪽 반을 읽기 시작 → 앞쪽 반을 다음 프레임으로
+void ServoDMA_OnHalfTransfer(void)
+{
+    ServoDMA_Generate(&table[0][0], SERVO_HALF_FRAMES);
+}
+
+// DMA 가 처음으로 돌아감 → 뒤쪽 반을 다음 프레임으로
+void ServoDMA_OnTransferComplete(void)
+{
+    ServoDMA_Generate(&table[SERVO_HALF_FRAMES][0], SERVO_HALF_FRAMES);
+}
@@ -0,0 +1,6 @@
+#ifndef STUB_MAIN_H_
+#define STUB_MAIN_H_
+
+#include "stm32f4xx_hal.h"
+
+#endif /* STUB_MAIN_H_ */
@@ -0,0 +1,68 @@
+#ifndef STUB_STM32F4XX_HAL_H_
+#define STUB_STM32F4XX_HAL_H_
+
+// 호스트 테스트용 HAL 대역 (타이머/DMA 는 아무것도 안 함, 플래시는 테스트가 메모리로 흉내)
+
+#include <stdint.h>
+
+typedef struct {
+    int unused;
+} TIM_HandleTypeDef;
+
+typedef enum { HAL_OK = 0, HAL_ERROR = 1 } HAL_StatusTypeDef;
+
+#define TIM_CHANNEL_1                   0x00U
+#define TIM_CHANNEL_2                   0x04U
+#define TIM_CHANNEL_3                   0x08U
+#define TIM_CHANNEL_4                   0x0CU
+#define TIM_DMABASE_CCR1                0x0DU
+#define TIM_DMA_UPDATE                  0x100U
+#define TIM_DMABURSTLENGTH_4TRANSFERS   0x300U
+
+#define __HAL_TIM_SET_COMPARE(h, ch, v) ((void)(h), (void)(ch), (void)(v))
+
+static inline HAL_StatusTypeDef HAL_TIM_DMABurst_MultiWriteStart(TIM_HandleTypeDef *htim, uint32_t base,
+                                                                 uint32_t src, uint32_t *buf,
+                                                                 uint32_t burst, uint32_t len)
+{
+    (void)htim; (void)base; (void)src; (void)buf; (void)burst; (void)len;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t ch)
+{
+    (void)htim; (void)ch;
+    return HAL_OK;
+}
+
+// 밀리초 틱 (telemetry.c): 본체는 쓰는 테스트에서 정의
+uint32_t HAL_GetTick(void);
+
+// 플래시 (calib.c): 본체는 쓰는 테스트에서 정의
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t Sector;
+    uint32_t NbSectors;
+    uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+#define FLASH_SECTOR_6                  6U
+#define FLASH_SECTOR_7                  7U
+#define FLASH_TYPEERASE_SECTORS         0x00U
+#define FLASH_VOLTAGE_RANGE_3           0x02U
+#define FLASH_TYPEPROGRAM_WORD          0x02U
+#define FLASH_FLAG_EOP                  0x01U
+#define FLASH_FLAG_OPERR                0x02U
+#define FLASH_FLAG_WRPERR               0x10U
+#define FLASH_FLAG_PGAERR               0x20U
+#define FLASH_FLAG_PGPERR               0x40U
+#define FLASH_FLAG_PGSERR               0x80U
+#define __HAL_FLASH_CLEAR_FLAG(f)       ((void)(f))
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *init, uint32_t *error);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t type, uint32_t addr, uint64_t data);
+
+#endif /* STUB_STM32F4XX_HAL_H_ */
@@ -0,0 +1,266 @@
+// 보정표/보정값 저장소 (Core/Src/calib.c) 호스트 테스트
+//   - Calib_LutEval: 노드 위, 노드 사이, 양 끝 밖을 double 보간과 비교
+//   - Calib_FitLut: 알려진 비선형 곡선에서 뽑은 기준점 → 표 → 곡선과 비교 (왕복)
+//   - Calib_FitScale: 원점 지나는 직선
+//   - Calib_Save/Load: 섹터 6/7 주소에 메모리를 깔고 플래시 쓰기를 흉내
+//       쓰다 만 칸 (전원 끊김), CRC 깨진 칸, 섹터 넘김
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "main.h"
+#include "calib.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            failures++;                                             \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);             \
+            printf(__VA_ARGS__);                                    \
+            printf("\n");                                           \
+        }                                                           \
+    } while (0)
+
+// ===================== 플래시 흉내 =====================
+// 지우면 0xFF, 쓰기는 비트를 0 으로만 (실제 플래시처럼). program_budget 워드를 쓰면 그 뒤로 실패
+
+static uint8_t *flash;
+static long program_budget = -1;       // -1: 무제한
+static int erase_count = 0;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) { return HAL_OK; }
+HAL_StatusTypeDef HAL_FLASH_Lock(void) { return HAL_OK; }
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *init, uint32_t *error)
+{
+    uint32_t addr = (init->Sector == FLASH_SECTOR_6) ? CALIB_ADDR_A : CALIB_ADDR_B;
+    memset((void *)(uintptr_t)addr, 0xFF, CALIB_SECTOR_SIZE);
+    *error = 0xFFFFFFFFu;
+    erase_count++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t type, uint32_t addr, uint64_t data)
+{
+    (void)type;
+    if (program_budget == 0) return HAL_ERROR;
+    if (program_budget > 0) program_budget--;
+    uint32_t *w = (uint32_t *)(uintptr_t)addr;
+    *w &= (uint32_t)data;
+    return HAL_OK;
+}
+
+static void flash_erase_all(void)
+{
+    memset(flash, 0xFF, 2 * CALIB_SECTOR_SIZE);
+}
+
+// ===================== 보정표 =====================
+
+// double 기준: 노드 사이 선형 보간 (범위 밖은 양 끝 구간에서 자름)
+static double lut_ref(const Calib_Lut_t *lut, double net)
+{
+    double w = (double)(1 << lut->shift);
+    double x = (net + lut->bias) / w;
+    if (x < 0) x = 0;
+    if (x > CALIB_LUT_NODES - 1) x = CALIB_LUT_NODES - 1;
+    int i = (int)x;
+    if (i >= CALIB_LUT_NODES - 1) i = CALIB_LUT_NODES - 2;
+    double f = x - i;
+    return lut->mg[i] + (lut->mg[i + 1] - lut->mg[i]) * f;
+}
+
+// 로드셀 흉내: 약간 휘는 곡선 raw → g (만재에서 직선 대비 ~3 %)
+static double curve_g(double raw)
+{
+    return raw / 420.0 * (1.0 + 0.03 * raw / 2000000.0);
+}
+
+static void check_lut_eval(void)
+{
+    Calib_Lut_t lut = { .valid = 1, .shift = 10, .bias = 1 << 10 };
+    for (int j = 0; j < CALIB_LUT_NODES; j++)
+        lut.mg[j] = -5000 + j * 123457 + (j * j) * 3001;
+
+    // 노드 위는 그 노드 값 그대로
+    for (int j = 0; j < CALIB_LUT_NODES - 1; j++) {
+        int32_t x = (j << lut.shift) - lut.bias;
+        CHECK(Calib_LutEval(&lut, x) == lut.mg[j], "node %d: %ld != %ld",
+              j, (long)Calib_LutEval(&lut, x), (long)lut.mg[j]);
+    }
+
+    // 노드 사이: double 보간과 1 mg 이내 (내림 시프트)
+    for (int32_t x = -lut.bias; x < (15 << lut.shift); x += 37) {
+        double ref = lut_ref(&lut, x);
+        int32_t got = Calib_LutEval(&lut, x);
+        CHECK(got <= ref + 1e-9 && got > ref - 1.0, "x=%ld: %ld vs %.3f", (long)x, (long)got, ref);
+    }
+
+    // 양 끝 밖: 아래는 첫 노드, 위는 마지막 노드 (마지막 구간 끝에서 한 칸 모자란 값까지)
+    CHECK(Calib_LutEval(&lut, -lut.bias - 1) == lut.mg[0], "below range");
+    CHECK(Calib_LutEval(&lut, INT32_MIN / 2) == lut.mg[0], "far below range");
+    int32_t hi = Calib_LutEval(&lut, INT32_MAX / 2);
+    int32_t step = (lut.mg[CALIB_LUT_NODES - 1] - lut.mg[CALIB_LUT_NODES - 2]) >> lut.shift;
+    CHECK(hi <= lut.mg[CALIB_LUT_NODES - 1] && hi >= lut.mg[CALIB_LUT_NODES - 1] - step - 1,
+          "above range %ld vs last node %ld", (long)hi, (long)lut.mg[CALIB_LUT_NODES - 1]);
+    CHECK(Calib_LutEval(&lut, (16 << lut.shift) - lut.bias) == hi, "end not clamped");
+}
+
+static void check_fit_lut(void)
+{
+    // 곡선에서 기준점 12 개 (0.5 kg ~ 5 kg, 일부러 순서 섞음)
+    Calib_Point_t pts[CALIB_MAX_POINTS];
+    const double grams[CALIB_MAX_POINTS] = { 2000, 500, 5000, 1000, 3500, 1500,
+                                             4500, 2500, 750, 3000, 4000, 250 };
+    for (int k = 0; k < CALIB_MAX_POINTS; k++) {
+        // g → raw 는 곡선을 거꾸로 (이분법)
+        double lo = 0, hi = 1e7;
+        for (int it = 0; it < 100; it++) {
+            double mid = (lo + hi) / 2;
+            if (curve_g(mid) < grams[k]) lo = mid; else hi = mid;
+        }
+        pts[k].raw = (int32_t)lrint(lo);
+        pts[k].grams = (float)curve_g(pts[k].raw);
+    }
+
+    Calib_Lut_t lut;
+    CHECK(Calib_FitLut(pts, CALIB_MAX_POINTS, &lut), "fit failed");
+    CHECK(lut.valid == 1 && lut.bias == (1 << lut.shift), "lut header");
+    int32_t raw_max = 0;
+    for (int k = 0; k < CALIB_MAX_POINTS; k++)
+        if (pts[k].raw > raw_max) raw_max = pts[k].raw;
+    CHECK(((CALIB_LUT_NODES - 2) << lut.shift) >= raw_max + raw_max / 4, "lut does not cover +25%%");
+    CHECK(((CALIB_LUT_NODES - 2) << (lut.shift - 1)) < raw_max + raw_max / 4, "lut wider than needed");
+    CHECK(lut.mg[1] == 0, "zero node %ld", (long)lut.mg[1]);
+
+    // 왕복: 영점 ~ 가장 무거운 점 사이 어디서나 곡선과 0.05 % FS 이내
+    double fs_mg = curve_g(raw_max) * 1000.0, worst = 0;
+    for (int32_t x = 0; x <= raw_max; x += 97) {
+        double err = fabs(Calib_LutEval(&lut, x) - curve_g(x) * 1000.0);
+        if (err > worst) worst = err;
+    }
+    CHECK(worst < fs_mg * 0.0005, "round trip max error %.1f mg (fs %.0f mg)", worst, fs_mg);
+
+    // 기준점 위에서는 기준 무게와 거의 같음 (노드 사이 꺾임만큼)
+    for (int k = 0; k < CALIB_MAX_POINTS; k++) {
+        double err = fabs(Calib_LutEval(&lut, pts[k].raw) - pts[k].grams * 1000.0);
+        CHECK(err < fs_mg * 0.0005, "point %d off by %.1f mg", k, err);
+    }
+
+    // 기준점 하나: 영점과 잇는 직선
+    Calib_Point_t one = { 420000, 1000.0f };
+    CHECK(Calib_FitLut(&one, 1, &lut), "single point fit failed");
+    CHECK(abs(Calib_LutEval(&lut, 210000) - 500000) <= 1, "single point midpoint %ld",
+          (long)Calib_LutEval(&lut, 210000));
+
+    // 같은 raw 는 하나만, 0 이하 raw 는 무시, 쓸 점이 없으면 실패
+    Calib_Point_t dup[3] = { { 420000, 1000.0f }, { 420000, 1000.0f }, { -5, 3.0f } };
+    CHECK(Calib_FitLut(dup, 3, &lut), "duplicate fit failed");
+    CHECK(abs(Calib_LutEval(&lut, 420000) - 1000000) <= 1, "duplicate point value");
+    Calib_Point_t bad[2] = { { 0, 1.0f }, { -100, 2.0f } };
+    CHECK(!Calib_FitLut(bad, 2, &lut), "fit with no positive raw should fail");
+    CHECK(!Calib_FitLut(bad, 0, &lut), "fit with no points should fail");
+}
+
+static void check_fit_scale(void)
+{
+    Calib_Point_t pts[4] = { { 42050, 100.0f }, { 210250, 500.0f }, { 420500, 1000.0f }, { 841000, 2000.0f } };
+    float s = Calib_FitScale(pts, 4);
+    CHECK(fabsf(s - 420.5f) < 1e-3f, "scale %.5f", s);
+    CHECK(Calib_FitScale(pts, 0) == 0.0f, "empty scale");
+}
+
+// ===================== 저장소 =====================
+
+static Calib_Data_t sample(int k)
+{
+    Calib_Data_t d;
+    memset(&d, 0, sizeof(d));
+    d.n_cells = 1;
+    d.cell[0].offset = 1000 + k;
+    d.cell[0].scale = 420.0f + k;
+    return d;
+}
+
+static void check_store(void)
+{
+    Calib_Data_t d;
+    flash_erase_all();
+
+    CHECK(!Calib_Load(&d), "blank flash loaded a record");
+    CHECK(Calib_GetSeq() == 0, "blank seq");
+
+    Calib_Data_t a = sample(1), b = sample(2), c = sample(3);
+    CHECK(Calib_Save(&a), "save 1");
+    CHECK(Calib_Save(&b), "save 2");
+    CHECK(Calib_Load(&d) && d.cell[0].offset == b.cell[0].offset && Calib_GetSeq() == 2, "load 2");
+
+    // 세 번째 저장 도중 전원 끊김: 워드 몇 개만 써짐 → 쓰다 만 칸은 버리고 두 번째 레코드
+    program_budget = 5;
+    CHECK(!Calib_Save(&c), "torn save reported success");
+    program_budget = -1;
+    CHECK(Calib_Load(&d) && d.cell[0].offset == b.cell[0].offset && Calib_GetSeq() == 2,
+          "torn slot not skipped (seq %lu)", (unsigned long)Calib_GetSeq());
+
+    // 다음 저장은 쓰다 만 칸 다음 칸에 (다시 부팅한 것처럼 Load 후)
+    CHECK(Calib_Save(&c), "save after torn slot");
+    CHECK(Calib_Load(&d) && d.cell[0].offset == c.cell[0].offset && Calib_GetSeq() == 3, "load 3");
+    const uint32_t *slot3 = (const uint32_t *)(uintptr_t)(CALIB_ADDR_A + 3 * CALIB_SLOT_SIZE);
+    CHECK(slot3[0] == CALIB_MAGIC, "third record not in slot 3");
+
+    // 마지막 레코드 본문 비트 하나 깨짐 (CRC 불일치) → 그 전 레코드
+    uint8_t *body = (uint8_t *)(uintptr_t)(CALIB_ADDR_A + 3 * CALIB_SLOT_SIZE + 16);
+    *body &= (uint8_t)~0x01u;
+    CHECK(Calib_Load(&d) && d.cell[0].offset == b.cell[0].offset && Calib_GetSeq() == 2,
+          "corrupt record not rejected");
+
+    // 섹터 넘김: A 가 다 차면 B 를 지우고 이어 씀, 이전 레코드는 새 레코드가 써질 때까지 남음
+    flash_erase_all();
+    Calib_Load(&d);
+    erase_count = 0;
+    const uint32_t slots = CALIB_SECTOR_SIZE / CALIB_SLOT_SIZE;
+    for (uint32_t k = 0; k < slots + 2; k++) {
+        Calib_Data_t x = sample((int)k);
+        CHECK(Calib_Save(&x), "save %lu", (unsigned long)k);
+    }
+    CHECK(erase_count == 0, "blank sector B erased %d times", erase_count);
+    CHECK(Calib_Load(&d) && d.cell[0].offset == 1000 + (int32_t)slots + 1 &&
+          Calib_GetSeq() == slots + 2, "load after sector switch (seq %lu)", (unsigned long)Calib_GetSeq());
+    const uint32_t *b0 = (const uint32_t *)(uintptr_t)CALIB_ADDR_B;
+    CHECK(b0[0] == CALIB_MAGIC, "sector B not used");
+
+    // B 도 다 차면 A 를 지우고 씀
+    for (uint32_t k = 0; k < slots; k++) {
+        Calib_Data_t x = sample(5000 + (int)k);
+        CHECK(Calib_Save(&x), "save B %lu", (unsigned long)k);
+    }
+    CHECK(erase_count == 1, "sector A erase count %d", erase_count);
+    CHECK(Calib_Load(&d) && d.cell[0].offset == 1000 + 5000 + (int32_t)slots - 1, "load after second switch");
+}
+
+int main(void)
+{
+    // calib.c 는 섹터 6/7 절대 주소를 읽으므로 거기에 메모리를 깜
+    flash = mmap((void *)(uintptr_t)CALIB_ADDR_A, 2 * CALIB_SECTOR_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (flash != (uint8_t *)(uintptr_t)CALIB_ADDR_A) {
+        printf("test_calib: cannot map flash at 0x%08lx\n", (unsigned long)CALIB_ADDR_A);
+        return 1;
+    }
+
+    check_lut_eval();
+    check_fit_lut();
+    check_fit_scale();
+    check_store();
+
+    if (failures) {
+        printf("test_calib: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("test_calib: ok\n");
+    return 0;
+}
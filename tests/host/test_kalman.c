@@ -0,0 +1,217 @@
+// 정수 칼만 필터 (Core/Src/kalman.c) 를 같은 식의 double 구현과 비교 (호스트)
+//   - 잡음 + 계단 + 기울기 입력에서 정수 추정이 double 추정을 따라가는지
+//   - 가장 큰 혁신 (int32 양 끝을 오가는 입력) 에서도 오버플로 없이 목표로 수렴하는지 (UBSan)
+//   - KALMAN_BENCH 로 빌드하면 갱신 한 번 시간도 비교 (make bench)
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "kalman.h"
+
+#define DT_MS       100
+#define NOISE_MG    500
+#define Q_MIN       1000LL
+#define Q_MAX       100000000000LL
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            failures++;                                             \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);             \
+            printf(__VA_ARGS__);                                    \
+            printf("\n");                                           \
+        }                                                           \
+    } while (0)
+
+// 같은 모델/같은 적응 규칙의 double 구현 (기준값)
+typedef struct {
+    double w, v, p00, p01, p11, r, q, q_min, q_max, dt;
+    int init;
+} KalmanF_t;
+
+static void kf_float_init(KalmanF_t *k)
+{
+    k->dt = DT_MS / 1000.0;
+    k->r = (double)NOISE_MG * NOISE_MG;
+    k->q_min = Q_MIN;
+    k->q_max = Q_MAX;
+    k->q = Q_MAX;
+    k->init = 0;
+}
+
+static double kf_float_update(KalmanF_t *k, double z)
+{
+    if (!k->init) {
+        k->w = z; k->v = 0; k->p00 = k->r; k->p01 = 0; k->p11 = k->r; k->init = 1;
+        return k->w;
+    }
+    const double dt = k->dt, q = k->q;
+    k->w += k->v * dt;
+    k->p00 += 2 * k->p01 * dt + k->p11 * dt * dt + q * dt * dt * dt / 3;
+    k->p01 += k->p11 * dt + q * dt * dt / 2;
+    k->p11 += q * dt;
+
+    double innov = z - k->w;
+    double s = k->p00 + k->r;
+    if (innov * innov > (double)KALMAN_GATE * KALMAN_GATE * s) {
+        k->q = k->q_max;
+        if (k->p00 < innov * innov) {
+            k->p00 = innov * innov;
+            s = k->p00 + k->r;
+        }
+    } else if (k->q > k->q_min) {
+        k->q = fmax(k->q / 4, k->q_min);
+    }
+    double k0 = k->p00 / s, k1 = k->p01 / s;
+    k->w += k0 * innov;
+    k->v += k1 * innov;
+    double p00 = k->p00, p01 = k->p01;
+    k->p00 = fmax(0, p00 - k0 * p00);
+    k->p01 = p01 - k0 * p01;
+    k->p11 = fmax(0, k->p11 - k1 * p01);
+    return k->w;
+}
+
+// 고정 시드 가우스 잡음 (Box-Muller)
+static uint32_t rng_state = 12345;
+
+static double uniform01(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return ((rng_state >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(void)
+{
+    return sqrt(-2.0 * log(uniform01())) * cos(2 * M_PI * uniform01());
+}
+
+// 시험 입력: 빈 판 → 컵 올림 → 물 붓기(기울기) → 내림 → 큰 통, 전부 0.5g 잡음
+#define N_SAMPLES   3000
+
+static int32_t trace_mg(int i)
+{
+    double w;
+    if (i < 300)       w = 0;
+    else if (i < 800)  w = 152000;
+    else if (i < 1100) w = 152000 + (i - 800) * 1000.0;     // 10 g/s
+    else if (i < 1600) w = 452000;
+    else if (i < 2000) w = 0;
+    else if (i < 2500) w = 5000000;                          // 5 kg
+    else               w = 5000000 - 3000;
+    return (int32_t)lrint(w + NOISE_MG * gauss());
+}
+
+static void compare_float(void)
+{
+    Kalman_t kf;
+    KalmanF_t ref;
+    Kalman_Init(&kf, DT_MS, NOISE_MG, Q_MIN, Q_MAX);
+    kf_float_init(&ref);
+
+    double max_diff = 0, sum2 = 0;
+    int n = 0;
+    for (int i = 0; i < N_SAMPLES; i++) {
+        int32_t z = trace_mg(i);
+        double wi = Kalman_Update(&kf, z);
+        double wf = kf_float_update(&ref, z);
+        double d = fabs(wi - wf);
+        if (d > max_diff) max_diff = d;
+        sum2 += d * d;
+        n++;
+    }
+    double rms = sqrt(sum2 / n);
+    printf("kalman fixed vs float: max %.1f mg, rms %.1f mg over %d samples\n", max_diff, rms, n);
+    // 정수 반올림/Q16 이득 차이만 있어야 함: 평소엔 수 mg, 큰 계단 직후 한 샘플만 조금 더
+    CHECK(max_diff < 200, "fixed-point drifts from float: max %.1f mg", max_diff);
+    CHECK(rms < 10, "fixed-point rms diff %.1f mg (biased rounding?)", rms);
+
+    // 정지 상태: 잡음을 걸러서 분산이 측정 잡음보다 작아야 함
+    CHECK(Kalman_Var(&kf) < (int64_t)NOISE_MG * NOISE_MG / 4, "steady variance %lld", (long long)Kalman_Var(&kf));
+}
+
+// 한 샘플 뒤 새 무게를 바로 따라가야 함 (KALMAN_INNOV_MAX 안의 계단)
+static void check_step(void)
+{
+    Kalman_t kf;
+    Kalman_Init(&kf, DT_MS, NOISE_MG, Q_MIN, Q_MAX);
+    for (int i = 0; i < 50; i++) Kalman_Update(&kf, 0);
+    int32_t w = Kalman_Update(&kf, 150000);
+    CHECK(labs(w - 150000) < 1000, "150 g step tracked to %d mg", w);
+    CHECK(Kalman_Changed(&kf), "step not flagged");
+}
+
+// 가장 큰 혁신: int32 양 끝과 0 을 오가는 입력. UBSan 빌드에서 오버플로면 바로 실패
+static void check_extremes(void)
+{
+    static const int32_t levels[] = { 0, INT32_MAX, INT32_MIN + 1, 0, -KALMAN_INNOV_MAX * 2,
+                                      INT32_MAX, 20000000, INT32_MIN + 1, 0 };
+    Kalman_t kf;
+    Kalman_Init(&kf, DT_MS, NOISE_MG, Q_MIN, Q_MAX);
+
+    for (unsigned l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        int32_t z = levels[l];
+        int32_t w = 0;
+        int settled = -1;
+        for (int i = 0; i < 2000; i++) {
+            w = Kalman_Update(&kf, z);
+            if (settled < 0 && llabs((long long)w - z) < 1000) settled = i;
+        }
+        CHECK(settled >= 0, "level %d: stuck at %d mg", z, w);
+        CHECK(llabs((long long)w - z) < 1000, "level %d: ended at %d mg", z, w);
+        CHECK(Kalman_Var(&kf) >= 0, "level %d: negative variance", z);
+    }
+}
+
+#ifdef KALMAN_BENCH
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(void)
+{
+    enum { ROUNDS = 2000 };
+    static int32_t z[N_SAMPLES];
+    for (int i = 0; i < N_SAMPLES; i++) z[i] = trace_mg(i);
+
+    volatile int64_t sink = 0;
+    double t0 = now_s();
+    for (int r = 0; r < ROUNDS; r++) {
+        Kalman_t kf;
+        Kalman_Init(&kf, DT_MS, NOISE_MG, Q_MIN, Q_MAX);
+        for (int i = 0; i < N_SAMPLES; i++) sink += Kalman_Update(&kf, z[i]);
+    }
+    double t1 = now_s();
+    for (int r = 0; r < ROUNDS; r++) {
+        KalmanF_t ref;
+        kf_float_init(&ref);
+        for (int i = 0; i < N_SAMPLES; i++) sink += (int64_t)kf_float_update(&ref, z[i]);
+    }
+    double t2 = now_s();
+    double n = (double)ROUNDS * N_SAMPLES;
+    printf("kalman bench (host): fixed %.1f ns/update, double %.1f ns/update\n",
+           (t1 - t0) / n * 1e9, (t2 - t1) / n * 1e9);
+    (void)sink;
+}
+#endif
+
+int main(void)
+{
+    compare_float();
+    check_step();
+    check_extremes();
+#ifdef KALMAN_BENCH
+    bench();
+#endif
+    if (failures) {
+        printf("test_kalman: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("test_kalman: ok\n");
+    return 0;
+}
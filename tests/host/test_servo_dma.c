@@ -0,0 +1,143 @@
+// ServoDMA_Generate 프레임 표 검사 (호스트)
+//   - 시작/끝 펄스폭이 정확히 출발/목표값
+//   - 이동 중 채널마다 단조 (되돌아가지 않음)
+//   - 이동 시간 = duration / 20ms 프레임 (그 프레임에서 모든 채널이 함께 도착)
+
+#include <stdio.h>
+#include <string.h>
+#include "servo_dma.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            failures++;                                             \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);             \
+            printf(__VA_ARGS__);                                    \
+            printf("\n");                                           \
+        }                                                           \
+    } while (0)
+
+#define MAX_FRAMES  512
+
+static uint32_t frames[MAX_FRAMES][SERVO_CHANNELS];
+
+// 한 번의 이동을 돌려서 출발→도착 표를 검사
+static void run_move(const uint16_t start[SERVO_CHANNELS], const ServoDMA_Move_t *move,
+                     const uint16_t expect[SERVO_CHANNELS])
+{
+    uint32_t n = move->duration / SERVO_PERIOD_MS;
+    if (n == 0) n = 1;
+
+    ServoDMA_Init(NULL, start);
+    // Init 이 버퍼 한 바퀴를 미리 채우므로, 그 뒤에 넣은 이동이 다음 프레임부터 시작
+    CHECK(ServoDMA_Queue(move), "queue refused");
+    CHECK(ServoDMA_IsBusy(), "queued move not busy");
+    // 한 프레임씩: 정확히 n 번째 프레임에서 이동이 끝나야 함
+    for (uint32_t f = 0; f < n + 3; f++) {
+        ServoDMA_Generate(&frames[f][0], 1);
+        CHECK(ServoDMA_IsBusy() == (f + 1 < n), "frame %u of %u: busy=%d", f, n, ServoDMA_IsBusy());
+    }
+
+    for (int ch = 0; ch < SERVO_CHANNELS; ch++) {
+        int dir = (expect[ch] > start[ch]) - (expect[ch] < start[ch]);
+        uint32_t prev = start[ch];
+
+        for (uint32_t f = 0; f < n; f++) {
+            uint32_t v = frames[f][ch];
+            CHECK(v >= SERVO_MIN_PULSE_US && v <= SERVO_MAX_PULSE_US, "ch%d frame %u out of range: %u", ch, f, v);
+            if (dir > 0) CHECK(v >= prev, "ch%d frame %u goes back: %u -> %u", ch, f, prev, v);
+            if (dir < 0) CHECK(v <= prev, "ch%d frame %u goes back: %u -> %u", ch, f, prev, v);
+            if (dir == 0) CHECK(v == start[ch], "ch%d held channel moved: %u", ch, v);
+            prev = v;
+        }
+        // 마지막 프레임에서 정확히 목표
+        CHECK(frames[n - 1][ch] == expect[ch], "ch%d end %u != %u", ch, frames[n - 1][ch], expect[ch]);
+        for (uint32_t f = n; f < n + 3; f++) {
+            CHECK(frames[f][ch] == expect[ch], "ch%d not held after move: %u", ch, frames[f][ch]);
+        }
+    }
+}
+
+// 이징 곡선: 출발/도착 근처 걸음이 가운데보다 작아야 함 (속도 0 → 최대 → 0)
+static void check_easing(void)
+{
+    const uint16_t start[SERVO_CHANNELS] = { 500, 500, 500, 500 };
+    const ServoDMA_Move_t move = { { 2500, 2500, 2500, 2500 }, 1000 };
+    const uint32_t n = 1000 / SERVO_PERIOD_MS;
+
+    ServoDMA_Init(NULL, start);
+    ServoDMA_Queue(&move);
+    ServoDMA_Generate(&frames[0][0], n);
+
+    uint32_t first = frames[0][0] - start[0];
+    uint32_t mid = frames[n / 2][0] - frames[n / 2 - 1][0];
+    uint32_t last = frames[n - 1][0] - frames[n - 2][0];
+    CHECK(first < mid / 4, "start step %u not small vs mid %u", first, mid);
+    CHECK(last < mid / 4, "end step %u not small vs mid %u", last, mid);
+}
+
+int main(void)
+{
+    const uint16_t center[SERVO_CHANNELS] = { 1500, 1500, 1500, 1500 };
+
+    // 초기값: NULL 이면 가운데, 범위 밖은 잘림
+    ServoDMA_Init(NULL, NULL);
+    ServoDMA_Generate(&frames[0][0], 1);
+    for (int ch = 0; ch < SERVO_CHANNELS; ch++) {
+        CHECK(frames[0][ch] == 1500, "ch%d init %u", ch, frames[0][ch]);
+    }
+    const uint16_t wild[SERVO_CHANNELS] = { 0, 100, 3000, 2500 };
+    ServoDMA_Init(NULL, wild);
+    ServoDMA_Generate(&frames[0][0], 1);
+    CHECK(frames[0][0] == SERVO_MIN_PULSE_US && frames[0][2] == SERVO_MAX_PULSE_US, "init not clamped");
+
+    // 각도 변환 끝점
+    CHECK(ServoDMA_AngleToPulse(0) == SERVO_MIN_PULSE_US, "0 deg");
+    CHECK(ServoDMA_AngleToPulse(90) == 1500, "90 deg");
+    CHECK(ServoDMA_AngleToPulse(180) == SERVO_MAX_PULSE_US, "180 deg");
+    CHECK(ServoDMA_AngleToPulse(250) == SERVO_MAX_PULSE_US, "over 180 deg");
+
+    // 채널마다 다른 방향/거리 + 그대로 두는 채널, 여러 이동 시간
+    const uint32_t durations[] = { 20, 60, 500, 1000, 2990, 5000 };
+    for (unsigned i = 0; i < sizeof(durations) / sizeof(durations[0]); i++) {
+        ServoDMA_Move_t move = { { 2500, 500, SERVO_HOLD, 1501 }, durations[i] };
+        const uint16_t expect[SERVO_CHANNELS] = { 2500, 500, 1500, 1501 };
+        run_move(center, &move, expect);
+    }
+
+    // 이동 시간 0 → 한 프레임, 범위 밖 목표는 잘림
+    {
+        ServoDMA_Move_t move = { { 9999, 1, 2000, 1000 }, 0 };
+        const uint16_t expect[SERVO_CHANNELS] = { SERVO_MAX_PULSE_US, SERVO_MIN_PULSE_US, 2000, 1000 };
+        run_move(center, &move, expect);
+    }
+
+    // 큐는 SERVO_MOVE_QUEUE_LEN - 1 개까지
+    ServoDMA_Init(NULL, center);
+    ServoDMA_Move_t hold = { { SERVO_HOLD, SERVO_HOLD, SERVO_HOLD, SERVO_HOLD }, 100 };
+    for (int i = 0; i < SERVO_MOVE_QUEUE_LEN - 1; i++) {
+        CHECK(ServoDMA_Queue(&hold), "queue %d refused", i);
+    }
+    CHECK(!ServoDMA_Queue(&hold), "full queue accepted");
+
+    // 이어진 이동: 앞 이동이 끝난 프레임 바로 다음부터 출발
+    ServoDMA_Init(NULL, center);
+    ServoDMA_Move_t a = { { 2000, 2000, 2000, 2000 }, 200 };
+    ServoDMA_Move_t b = { { 1000, 1000, 1000, 1000 }, 400 };
+    ServoDMA_Queue(&a);
+    ServoDMA_Queue(&b);
+    ServoDMA_Generate(&frames[0][0], 40);
+    CHECK(frames[9][0] == 2000, "first move end %u", frames[9][0]);
+    CHECK(frames[10][0] < 2000, "second move did not start on next frame");
+    CHECK(frames[29][0] == 1000 && frames[28][0] != 1000, "second move end at wrong frame");
+
+    check_easing();
+
+    if (failures) {
+        printf("test_servo_dma: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("test_servo_dma: ok\n");
+    return 0;
+}
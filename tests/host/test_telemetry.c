@@ -0,0 +1,193 @@
+// 텔레메트리 배치 (Core/Src/telemetry.c) 호스트 테스트
+//   - 레코드 하나 / 여러 개의 패킷 모양, "ts"/"te" 붙는 자리
+//   - 헬스/채움량은 최신값만, 기한 (Poll) 과 FLUSH_BYTES 에서 전송
+//   - 무작위 레코드 길이/종류/틱 (최대 10 자리 포함) 에서
+//       패킷이 TELEMETRY_MAX_PACKET 을 안 넘고 괄호가 맞으며 "te" 가 바깥 객체 끝에 하나
+//       이벤트는 하나도 안 빠지고 순서대로, 주기 레코드는 덮어쓴 것 말고는 다 나감
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "telemetry.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            failures++;                                             \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);             \
+            printf(__VA_ARGS__);                                    \
+            printf("\n");                                           \
+        }                                                           \
+    } while (0)
+
+static uint32_t tick = 0;
+
+uint32_t HAL_GetTick(void)
+{
+    return tick;
+}
+
+#define MAX_PKTS 4096
+static char     pkts[MAX_PKTS][TELEMETRY_MAX_PACKET + 1];
+static uint16_t pkt_len[MAX_PKTS];
+static int      npkts = 0;
+
+static void sink(const char *packet, uint16_t len)
+{
+    CHECK(strlen(packet) == len, "sink len %u vs strlen %zu", len, strlen(packet));
+    if (npkts < MAX_PKTS) {
+        memcpy(pkts[npkts], packet, len + 1u);
+        pkt_len[npkts] = len;
+    }
+    npkts++;
+}
+
+static void reset(void)
+{
+    npkts = 0;
+    tick = 1000;
+    Telemetry_Init(sink);
+    Telemetry_SetDeadline(TELEMETRY_EVENT, 0);
+    Telemetry_SetDeadline(TELEMETRY_HEALTH, 60000);
+    Telemetry_SetDeadline(TELEMETRY_FILL, 30000);
+}
+
+// 문자열 밖의 {}[] 가 맞고, 맨 바깥 객체가 끝까지 하나인지
+static int balanced(const char *s)
+{
+    char stack[64];
+    int depth = 0, in_str = 0;
+    for (const char *p = s; *p; p++) {
+        if (in_str) {
+            if (*p == '\\' && p[1]) p++;
+            else if (*p == '"') in_str = 0;
+            continue;
+        }
+        if (*p == '"') in_str = 1;
+        else if (*p == '{' || *p == '[') {
+            if (depth == (int)sizeof(stack)) return 0;
+            stack[depth++] = *p;
+        } else if (*p == '}' || *p == ']') {
+            if (depth == 0 || stack[depth - 1] != (*p == '}' ? '{' : '[')) return 0;
+            depth--;
+            if (depth == 0 && p[1] != '\0') return 0;
+        }
+    }
+    return depth == 0 && !in_str && s[0] == '{';
+}
+
+static void check_shapes(void)
+{
+    reset();
+    Telemetry_Push(TELEMETRY_EVENT, "{\"m\":\"ev\",\"dw\":1.00}");
+    CHECK(npkts == 1, "event not sent at once (%d)", npkts);
+    CHECK(strcmp(pkts[0], "{\"m\":\"ev\",\"dw\":1.00,\"ts\":1000,\"te\":1000}") == 0, "single: %s", pkts[0]);
+
+    // 주기 레코드는 기한까지 모음, 같은 종류는 최신값만
+    reset();
+    Telemetry_Push(TELEMETRY_FILL, "{\"m\":\"fill\",\"fill\":1.0}");
+    tick = 2000;
+    Telemetry_Push(TELEMETRY_HEALTH, "{\"m\":\"h\",\"h\":{\"up\":2}}");
+    tick = 3000;
+    Telemetry_Push(TELEMETRY_FILL, "{\"m\":\"fill\",\"fill\":2.0}");
+    tick = 30999;
+    Telemetry_Poll();
+    CHECK(npkts == 0, "flushed before deadline");
+    tick = 31000;
+    Telemetry_Poll();
+    CHECK(npkts == 1, "not flushed at deadline (%d)", npkts);
+    CHECK(strcmp(pkts[0], "{\"b\":[{\"m\":\"h\",\"h\":{\"up\":2},\"ts\":2000},"
+                          "{\"m\":\"fill\",\"fill\":2.0,\"ts\":3000}],\"te\":31000}") == 0, "batch: %s", pkts[0]);
+    Telemetry_Poll();
+    CHECK(npkts == 1, "flushed twice");
+
+    // 이벤트는 쌓여 있던 주기 레코드를 같이 실어감 (이벤트 먼저)
+    reset();
+    Telemetry_Push(TELEMETRY_HEALTH, "{\"h\":1}");
+    tick = 1500;
+    Telemetry_Push(TELEMETRY_EVENT, "{\"ev\":2}");
+    CHECK(npkts == 1 && strcmp(pkts[0], "{\"b\":[{\"ev\":2,\"ts\":1500},{\"h\":1,\"ts\":1000}],\"te\":1500}") == 0,
+          "event + health: %s", pkts[0]);
+
+    // '}' 로 안 끝나는 레코드에는 "ts" 를 안 붙임 (그대로)
+    reset();
+    Telemetry_Push(TELEMETRY_EVENT, "[1,2]");
+    CHECK(npkts == 1 && strncmp(pkts[0], "[1,2", 4) == 0, "non-object: %s", pkts[0]);
+}
+
+static void rnd_rec(char *out, int len, int cls, int k)
+{
+    // {"x":<k>,"c":<cls>,"p":"aaaa..."}  길이를 맞춰 채움
+    int n = snprintf(out, (size_t)len + 1, "{\"x\":%d,\"c\":%d,\"p\":\"", k, cls);
+    while (n < len - 2) out[n++] = 'a' + (char)(k % 26);
+    out[n++] = '"';
+    out[n++] = '}';
+    out[n] = '\0';
+}
+
+static void check_fuzz(void)
+{
+    srand(12345);
+    for (int round = 0; round < 200; round++) {
+        reset();
+        Telemetry_SetDeadline(TELEMETRY_EVENT, (round % 2) ? 0 : 500);
+        tick = (round % 3 == 0) ? 4294960000u : (uint32_t)rand();   // 10 자리 틱, 넘어감 포함
+
+        int next_ev = 0;
+        int last_seq[TELEMETRY_CLASS_COUNT] = { -1, -1, -1 };
+        for (int k = 0; k < 60; k++) {
+            int cls = rand() % TELEMETRY_CLASS_COUNT;
+            // 머리 {"x":NN,"c":N,"p":" 보다 길고, "ts" (최대 16 자) 를 붙여도 TELEMETRY_REC_MAX 안
+            int len = 24 + rand() % (TELEMETRY_REC_MAX - 1 - 16 - 24);
+            char rec[TELEMETRY_REC_MAX];
+            rnd_rec(rec, len, cls, cls == TELEMETRY_EVENT ? next_ev++ : k);
+            if (cls != TELEMETRY_EVENT) last_seq[cls] = k;
+            Telemetry_Push((Telemetry_Class_t)cls, rec);
+            tick += (uint32_t)(rand() % 20000);
+            Telemetry_Poll();
+        }
+        Telemetry_Flush();
+        CHECK(npkts < MAX_PKTS, "too many packets");
+
+        int seen_ev = 0, seen_last[TELEMETRY_CLASS_COUNT] = { 0, 0, 0 };
+        for (int i = 0; i < npkts && i < MAX_PKTS; i++) {
+            const char *p = pkts[i];
+            CHECK(pkt_len[i] <= TELEMETRY_MAX_PACKET, "packet %u bytes", pkt_len[i]);
+            CHECK(balanced(p), "unbalanced: %s", p);
+            const char *te = strstr(p, "\"te\":");
+            CHECK(te != NULL && strstr(te + 1, "\"te\":") == NULL, "te missing or repeated: %s", p);
+            CHECK(te != NULL && strchr(te, '}') == p + pkt_len[i] - 1, "te not last: %s", p);
+
+            // 레코드마다 {"x":k,"c":cls,...} 를 훑음
+            for (const char *q = strstr(p, "{\"x\":"); q; q = strstr(q + 1, "{\"x\":")) {
+                int x, c;
+                if (sscanf(q, "{\"x\":%d,\"c\":%d", &x, &c) != 2) continue;
+                if (c == TELEMETRY_EVENT) {
+                    CHECK(x == seen_ev, "event %d out of order (expected %d)", x, seen_ev);
+                    seen_ev = x + 1;
+                } else if (x == last_seq[c]) {
+                    seen_last[c] = 1;
+                }
+                CHECK(strstr(q, ",\"ts\":") != NULL, "record without ts");
+            }
+        }
+        CHECK(seen_ev == next_ev, "round %d: %d of %d events sent", round, seen_ev, next_ev);
+        for (int c = TELEMETRY_HEALTH; c < TELEMETRY_CLASS_COUNT; c++)
+            CHECK(last_seq[c] < 0 || seen_last[c], "round %d: latest class %d record not sent", round, c);
+    }
+}
+
+int main(void)
+{
+    check_shapes();
+    check_fuzz();
+
+    if (failures) {
+        printf("test_telemetry: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("test_telemetry: ok\n");
+    return 0;
+}